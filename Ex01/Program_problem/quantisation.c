@@ -6,6 +6,10 @@
 #include <ctype.h>
 #include <time.h>
 
+#include "image.h"
+#include "cli.h"
+#include "parallel.h"
+
 
 /*--------------------------------------------------------------------------*/
 /*                                                                          */
@@ -21,244 +25,6 @@
 
 /*--------------------------------------------------------------------------*/
 
-void alloc_double_matrix
-
-     (double ***matrix,  /* matrix */
-      long   n1,         /* size in direction 1 */
-      long   n2)         /* size in direction 2 */
-
-/*
-  allocates memory for a double format matrix of size n1 * n2 
-*/
-
-{
-long i;    /* loop variable */
-
-*matrix = (double **) malloc (n1 * sizeof(double *));
-
-if (*matrix == NULL)
-   {
-   printf("alloc_double_matrix: not enough memory available\n");
-   exit(1);
-   }
-
-for (i=0; i<n1; i++)
-    {
-    (*matrix)[i] = (double *) malloc (n2 * sizeof(double));
-    if ((*matrix)[i] == NULL)
-       {
-       printf("alloc_double_matrix: not enough memory available\n");
-       exit(1);
-       }
-    }
-
-return;
-
-}  /* alloc_double_matrix */
-
-/*--------------------------------------------------------------------------*/
-
-void free_double_matrix
-
-     (double  **matrix,   /* matrix */
-      long    n1,         /* size in direction 1 */
-      long    n2)         /* size in direction 2 */
-
-/*
-  frees memory for a double format matrix of size n1 * n2
-*/
-
-{
-long i;   /* loop variable */
-
-for (i=0; i<n1; i++)
-free(matrix[i]);
-
-free(matrix);
-
-return;
-
-}  /* free_double_matrix */
-
-/*--------------------------------------------------------------------------*/
-
-void read_string
-
-     (char *v)         /* string to be read */
-
-/*
-  reads a string v
-*/
-
-{
-if (fgets (v, 80, stdin) == NULL)
-{
-   printf("could not read string, aborting\n");
-   exit(1);
-}
-
-if (v[strlen(v)-1] == '\n')
-   v[strlen(v)-1] = 0;
-
-return;
-
-}  /* read_string */
-
-/*--------------------------------------------------------------------------*/
-
-void read_long
-
-     (long *v)         /* value to be read */
-
-/*
-  reads a long value v
-*/
-
-{
-char   row[80];    /* string for reading data */
-
-if (fgets (row, 80, stdin) == NULL)
-{
-   printf("could not read string, aborting\n");
-   exit(1);
-}
-
-if (row[strlen(row)-1] == '\n')
-   row[strlen(row)-1] = 0;
-sscanf(row, "%ld", &*v);
-
-return;
-
-}  /* read_long */
-
-/*--------------------------------------------------------------------------*/
-
-void skip_white_space_and_comments 
-
-     (FILE *inimage)  /* input file */
-
-/*
-  skips over white space and comments while reading the file
-*/
-
-{
-
-int   ch = 0;   /* holds a character */
-char  row[80];  /* for reading data */
-
-/* skip spaces */
-while (((ch = fgetc(inimage)) != EOF) && isspace(ch));
-  
-/* skip comments */
-if (ch == '#')
-   {
-   if (fgets(row, sizeof(row), inimage))
-      skip_white_space_and_comments (inimage);
-   else
-      {
-      printf("skip_white_space_and_comments: cannot read file\n");
-      exit(1);
-      }
-   }
-else
-   fseek (inimage, -1, SEEK_CUR);
-
-return;
-
-} /* skip_white_space_and_comments */
-
-/*--------------------------------------------------------------------------*/
-
-void read_pgm_to_double
-
-     (const char  *file_name,    /* name of pgm file */
-      long        *nx,           /* image size in x direction, output */
-      long        *ny,           /* image size in y direction, output */
-      double      ***u)          /* image, output */
-
-/*
-  reads a greyscale image that has been encoded in pgm format P5 to
-  an image u in double format;
-  allocates memory for the image u;
-  adds boundary layers of size 1 such that
-  - the relevant image pixels in x direction use the indices 1,...,nx
-  - the relevant image pixels in y direction use the indices 1,...,ny
-*/
-
-{
-char  row[80];      /* for reading data */
-long  i, j;         /* image indices */
-long  max_value;    /* maximum color value */
-FILE  *inimage;     /* input file */
-
-/* open file */
-inimage = fopen (file_name, "rb");
-if (inimage == NULL)
-   {
-   printf ("read_pgm_to_double: cannot open file '%s'\n", file_name);
-   exit(1);
-   }
-
-/* read header */
-if (fgets(row, 80, inimage) == NULL)
-   {
-   printf ("read_pgm_to_double: cannot read file\n");
-   exit(1);
-   }
-
-/* image type: P5 */
-if ((row[0] == 'P') && (row[1] == '5'))
-   {
-   /* P5: grey scale image */
-   }
-else
-   {
-   printf ("read_pgm_to_double: unknown image format\n");
-   exit(1);
-   }
-
-/* read image size in x direction */
-skip_white_space_and_comments (inimage);
-if (!fscanf (inimage, "%ld", nx))
-   {
-   printf ("read_pgm_to_double: cannot read image size nx\n");
-   exit(1);
-   }
-
-/* read image size in x direction */
-skip_white_space_and_comments (inimage);
-if (!fscanf (inimage, "%ld", ny))
-   {
-   printf ("read_pgm_to_double: cannot read image size ny\n");
-   exit(1);
-   }
-
-/* read maximum grey value */
-skip_white_space_and_comments (inimage);
-if (!fscanf (inimage, "%ld", &max_value))
-   {
-   printf ("read_pgm_to_double: cannot read maximal value\n");
-   exit(1);
-   }
-fgetc(inimage);
-
-/* allocate memory */
-alloc_double_matrix (u, (*nx)+2, (*ny)+2);
-
-/* read image data row by row */
-for (j=1; j<=(*ny); j++)
- for (i=1; i<=(*nx); i++)
-     (*u)[i][j] = (double) getc(inimage);
-
-/* close file */
-fclose (inimage);
-
-return;
-
-}  /* read_pgm_to_double */
-
-/*--------------------------------------------------------------------------*/
-
 void comment_line
 
      (char* comment,       /* comment string (output) */
@@ -300,108 +66,92 @@ return;
 
 /*--------------------------------------------------------------------------*/
 
-void write_double_to_pgm
+typedef struct
+   {
+   image          *u;      /* image, changed */
+   long           nx;      /* image dimension in x direction */
+   double         d;       /* width of the quantisation intervals */
+   unsigned long  seed;    /* seed for the noise */
+   image_stats    *row;    /* statistics of each quantised row, output */
+   } quant_task;
 
-     (double  **u,          /* image, unchanged */
-      long    nx,           /* image size in x direction */
-      long    ny,           /* image size in y direction */
-      char    *file_name,   /* name of pgm file */
-      char    *comments)    /* comment string (set 0 for no comments) */
+/*--------------------------------------------------------------------------*/
+
+void quantise_rows
+
+     (long     first,     /* first row */
+      long     last,      /* last row */
+      void     *arg)      /* quant_task */
 
 /*
-  writes a greyscale image in double format into a pgm P5 file
+  quantises the rows first,...,last
 */
 
 {
-FILE           *outimage;  /* output file */
-long           i, j;       /* loop variables */
-double         aux;        /* auxiliary variable */
-unsigned char  byte;       /* for data conversion */
-
-/* open file */
-outimage = fopen (file_name, "wb");
-if (NULL == outimage)
-   {
-   printf("could not open file '%s' for writing, aborting\n", file_name);
-   exit(1);
-   }
+quant_task  *t = (quant_task *) arg;   /* task */
+long        i, j;                      /* loop variables */
 
-/* write header */
-fprintf (outimage, "P5\n");                  /* format */
-if (comments != 0)
-   fputs (comments, outimage);               /* comments */
-fprintf (outimage, "%ld %ld\n", nx, ny);     /* image size */
-fprintf (outimage, "255\n");                 /* maximal value */
-
-/* write image data */
-for (j=1; j<=ny; j++)
- for (i=1; i<=nx; i++)
-     {
-     aux = u[i][j] + 0.499999;    /* for correct rounding */
-     if (aux < 0.0)
-        byte = (unsigned char)(0.0);
-     else if (aux > 255.0)
-        byte = (unsigned char)(255.0);
-     else
-        byte = (unsigned char)(aux);
-     fwrite (&byte, sizeof(unsigned char), 1, outimage);
-     }
-
-/* close file */
-fclose (outimage);
+for (j=first; j<=last; j++)
+    {
+    for (i=1; i<=t->nx; i++)
+        {
+        PIX(t->u,i,j) = ((int)(PIX(t->u,i,j) / t->d) + 0.5f) * t->d;
+        /*
+         Pixel value has been cropped (between 0 and 255)in the function write_double_to_pgm.
+        */
+        }
+    /* statistics of the finished row while it is in cache */
+    stats_init (&t->row[j-1]);
+    stats_add_row (&t->row[j-1], ROW(t->u,j) + 1, t->nx);
+    }
 
 return;
 
-}  /* write_double_to_pgm */
+} /* quantise_rows */
 
 /*--------------------------------------------------------------------------*/
 
-void analyse_grey_double
+void quantise_rows_with_noise
 
-     (double  **u,         /* image, unchanged */
-      long    nx,          /* pixel number in x direction */
-      long    ny,          /* pixel number in y direction */
-      double  *min,        /* minimum, output */
-      double  *max,        /* maximum, output */
-      double  *mean,       /* mean, output */
-      double  *std)        /* standard deviation, output */
+     (long     first,     /* first row */
+      long     last,      /* last row */
+      void     *arg)      /* quant_task */
 
 /*
-  computes minimum, maximum, mean, and standard deviation of a greyscale
-  image u in double format
+  quantises the rows first,...,last with uniformly distributed noise;
+  every row has its own random number generator (xorshift64*) seeded from
+  the row index, so the noise does not depend on the thread that
+  processes the row
 */
 
 {
-long    i, j;       /* loop variables */
-double  help1;      /* auxiliary variable */
-double  help2;      /* auxiliary variable */
-
-/* compute maximum, minimum, and mean */
-*min  = u[1][1];
-*max  = u[1][1];
-help1 = 0.0;
-for (i=1; i<=nx; i++)
- for (j=1; j<=ny; j++)
-     {
-     if (u[i][j] < *min) *min = u[i][j];
-     if (u[i][j] > *max) *max = u[i][j];
-     help1 = help1 + u[i][j];
-     }
-*mean = help1 / (nx * ny);
-
-/* compute standard deviation */
-*std = 0.0;
-for (i=1; i<=nx; i++)
- for (j=1; j<=ny; j++)
-     {
-     help2  = u[i][j] - *mean;
-     *std = *std + help2 * help2;
-     }
-*std = sqrt(*std / (nx * ny));
+quant_task     *t = (quant_task *) arg;   /* task */
+long           i, j;                      /* loop variables */
+double         noise;                     /* uniformly distributed noise */
+unsigned long  x;                         /* generator state */
+
+for (j=first; j<=last; j++)
+    {
+    x = t->seed ^ ((unsigned long) j * 0x9E3779B97F4A7C15UL);
+    if (x == 0)
+       x = 1;
+    for (i=1; i<=t->nx; i++)
+        {
+         x ^= x >> 12;
+         x ^= x << 25;
+         x ^= x >> 27;
+         noise = (double)((x * 0x2545F4914F6CDD1DUL) >> 11)
+                 / 9007199254740992.0 - 0.5;
+         PIX(t->u,i,j) = ((int)(PIX(t->u,i,j) / t->d + noise) + 0.5f) * t->d;
+        }
+    /* statistics of the finished row while it is in cache */
+    stats_init (&t->row[j-1]);
+    stats_add_row (&t->row[j-1], ROW(t->u,j) + 1, t->nx);
+    }
 
 return;
 
-}  /* analyse_grey_double */
+} /* quantise_rows_with_noise */
 
 /*--------------------------------------------------------------------------*/
 
@@ -411,30 +161,38 @@ void quantisation
       long     ny,        /* image dimension in y direction */
       long     q,         /* number of bits used to represent a value
                              in the output image */
-      double   **u)       /* input: original image; output: quantised */
+      image    *u,        /* input: original image; output: quantised */
+      image_stats *s)     /* statistics of the quantised image, output */
       
 /*
   quantisation
 */
 
 {
-long    i, j;             /* loop variables */
-double  d;                /* auxiliary variable */
+long        j;            /* loop variable */
+quant_task  t;            /* rows to be quantised */
 
 /* quantise the input image */
 
-d = pow (2.0, 8-q);
+t.u    = u;
+t.nx   = nx;
+t.d    = pow (2.0, 8-q);
+t.seed = 0;
+t.row  = (image_stats *) malloc (ny * sizeof(image_stats));
+if (t.row == NULL)
+   {
+   printf("quantisation: not enough memory available\n");
+   exit(1);
+   }
 
-for (j=1; j<=ny; j++)
- for (i=1; i<=nx; i++)
-     {
-     u[i][j] = ((int)(u[i][j] / d) + 0.5f) * d;
-     /*
-      Pixel value has been cropped (between 0 and 255)in the function write_double_to_pgm.
-     */
-     }
+parallel_rows (1, ny, quantise_rows, &t);
 
+/* merge row statistics in row order */
+stats_init (s);
+for (j=0; j<ny; j++)
+    stats_merge (s, &t.row[j]);
 
+free (t.row);
 return;
 
 } /* quantisation */
@@ -447,47 +205,56 @@ void quantisation_with_noise
       long     ny,        /* image dimension in y direction */
       long     q,         /* number of bits used to represent a value
                              in the output image */
-      double   **u)       /* input: original image; output: quantised */
+      image    *u,        /* input: original image; output: quantised */
+      image_stats *s)     /* statistics of the quantised image, output */
       
 /*
   quantisation with uniformly distributed noise
 */
 
 {
-long    i, j;             /* loop variables */
-double  d;                /* auxiliary variable */
-double  noise;            /* variable for uniformly distributed noise */
+long        j;            /* loop variable */
+quant_task  t;            /* rows to be quantised */
 
 /* quantise the input image */
-d = pow (2.0, 8-q);
-noise = 0.0;
 
-// double acc = 0;
+t.u    = u;
+t.nx   = nx;
+t.d    = pow (2.0, 8-q);
+t.row  = (image_stats *) malloc (ny * sizeof(image_stats));
+if (t.row == NULL)
+   {
+   printf("quantisation_with_noise: not enough memory available\n");
+   exit(1);
+   }
+
 /* reset random seed*/
-srand((unsigned)time(NULL));
+t.seed = (unsigned long) time (NULL);
 
-for (j=1; j<=ny; j++)
- for (i=1; i<=nx; i++)
-     {
-      noise = (double)(rand()) / RAND_MAX - 0.5f;
-      // acc += noise;
-      u[i][j] = ((int)(u[i][j] / d + noise) + 0.5f) * d;
-     }
+parallel_rows (1, ny, quantise_rows_with_noise, &t);
 
-// printf("average noise: %lf\n", acc/ny/nx);
+/* merge row statistics in row order */
+stats_init (s);
+for (j=0; j<ny; j++)
+    stats_merge (s, &t.row[j]);
 
+free (t.row);
 return;
 
 } /* quantisation_with_noise */
 
 /*--------------------------------------------------------------------------*/
 
-int main ()
+void run_job ()
+
+/*
+  reads the parameters of one job and processes it
+*/
 
 {
 char    in[80];               /* for reading data */
 char    out[80];              /* for reading data */
-double  **u;                  /* image */
+image   *u;                   /* image */
 long    nx, ny;               /* image size in x, y direction */ 
 long    q;                    /* number of bits used to represent a value
                                 in the output image */        
@@ -495,26 +262,16 @@ long    flag;                 /* option flag */
 double  max, min;             /* largest, smallest grey value */
 double  mean;                 /* average grey value */
 double  std;                  /* standard deviation */
+image_stats  s;               /* statistics of the quantised image */
 char    comments[1600];       /* string for comments */
 
-printf ("\n");
-printf ("QUANTISATION\n\n");
-printf ("**************************************************\n\n");
-printf ("    Copyright 2021 by Joachim Weickert            \n");
-printf ("    Dept. of Mathematics and Computer Science     \n");
-printf ("    Saarland University, Saarbruecken, Germany    \n\n");
-printf ("    All rights reserved. Unauthorised usage,      \n");
-printf ("    copying, hiring, and selling prohibited.      \n\n");
-printf ("    Send bug reports to                           \n");
-printf ("    weickert@mia.uni-saarland.de                  \n\n");
-printf ("**************************************************\n\n");
-
-
 /* ---- read input image (pgm format P5) ---- */
 
 printf ("input image (pgm):                            ");
 read_string (in);
-read_pgm_to_double (in, &nx, &ny, &u);   /* also allocates memory for u */
+read_pgm_to_double (in, 1, &u);   /* also allocates memory for u */
+nx = u->nx;
+ny = u->ny;
 
 
 /* ---- read parameters ---- */
@@ -537,21 +294,21 @@ printf ("\n");
 
 if (flag == 1)
   /* perform quantisation without noise */
-  quantisation (nx, ny, q, u);
+  quantisation (nx, ny, q, u, &s);
 else if (flag == 2)
   /* perform quantisation with uniformly distributed noise */
-  quantisation_with_noise (nx, ny, q, u);
+  quantisation_with_noise (nx, ny, q, u, &s);
 else
   {
   printf ("option (%ld) not available! \n\n\n",flag);
-  free_double_matrix (u, nx+2, ny+2);
-  return(0);
+  free_image (u);
+  return;
   }
 
 
-/* ---- analyse filtered image ---- */
+/* ---- analyse filtered image (collected while quantising) ---- */
 
-analyse_grey_double (u, nx, ny, &min, &max, &mean, &std);
+stats_result (&s, &min, &max, &mean, &std);
 printf ("quantised image:\n");
 printf ("minimum:       %8.2lf \n", min);
 printf ("maximum:       %8.2lf \n", max);
@@ -570,13 +327,44 @@ else if (flag == 2)
 comment_line (comments, "# q: %2ld\n", q);
 
 /* write image */
-write_double_to_pgm (u, nx, ny, out, comments);
+write_double_to_pgm (u, out, comments);
 printf ("output image %s successfully written\n\n", out);
 
 
 /* ---- free memory  ---- */
 
-free_double_matrix (u, nx+2, ny+2);
+free_image (u);
+
+return;
+
+}  /* run_job */
+
+/*--------------------------------------------------------------------------*/
+
+int main
+
+     (int   argc,        /* number of command line arguments */
+      char  **argv)      /* command line arguments */
+
+{
+printf ("\n");
+printf ("QUANTISATION\n\n");
+printf ("**************************************************\n\n");
+printf ("    Copyright 2021 by Joachim Weickert            \n");
+printf ("    Dept. of Mathematics and Computer Science     \n");
+printf ("    Saarland University, Saarbruecken, Germany    \n\n");
+printf ("    All rights reserved. Unauthorised usage,      \n");
+printf ("    copying, hiring, and selling prohibited.      \n\n");
+printf ("    Send bug reports to                           \n");
+printf ("    weickert@mia.uni-saarland.de                  \n\n");
+printf ("**************************************************\n\n");
+
+/* ---- one run per job (interactive mode: exactly one) ---- */
+
+read_options (argc, argv);
+while (next_job ())
+   run_job ();
 
 return(0);
-}
+
+}  /* main */
@@ -1,16 +1,13 @@
 input="kodim23.ppm"
 ss=(1 2 4 8)
 echo "log starts" > 1.log.txt
+# one job per line: input image, subsampling factor, output image
+: > jobs.txt
 for s in ${ss[@]}
 do
-    echo $input > tes.txt
-    echo $s >> tes.txt
     output="./result/output_q_equals_${s}"
     output=${output}".ppm"
-    # if [ "$a" -eq 2 ]; then
-    #     output=${output}"_and_noise"
-    # fi
-    echo $output >> tes.txt
-    ./YCbCr < tes.txt >> 1.log.txt
+    echo $input $s $output >> jobs.txt
 done
-rm tes.txt
\ No newline at end of file
+./YCbCr -b jobs.txt >> 1.log.txt
+rm jobs.txt
\ No newline at end of file
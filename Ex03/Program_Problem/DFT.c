@@ -5,6 +5,12 @@
 #include <stdarg.h>
 #include <ctype.h>
 
+#include "image.h"
+#include "cli.h"
+#include "fft.h"
+#include "freqfilter.h"
+#include "parallel.h"
+
 /*--------------------------------------------------------------------------*/
 /*                                                                          */
 /*                        DISCRETE FOURIER TRANSFORM                        */
@@ -16,7 +22,9 @@
 
 /*
   features:
-  - DFT and FFT
+  - mixed-radix and Bluestein FFT for all image sizes
+  - real-input transform: only the half spectrum with x frequencies
+    0,...,nx/2 is computed and filtered
   - two output images:
     (i)  logarithmic Fourier spectrum
     (ii) Fourier transform in double precision
@@ -48,43 +56,6 @@ return;
 
 /*--------------------------------------------------------------------------*/
 
-void alloc_double_matrix
-
-     (double ***matrix,  /* matrix */
-      long   n1,         /* size in direction 1 */
-      long   n2)         /* size in direction 2 */
-
-/*
-  allocates memory for a double format matrix of size n1 * n2 
-*/
-
-{
-long i;    /* loop variable */
-
-*matrix = (double **) malloc (n1 * sizeof(double *));
-
-if (*matrix == NULL)
-   {
-   printf("alloc_double_matrix: not enough memory available\n");
-   exit(1);
-   }
-
-for (i=0; i<n1; i++)
-    {
-    (*matrix)[i] = (double *) malloc (n2 * sizeof(double));
-    if ((*matrix)[i] == NULL)
-       {
-       printf("alloc_double_matrix: not enough memory available\n");
-       exit(1);
-       }
-    }
-
-return;
-
-}  /* alloc_double_matrix */
-
-/*--------------------------------------------------------------------------*/
-
 void free_double_vector
 
      (double  *vector,    /* vector */
@@ -103,206 +74,6 @@ return;
 
 /*--------------------------------------------------------------------------*/
 
-void free_double_matrix
-
-     (double  **matrix,   /* matrix */
-      long    n1,         /* size in direction 1 */
-      long    n2)         /* size in direction 2 */
-
-/*
-  frees memory for a double format matrix of size n1 * n2
-*/
-
-{
-long i;   /* loop variable */
-
-for (i=0; i<n1; i++)
-free(matrix[i]);
-
-free(matrix);
-
-return;
-
-}  /* free_double_matrix */
-
-/*--------------------------------------------------------------------------*/
-
-void read_string
-
-     (char *v)         /* string to be read */
-
-/*
-  reads a string v
-*/
-
-{
-if (fgets (v, 80, stdin) == NULL)
-{
-   printf("could not read string, aborting\n");
-   exit(1);
-}
-
-if (v[strlen(v)-1] == '\n')
-   v[strlen(v)-1] = 0;
-
-return;
-
-}  /* read_string */
-
-/*--------------------------------------------------------------------------*/
-
-void read_long
-
-     (long *v)         /* value to be read */
-
-/*
-  reads a long value v
-*/
-
-{
-char   row[80];    /* string for reading data */
-
-if (fgets (row, 80, stdin) == NULL)
-{
-   printf("could not read string, aborting\n");
-   exit(1);
-}
-
-if (row[strlen(row)-1] == '\n')
-   row[strlen(row)-1] = 0;
-sscanf(row, "%ld", &*v);
-
-return;
-}
-
-/*--------------------------------------------------------------------------*/
-
-void skip_white_space_and_comments 
-
-     (FILE *inimage)  /* input file */
-
-/*
-  skips over white space and comments while reading the file
-*/
-
-{
-
-int   ch = 0;   /* holds a character */
-char  row[80];  /* for reading data */
-
-/* skip spaces */
-while (((ch = fgetc(inimage)) != EOF) && isspace(ch));
-  
-/* skip comments */
-if (ch == '#')
-   {
-   if (fgets(row, sizeof(row), inimage))
-      skip_white_space_and_comments (inimage);
-   else
-      {
-      printf("skip_white_space_and_comments: cannot read file\n");
-      exit(1);
-      }
-   }
-else
-   fseek (inimage, -1, SEEK_CUR);
-
-return;
-
-} /* skip_white_space_and_comments */
-
-/*--------------------------------------------------------------------------*/
-
-void read_pgm_to_double
-
-     (const char  *file_name,    /* name of pgm file */
-      long        *nx,           /* image size in x direction, output */
-      long        *ny,           /* image size in y direction, output */
-      double      ***u)          /* image, output */
-
-/*
-  reads a greyscale image that has been encoded in pgm format P5 to
-  an image u in double format;
-  allocates memory for the image u;
-  adds boundary layers of size 1 such that
-  - the relevant image pixels in x direction use the indices 1,...,nx
-  - the relevant image pixels in y direction use the indices 1,...,ny
-*/
-
-{
-char  row[80];      /* for reading data */
-long  i, j;         /* image indices */
-long  max_value;    /* maximum color value */
-FILE  *inimage;     /* input file */
-
-/* open file */
-inimage = fopen (file_name, "rb");
-if (inimage == NULL)
-   {
-   printf ("read_pgm_to_double: cannot open file '%s'\n", file_name);
-   exit(1);
-   }
-
-/* read header */
-if (fgets(row, 80, inimage) == NULL)
-   {
-   printf ("read_pgm_to_double: cannot read file\n");
-   exit(1);
-   }
-
-/* image type: P5 */
-if ((row[0] == 'P') && (row[1] == '5'))
-   {
-   /* P5: grey scale image */
-   }
-else
-   {
-   printf ("read_pgm_to_double: unknown image format\n");
-   exit(1);
-   }
-
-/* read image size in x direction */
-skip_white_space_and_comments (inimage);
-if (!fscanf (inimage, "%ld", nx))
-   {
-   printf ("read_pgm_to_double: cannot read image size nx\n");
-   exit(1);
-   }
-
-/* read image size in x direction */
-skip_white_space_and_comments (inimage);
-if (!fscanf (inimage, "%ld", ny))
-   {
-   printf ("read_pgm_to_double: cannot read image size ny\n");
-   exit(1);
-   }
-
-/* read maximum grey value */
-skip_white_space_and_comments (inimage);
-if (!fscanf (inimage, "%ld", &max_value))
-   {
-   printf ("read_pgm_to_double: cannot read maximal value\n");
-   exit(1);
-   }
-fgetc(inimage);
-
-/* allocate memory */
-alloc_double_matrix (u, (*nx)+2, (*ny)+2);
-
-/* read image data row by row */
-for (j=1; j<=(*ny); j++)
- for (i=1; i<=(*nx); i++)
-     (*u)[i][j] = (double) getc(inimage);
-
-/* close file */
-fclose (inimage);
-
-return;
-
-}  /* read_pgm_to_double */
-
-/*--------------------------------------------------------------------------*/
-
 void comment_line
 
      (char* comment,       /* comment string (output) */
@@ -344,597 +115,387 @@ return;
 
 /*--------------------------------------------------------------------------*/
 
-void write_double_to_pgm
+void reverse_rows
 
-     (double  **u,          /* image, unchanged */
-      long    nx,           /* image size in x direction */
-      long    ny,           /* image size in y direction */
-      char    *file_name,   /* name of pgm file */
-      char    *comments)    /* comment string (set 0 for no comments) */
+     (image    *u,          /* image, changed */
+      long     j0,          /* first row */
+      long     j1)          /* last row */
 
 /*
-  writes a greyscale image in double format into a pgm P5 file
+  reverses the order of the rows j0,...,j1 by swapping whole rows
 */
 
 {
-FILE           *outimage;  /* output file */
-long           i, j;       /* loop variables */
-double         aux;        /* auxiliary variable */
-unsigned char  byte;       /* for data conversion */
-
-/* open file */
-outimage = fopen (file_name, "wb");
-if (NULL == outimage)
-   {
-   printf("could not open file '%s' for writing, aborting\n", file_name);
-   exit(1);
-   }
-
-/* write header */
-fprintf (outimage, "P5\n");                  /* format */
-if (comments != 0)
-   fputs (comments, outimage);               /* comments */
-fprintf (outimage, "%ld %ld\n", nx, ny);     /* image size */
-fprintf (outimage, "255\n");                 /* maximal value */
+long    i;            /* loop variable */
+pixel   *p, *q;       /* rows to be swapped */
+pixel   help;         /* auxiliary variable */
 
-/* write image data */
-for (j=1; j<=ny; j++)
- for (i=1; i<=nx; i++)
-     {
-     aux = u[i][j] + 0.499999;    /* for correct rounding */
-     if (aux < 0.0)
-        byte = (unsigned char)(0.0);
-     else if (aux > 255.0)
-        byte = (unsigned char)(255.0);
-     else
-        byte = (unsigned char)(aux);
-     fwrite (&byte, sizeof(unsigned char), 1, outimage);
-     }
-
-/* close file */
-fclose (outimage);
+for (; j0<j1; j0++, j1--)
+    {
+    p = ROW(u,j0);
+    q = ROW(u,j1);
+    for (i=0; i<u->stride; i++)
+        {
+        help = p[i];
+        p[i] = q[i];
+        q[i] = help;
+        }
+    }
 
 return;
 
-}  /* write_double_to_pgm */
+} /* reverse_rows */
 
-/*--------------------------------------------------------------------------*/
+/* ---------------------------------------------------------------------- */
 
-void analyse_grey_double
+void reverse_vector
 
-     (double  **u,         /* image, unchanged */
-      long    nx,          /* pixel number in x direction */
-      long    ny,          /* pixel number in y direction */
-      double  *min,        /* minimum, output */
-      double  *max,        /* maximum, output */
-      double  *mean,       /* mean, output */
-      double  *std)        /* standard deviation, output */
+     (pixel    *v,          /* vector, changed */
+      long     i0,          /* first entry */
+      long     i1)          /* last entry */
 
 /*
-  computes minimum, maximum, mean, and standard deviation of a greyscale
-  image u in double format
+  reverses the entries i0,...,i1 of v
 */
 
 {
-long    i, j;       /* loop variables */
-double  help1;      /* auxiliary variable */
-double  help2;      /* auxiliary variable */
-
-/* compute maximum, minimum, and mean */
-*min  = u[1][1];
-*max  = u[1][1];
-help1 = 0.0;
-for (i=1; i<=nx; i++)
- for (j=1; j<=ny; j++)
-     {
-     if (u[i][j] < *min) *min = u[i][j];
-     if (u[i][j] > *max) *max = u[i][j];
-     help1 = help1 + u[i][j];
-     }
-*mean = help1 / (nx * ny);
-
-/* compute standard deviation */
-*std = 0.0;
-for (i=1; i<=nx; i++)
- for (j=1; j<=ny; j++)
-     {
-     help2  = u[i][j] - *mean;
-     *std = *std + help2 * help2;
-     }
-*std = sqrt(*std / (nx * ny));
+pixel   help;         /* auxiliary variable */
+
+for (; i0<i1; i0++, i1--)
+    {
+    help  = v[i0];
+    v[i0] = v[i1];
+    v[i1] = help;
+    }
 
 return;
 
-}  /* analyse_grey_double */
+} /* reverse_vector */
 
-/*--------------------------------------------------------------------------*/
+/* ---------------------------------------------------------------------- */
 
-long mylog2 
+void periodic_shift  
 
-     (long n)               /* should be positive */
+     (image    *u,          /* image, changed */
+      long     nx,          /* pixel number in x direction */ 
+      long     ny,          /* pixel number in y direction */
+      long     xshift,      /* shift in x direction */ 
+      long     yshift)      /* shift in y direction */ 
 
 /*
-  returns ld(n) if n is a power of 2; 
-  returns -1    in all other cases. 
+  shifts an image u by the translation vector (xshift,yshift) 
+  with 0 <= xshift <= nx-1 and 0 <= yshift <= ny-1;
+  in place: a cyclic shift by s is the reversal of the whole signal
+  followed by the reversals of its first s and its last n-s entries
 */
 
 {
-long  ld;     /* ld(n) */
-long  m;      /* auxiliary variable */
+long    j;            /* loop variable */
 
-if (n <= 0)
-   ld = -1;
-else if (n == 1)
-   ld = 0;
-else
+/* shift in x direction */
+if (xshift > 0)
+   for (j=1; j<=ny; j++)
+       {
+       reverse_vector (ROW(u,j), 1, nx);
+       reverse_vector (ROW(u,j), 1, xshift);
+       reverse_vector (ROW(u,j), xshift+1, nx);
+       }
+
+/* shift in y direction */
+if (yshift > 0)
    {
-   ld = 0;
-   m  = 1; 
-   do {
-      m = 2 * m; 
-      ld = ld + 1;
-      }
-   while (m < n);
-   if (m > n) ld = -1;
+   reverse_rows (u, 1, ny);
+   reverse_rows (u, 1, yshift);
+   reverse_rows (u, yshift+1, ny);
    }
 
-return (ld);
-}
+return;
 
-/*--------------------------------------------------------------------------*/
+} /* periodic_shift */
 
-void FFT 
+/* ---------------------------------------------------------------------- */
 
-     (double   *vr,         /* real part of signal / Fourier coeff. */
-      double   *vi,         /* imaginary part of signal / Fourier coeff. */
-      long     n)           /* signal length, has to be power of 2 */ 
+void filter
+
+     (long     nx,        /* image dimension in x direction */
+      image    *fr,       /* real half spectrum, changed */
+      image    *fi)       /* imaginary half spectrum, changed */
 
 /*
-  Fast Fourier Transform of a (complex) 1-D signal. 
-  Based on the description in the Bronstein book.
-  The signal length has to be a power of 2.
-  Written by Martin Welk.
+  reads a filter and applies it to the Fourier coefficients;
+  the half spectrum has the x frequencies 0,...,nx/2 in the columns
+  1,...,nx/2+1 and is centred in y direction (frequency 0 in row ny/2+1
+  for ny rows);
+  a plain integer selects the former stripe filter with that height
 */
 
 {
-const    float fa = sqrt(0.5);    /* frequently used renormalization factor */
-long     p, q, r, j, k;           /* variables for indices and sizes */
-long     nh, qq, qh;              /* variables for indices and sizes */
-long     jq, jqh, jv, jn;         /* variables for indices and sizes */
-long     logn;                    /* ld(n) */
-long     m;                       /* auxiliary variable */
-double   rh, ih, ch, chih;        /* for intermediate results */
-double   *scrr, *scri, *exh;      /* auxiliary vectors */
-double   *srr;                    /* point at source arrays, real part */ 
-double   *sri;                    /* point at source arrays, imag. part */ 
-double   *der;                    /* point at dest. arrays, real part */ 
-double   *dei;                    /* point at dest. arrays, imag. part */
-double   *swpp;                   /* used for pointer swapping */
-
-
-/* ---- memory allocations ---- */
-
-alloc_double_vector (&scrr, n);
-alloc_double_vector (&scri, n);
-alloc_double_vector (&exh,  n);
-
-
-/* ---- initialisations ----*/
-
-/* initialise pointers */
-srr = vr; 
-sri = vi; 
-der = scrr; 
-dei = scri; 
-
-/* logn := ld(n) */
-m = n;
-logn = -1;
-while (m >= 1)
-      {
-      m >>= 1;              /* m = m / 2 */
-      logn ++;               
-      }
-
-/* initialise sizes */
-nh = n>>1;                  /* n / 2 */ 
-qh = nh>>1;                 /* n / 4 */ 
+char         name[80];    /* filter type or stripe height */
+char         *end;        /* end of a number */
+long         height;      /* stripe height */
+long         legacy;      /* former stripe filter? */
+freq_filter  f;           /* filter */
 
-/* trigonometric values */
-exh[0]  = 1.0;   exh[nh]    = 0.0;    /* exp (2 pi i 0.0 ) */
-exh[qh] = 0.0;   exh[nh+qh] = 1.0;    /* exp (2 pi i 0.25) */
-ch = -1.0;                            /* cos pi */
-/* further trigonometric values will be computed by recursion */
+memset (&f, 0, sizeof(freq_filter));
 
-/* other initialisations */
-qq = n; 
-q  = nh; 
-qh = q>>1; 
-p  = 1;
+printf ("filter (none, lowpass, highpass, bandpass, bandstop, notch,\n");
+printf ("        stripe, or stripe height (integer)): ");
+read_string (name);
 
+height = strtol (name, &end, 10);
+legacy = ((end != name) && (*end == '\0'));
+if (legacy)
+   {
+   /* horizontal stripe |ky| <= height outside the band |kx| < 1 */
+   f.type   = FILTER_STRIPE;
+   f.shape  = FILTER_IDEAL;
+   f.width  = (double) height;
+   f.radius = 1.0;
+   }
+else
+   {
+   f.type = filter_type (name);
+   if (f.type < 0)
+      {
+      printf ("filter: unknown filter %s\n", name);
+      exit(1);
+      }
+   }
 
-/* ---- loop through all levels ----*/
+if ((f.type != FILTER_NONE) && !legacy)
+   {
+   printf ("profile (ideal, butterworth, gauss): ");
+   read_string (name);
+   f.shape = filter_shape (name);
+   if (f.shape < 0)
+      {
+      printf ("filter: unknown profile %s\n", name);
+      exit(1);
+      }
+   if (f.shape == FILTER_BUTTERWORTH)
+      {
+      printf ("order n (>0):                        ");
+      read_double (&f.order);
+      }
 
-for (r=logn; r>=1; r--) 
-    {
-    /* iterate through levels */
-    if (r < logn) 
-       ch = sqrt (0.5 * (1.0 + ch));    /* recursion for cosines */
-    for (j=0; j<p; j++) 
-        {         
-        /* iterate through columns */
-        jq = j * qq; 
-        jqh = jq >> 1;
-        if (((j&1)==1) && (r<logn-1)) 
-           {       
-           /* recursion for exp(i*angle) */
-           chih = 0.5 / ch;                    /* cosine inverse half */
-           jv = jqh - q;                       
-           jn = jqh + q; 
-           if (jn == nh) 
-              {                   
-              /* use half-angle formula for exp */
-              exh[jqh]    = (exh[jv] - 1.0) * chih;
-              exh[jqh+nh] = exh[jv+nh] * chih;
-              }
-           else 
-              {
-              exh[jqh]    = (exh[jv]    + exh[jn]   ) * chih;
-              exh[jqh+nh] = (exh[jv+nh] + exh[jn+nh]) * chih;
-              }
-           } /* if */
-        for (k=0; k<q; k++) 
-            {               
-            /* iterate through rows */
-            rh =  exh[jqh]    * srr[jq+k+q] + exh[jqh+nh] * sri[jq+k+q];
-            ih = -exh[jqh+nh] * srr[jq+k+q] + exh[jqh]    * sri[jq+k+q];
-            der[jqh+k]    = fa * (srr[jq+k] + rh);
-            dei[jqh+k]    = fa * (sri[jq+k] + ih);
-            der[jqh+nh+k] = fa * (srr[jq+k] - rh);
-            dei[jqh+nh+k] = fa * (sri[jq+k] - ih);
-            }
-        } /* for j */
-        
-        /* swap array pointers */
-        swpp = srr;   srr = der;   der = swpp;        
-        swpp = sri;   sri = dei;   dei = swpp;
-
-        /* adjust sizes */ 
-        qq = q; 
-        q = qh; 
-        qh >>= 1; 
-        p <<= 1;          
-    }  /* for r */
-
-/* copy f^ back, if ld(n) is odd */
-if ((logn&1) == 1)                             
-   for (j=0; j<n; j++) 
-       {                 
-       der[j] = srr[j]; 
-       dei[j] = sri[j]; 
-       }
+   switch (f.type)
+      {
+      case FILTER_LOWPASS:
+      case FILTER_HIGHPASS:
+         printf ("cut-off frequency r (pixels):        ");
+         read_double (&f.radius);
+         break;
+      case FILTER_BANDPASS:
+      case FILTER_BANDSTOP:
+         printf ("band centre r (pixels):              ");
+         read_double (&f.radius);
+         printf ("band width w (pixels):               ");
+         read_double (&f.width);
+         break;
+      case FILTER_NOTCH:
+         printf ("notch frequency u0 (pixels):         ");
+         read_double (&f.u0);
+         printf ("notch frequency v0 (pixels):         ");
+         read_double (&f.v0);
+         printf ("notch radius w (pixels):             ");
+         read_double (&f.width);
+         break;
+      case FILTER_STRIPE:
+         printf ("stripe angle (degrees):              ");
+         read_double (&f.angle);
+         printf ("stripe half-width w (pixels):        ");
+         read_double (&f.width);
+         printf ("kept radius r along the stripe:      ");
+         read_double (&f.radius);
+         break;
+      }
+   }
+printf ("\n");
 
+/* multiply with the cached mask for this filter and image size */
+apply_filter (&f, fr, fi, nx, 1);
 
-/* ---- free memory ----*/
+return;
 
-free_double_vector (scrr, n);
-free_double_vector (scri, n);
-free_double_vector (exh,  n);
+} /* filter */
 
-return;
+/* ---------------------------------------------------------------------- */
 
-} /* FFT */
-  
-/* ----------------------------------------------------------------------- */
+typedef struct
+   {
+   image   *fr, *fi;     /* real / imaginary half spectrum */
+   image   *w;           /* logarithmic spectrum, output */
+   long    nx, ny;       /* image dimensions */
+   double  *max;         /* maximum of each row, output */
+   double  scale;        /* rescaling factor */
+   } spectrum_task;
 
-void DFT  
+/*--------------------------------------------------------------------------*/
 
-     (double   *vr,         /* real part of signal / Fourier coeff. */
-      double   *vi,         /* imaginary part of signal / Fourier coeff. */
-      long     n)           /* signal length (>0) */ 
+void log_spectrum_rows
 
+     (long     first,     /* first row */
+      long     last,      /* last row */
+      void     *arg)      /* spectrum_task */
 
-/* 
- Discrete Fourier transform of a (complex) 1-D signal. Quadratic complexity.
- Does not require powers of 2 as signal length.
+/*
+  logarithmic spectrum and its maximum for the rows first,...,last;
+  the centred full spectrum is expanded from the half spectrum with
+  F(-kx,-ky) = conj F(kx,ky)
 */
 
 {
-long    i, j;              /* loop variables */
-double  help1, help2;      /* time savers */
-double  help3, c, s;       /* time savers */
-double  *fr, *fi;          /* auxiliary vectors (real / imaginary part) */
-     
- 
-/* ---- allocate memory ---- */
-
-alloc_double_vector (&fr, n);
-alloc_double_vector (&fi, n);
-
-
-/* ---- copy (vr,vi) into (fr,fi) ---- */
-
-for (i=0; i<=n-1; i++)
-    {
-    fr[i] = vr[i];
-    fi[i] = vi[i];
-    }
-
-
-/* ---- time savers ---- */
-
-help1 = - 2.0 * 3.14159265359 / (double)n;
-help2 = 1.0 / sqrt ((double)n);
-
- 
-/* ---- perform DFT ---- */
-
-for (i=0; i<=n-1; i++)
+spectrum_task  *t = (spectrum_task *) arg;   /* task */
+image          *fr = t->fr;                  /* real part */
+image          *fi = t->fi;                  /* imaginary part */
+image          *w = t->w;                    /* spectrum */
+long           i, j;                         /* loop variables */
+long           ih, jh;                       /* pixel in the half spectrum */
+long           jm;                           /* mirrored row */
+long           cx, cy;                       /* centre */
+long           ky;                           /* mirrored y frequency */
+
+cx = t->nx/2 + 1;
+cy = t->ny/2 + 1;
+
+for (j=first; j<=last; j++)
     {
-    vr[i] = 0.0;
-    vi[i] = 0.0;
-    for (j=0; j<=n-1; j++)
+    /* row of the frequency -ky, wrapped into the centred range */
+    ky = cy - j;
+    if (ky > t->ny - 1 - t->ny/2)
+       ky = ky - t->ny;
+    jm = ky + cy;
+
+    t->max[j] = 0.0;
+    for (i=1; i<=t->nx; i++)
         {
-        help3 = help1 * i * j;
-        c     = cos (help3);
-        s     = sin (help3);
-        vr[i] = vr[i] + fr[j] * c - fi[j] * s;
-        vi[i] = vi[i] + fi[j] * c + fr[j] * s;
+        if (i >= cx)
+           {
+           ih = i - cx + 1;
+           jh = j;
+           }
+        else
+           {
+           ih = cx - i + 1;
+           jh = jm;
+           }
+        PIX(w,i,j) = log (1.0 + sqrt (PIX(fr,ih,jh) * PIX(fr,ih,jh)
+                                      + PIX(fi,ih,jh) * PIX(fi,ih,jh)));
+        if (PIX(w,i,j) > t->max[j]) 
+           t->max[j] = PIX(w,i,j);
         }
-    vr[i] = vr[i] * help2;
-    vi[i] = vi[i] * help2;
     }
 
-
-/* ---- free memory ---- */
-
-free_double_vector (fr, n);
-free_double_vector (fi, n);
-
 return;
 
-} /* DFT */
-
-/* ---------------------------------------------------------------------- */
+} /* log_spectrum_rows */
 
-void FT2D  
+/*--------------------------------------------------------------------------*/
 
-     (double   **ur,        /* real part of image / Fourier coeff. */
-      double   **ui,        /* imaginary part of image / Fourier coeff. */
-      long     nx,          /* pixel number in x direction */ 
-      long     ny)          /* pixel number in y direction */ 
+void scale_rows
 
+     (long     first,     /* first row */
+      long     last,      /* last row */
+      void     *arg)      /* spectrum_task */
 
-/* 
-  Two-dimensional discrete Fourier transform of a (complex) image.
-  This algorithm exploits the separability of the Fourier transform. 
-  Uses FFT when the pixel numbers are powers of 2, DFT otherwise.
+/*
+  multiplies the rows first,...,last of the spectrum by the rescaling factor
 */
 
-
 {
-long    i, j;              /* loop variables */
-long    n;                 /* max (nx, ny) */
-long    logn;              /* ld(n) */
-double  *vr, *vi;          /* real / imaginary signal or Fourier data */
-
-
-/* ---- allocate memory for auxiliary vectors vr, vi ---- */
+spectrum_task  *t = (spectrum_task *) arg;   /* task */
+long           i, j;                         /* loop variables */
 
-if (nx > ny) 
-   n = nx; 
-else 
-   n = ny;
-
-alloc_double_vector (&vr, n);
-alloc_double_vector (&vi, n);
-
-
-/* ---- transform along x direction ---- */
-
-logn = mylog2 (nx);
-for (j=0; j<=ny-1; j++)
-    {
-    /* write in 1-D vector */
-    for (i=0; i<=nx-1; i++)
-        {
-        vr[i] = ur[i+1][j+1];
-        vi[i] = ui[i+1][j+1];
-        }
-
-    /* apply Fourier transform */
-    if (logn == -1)
-       /* nx is not a power of 2; use DFT */
-       DFT (vr, vi, nx); 
-    else
-       /* nx is a power of 2; use FFT */
-       FFT (vr, vi, nx); 
-
-    /* write back in 2-D image */
-    for (i=0; i<=nx-1; i++)
-        {
-        ur[i+1][j+1] = vr[i];
-        ui[i+1][j+1] = vi[i];
-        }
-    }
-
-
-/* ---- transform along y direction ---- */
-
-logn = mylog2 (ny);
-for (i=0; i<=nx-1; i++)
-    {
-    /* write in 1-D vector */
-    for (j=0; j<=ny-1; j++)
-        {
-        vr[j] = ur[i+1][j+1];
-        vi[j] = ui[i+1][j+1];
-        }
-
-    /* apply Fourier transform */
-    if (logn == -1) 
-       /* ny is not a power of 2; use DFT */
-       DFT (vr, vi, ny);
-    else
-       /* ny is a power of 2; use FFT */
-       FFT (vr, vi, ny); 
-
-    /* write back in 2-D image */
-    for (j=0; j<=ny-1; j++)
-        {
-        ur[i+1][j+1] = vr[j];
-        ui[i+1][j+1] = vi[j];
-        }
-    }
-
-
-/* ---- free memory ---- */
-
-free_double_vector (vr, n);
-free_double_vector (vi, n);
+for (j=first; j<=last; j++)
+ for (i=1; i<=t->nx; i++)
+     PIX(t->w,i,j) = t->scale * PIX(t->w,i,j);
 
 return;
 
-} /* FT2D */
+} /* scale_rows */
 
-/* ---------------------------------------------------------------------- */
+/*--------------------------------------------------------------------------*/
 
-void periodic_shift  
+void log_spectrum
 
-     (double   **u,         /* image, changed */
-      long     nx,          /* pixel number in x direction */ 
-      long     ny,          /* pixel number in y direction */
-      long     xshift,      /* shift in x direction */ 
-      long     yshift)      /* shift in y direction */ 
+     (long     nx,        /* image dimension in x direction */
+      long     ny,        /* image dimension in y direction */
+      image    *fr,       /* real half spectrum, unchanged */
+      image    *fi,       /* imaginary half spectrum, unchanged */
+      image    *w)        /* logarithmic spectrum, output */
 
 /*
-  shifts an image u by the translation vector (xshift,yshift) 
-  with 0 <= xshift <= nx-1 and 0 <= yshift <= ny-1
+  computes the centred logarithmic Fourier spectrum of size nx * ny from
+  the y-centred half spectrum, rescaled such that its maximum is 255
 */
 
 {
-long    i, j;         /* loop variables */
-double  **f;          /* auxiliary image */
-
-/* allocate memory */
-alloc_double_matrix (&f, nx + 2, ny + 2);
+long           j;         /* loop variable */
+double         max;       /* maximum */
+spectrum_task  t;         /* rows to be processed */
+
+t.fr  = fr;
+t.fi  = fi;
+t.w   = w;
+t.nx  = nx;
+t.ny  = ny;
+t.max = (double *) malloc ((ny + 1) * sizeof(double));
+if (t.max == NULL)
+   {
+   printf("log_spectrum: not enough memory available\n");
+   exit(1);
+   }
 
-/* shift in x direction */
-for (i=1; i<=nx; i++)
- for (j=1; j<=ny; j++)
-     if (i-xshift >= 1)
-        f[i][j] = u[i-xshift][j];
-     else 
-        f[i][j] = u[i+nx-xshift][j];
+parallel_rows (1, ny, log_spectrum_rows, &t);
 
-/* shift in y direction */
-for (i=1; i<=nx; i++)
- for (j=1; j<=ny; j++)
-     if (j-yshift >= 1)
-        u[i][j] = f[i][j-yshift];
-     else 
-        u[i][j] = f[i][j+ny-yshift];
+max = 0.0;
+for (j=1; j<=ny; j++)
+    if (t.max[j] > max)
+       max = t.max[j];
 
-/* free memory */
-free_double_matrix (f, nx + 2, ny + 2);
+/* rescale such that max(PIX(w,i,j))=255 */
+if (max > 0.0)
+   {
+   t.scale = 255.0 / max;
+   parallel_rows (1, ny, scale_rows, &t);
+   }
 
+free (t.max);
 return;
 
-} /* periodic_shift */
+} /* log_spectrum */
 
-/* ---------------------------------------------------------------------- */
-
-void filter
+/*--------------------------------------------------------------------------*/
 
-     (long     nx,        /* image dimension in x direction */
-      long     ny,        /* image dimension in y direction */
-      double   **ur,      /* input: original real image */
-      double   **ui)      /* input: original imaginary image */
+void run_job ()
 
 /*
-  allows to filter the Fourier coefficients
+  reads the parameters of one job and processes it
 */
 
-{
-long   i, j;        /* loop variables */
-long   centre_x;    /* nx/2 + 1 */
-long   centre_y;    /* ny/2 + 1 */
-
-/* compute centres */
-centre_x = nx/2 + 1;
-centre_y = ny/2 + 1;
-
-long r = 1;
-long height = 0;
-
-// printf ("filter radius, inside radius will not be filtered\n\
-// r should be bigger than 1 (integer):     \n\n");
-// read_long (&r);
-
-printf ("filter height (integer):     \n\n");
-read_long (&height);
-
-/* filter Fourier coefficients */
-for (i=1; i<=nx; i++)
- for (j=1; j<=ny; j++)
-     {
-      if((j >= centre_x - height && j <= centre_x + height) && (i <= centre_y - r || i >= centre_y + r)){
-         ur[i][j] = 0;
-         ui[i][j] = 0;
-      }
-      // if((i >= centre_x - height && i <= centre_x + height) && (j <= centre_y - r || j >= centre_y + r)){
-      //    ur[i][j] = 0;
-      //    ui[i][j] = 0;
-      // }
-     }
-
-return;
-
-} /* filter */
-
-/* ---------------------------------------------------------------------- */
-
-int main ()
-
 {
 char    in[80];               /* for reading data */
 char    out1[80];             /* for reading data */
 char    out2[80];             /* for reading data */
-double  **ur, **ui;           /* real / imaginary image or Fourier data */
-double  **w, **m;             /* logarithmic Fourier spectrum */
+image   *u;                   /* image */
+image   *fr, *fi;             /* real / imaginary half spectrum */
+image   *w;                   /* logarithmic Fourier spectrum */
 long    nx, ny;               /* image size in x, y direction */
-long    i, j;                 /* loop variables */
-double  help;                 /* auxiliary variable for rescaling */
-double  max;                  /* maximum */
+long    centre;               /* centring folded into the FFT? */
 char    comments[1600];       /* string for comments */
 
-printf ("\n");
-printf ("FOURIER ANALYSIS\n\n");
-printf ("**************************************************\n\n");
-printf ("    Copyright 2021 by Joachim Weickert            \n");
-printf ("    and 2013 by Martin Welk and Pascal Peter      \n");
-printf ("    Dept. of Mathematics and Computer Science     \n");
-printf ("    Saarland University, Saarbruecken, Germany    \n\n");
-printf ("    All rights reserved. Unauthorized usage,      \n");
-printf ("    copying, hiring, and selling prohibited.      \n\n");
-printf ("    Send bug reports to                           \n");
-printf ("    weickert@mia.uni-saarland.de                  \n\n");
-printf ("**************************************************\n\n");
-
-
 /* ---- read input image (pgm format P5) ---- */
 
 printf ("input image (pgm):                     ");
 read_string (in);
-read_pgm_to_double (in, &nx, &ny, &ur);  /* also allocates memory for ur */
+read_pgm_to_double (in, 1, &u);  /* also allocates memory for u */
+nx = u->nx;
+ny = u->ny;
 
-/* allocate memory and initialise imaginary image */
-alloc_double_matrix (&ui, nx+2, ny+2);
-alloc_double_matrix (&w,  nx+2, ny+2);
-alloc_double_matrix (&m,  nx+2, ny+2);
-for (j=0; j<=ny+1; j++)
- for (i=0; i<=nx+1; i++)
-     ui[i][j] = 0.0;
+/* allocate memory: half spectrum with the x frequencies 0,...,nx/2 */
+alloc_image (&fr, 1, nx/2+1, ny, 1);
+alloc_image (&fi, 1, nx/2+1, ny, 1);
+alloc_image (&w, 1, nx, ny, 1);
 
 
 /* ---- read parameters ---- */
@@ -950,57 +511,46 @@ printf ("\n");
 /* ---- compute discrete Fourier transformation ---- */
 
 printf ("computing Fourier transformation\n");
-FT2D (ur, ui, nx, ny);
+
+/* for even ny, the shift of the lowest frequency to the centre is */
+/* done by the FFT itself (modulation with (-1)^j)                  */
+centre = (ny % 2 == 0);
+fft2d_real (u, fr, fi, centre);
 
 
 /* ---- shift lowest frequency in the centre ----*/
 
-periodic_shift (ur, nx, ny, nx/2, ny/2);
-periodic_shift (ui, nx, ny, nx/2, ny/2);
+if (!centre)
+   {
+   periodic_shift (fr, nx/2+1, ny, 0, ny/2);
+   periodic_shift (fi, nx/2+1, ny, 0, ny/2);
+   }
 
 
 /* ---- manipulate the Fourier coefficients ---- */
 
-filter (nx, ny, ur, ui);
+filter (nx, fr, fi);
 
 
 /* ---- compute logarithmic spectrum ---- */
 
 printf ("computing logarithmic spectrum\n");
-max = 0.0;
-for (i=1; i<=nx; i++)
- for (j=1; j<=ny; j++)
-     {
-     w[i][j] = log (1.0 + sqrt (ur[i][j] * ur[i][j] + ui[i][j] * ui[i][j]));
-     if (w[i][j] > max) 
-        max = w[i][j];
-     }
-
-/* rescale such that max(w[i][j])=255 */
-if (max > 0.0)
-   {
-   help = 255.0 / max;
-   for (i=1; i<=nx; i++)
-    for (j=1; j<=ny; j++)
-        w[i][j] = help * w[i][j];
-   }
+log_spectrum (nx, ny, fr, fi, w);
 
 
 /* ---- shift lowest frequency back to the corners ----*/
 
-periodic_shift (ur, nx, ny, nx-nx/2, ny-ny/2);
-periodic_shift (ui, nx, ny, nx-nx/2, ny-ny/2);
+if (!centre)
+   {
+   periodic_shift (fr, nx/2+1, ny, 0, ny-ny/2);
+   periodic_shift (fi, nx/2+1, ny, 0, ny-ny/2);
+   }
 
 
 /* ---- compute discrete Fourier backtransformation ---- */
 
 printf ("computing Fourier backtransformation\n\n");
-
-/* backtransformation = DFT of complex conjugated Fourier coefficients */
-for (i=1; i<=nx; i++)
- for (j=1; j<=ny; j++)
-     ui[i][j] = - ui[i][j];
-FT2D (ur, ui, nx, ny);
+ifft2d_real (fr, fi, u, centre);
 
 
 /* ---- write output image 1 (log. spectrum) (pgm format P5) ---- */
@@ -1010,7 +560,7 @@ comments[0]='\0';
 comment_line (comments, "# logarithmic Fourier spectrum\n");
 
 /* write image */
-write_double_to_pgm (w, nx, ny, out1, comments);
+write_double_to_pgm (w, out1, comments);
 printf ("output image %s successfully written\n\n", out1);
 
 
@@ -1021,16 +571,48 @@ comments[0]='\0';
 comment_line (comments, "# Fourier filtering\n");
 
 /* write image */
-write_double_to_pgm (ur, nx, ny, out2, comments);
+write_double_to_pgm (u, out2, comments);
 printf ("output image %s successfully written\n\n", out2);
 
 
 /* ---- free memory  ---- */
 
-free_double_matrix (ur, nx+2, ny+2);
-free_double_matrix (ui, nx+2, ny+2);
-free_double_matrix (w,  nx+2, ny+2);
-free_double_matrix (m,  nx+2, ny+2);
+free_image (u);
+free_image (fr);
+free_image (fi);
+free_image (w);
+
+return;
+
+}  /* run_job */
+
+/*--------------------------------------------------------------------------*/
+
+int main
+
+     (int   argc,        /* number of command line arguments */
+      char  **argv)      /* command line arguments */
+
+{
+printf ("\n");
+printf ("FOURIER ANALYSIS\n\n");
+printf ("**************************************************\n\n");
+printf ("    Copyright 2021 by Joachim Weickert            \n");
+printf ("    and 2013 by Martin Welk and Pascal Peter      \n");
+printf ("    Dept. of Mathematics and Computer Science     \n");
+printf ("    Saarland University, Saarbruecken, Germany    \n\n");
+printf ("    All rights reserved. Unauthorized usage,      \n");
+printf ("    copying, hiring, and selling prohibited.      \n\n");
+printf ("    Send bug reports to                           \n");
+printf ("    weickert@mia.uni-saarland.de                  \n\n");
+printf ("**************************************************\n\n");
+
+/* ---- one run per job (interactive mode: exactly one) ---- */
+
+read_options (argc, argv);
+while (next_job ())
+   run_job ();
 
 return(0);
-}
+
+}  /* main */
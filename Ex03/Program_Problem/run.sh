@@ -1,14 +1,13 @@
 ins=("smoke" "fire")
 heights=(0 1)
+# one job per line: input image, spectrum, backtransformed image, height
+: > jobs.txt
 for input in ${ins[@]}
 do
     for height in ${heights[@]}
     do
-        echo $input.pgm > tes.txt
-        echo result/$input.h=$height.log.spectrum.pgm >> tes.txt
-        echo result/$input.h=$height.backtrans.pgm >> tes.txt
-        echo $height >> tes.txt
-        ./DFT < tes.txt >> 1.log.txt
+        echo $input.pgm result/$input.h=$height.log.spectrum.pgm result/$input.h=$height.backtrans.pgm $height >> jobs.txt
     done
 done
-rm tes.txt
\ No newline at end of file
+./DFT -b jobs.txt >> 1.log.txt
+rm jobs.txt
\ No newline at end of file
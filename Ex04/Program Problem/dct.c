@@ -4,6 +4,16 @@
 #include <math.h>
 #include <stdarg.h>
 #include <ctype.h>
+#include <time.h>
+
+#include "image.h"
+#include "cli.h"
+#include "parallel.h"
+#include "fft.h"
+#include "dct.h"
+#include "quant.h"
+#include "jpeg.h"
+#include "gauss.h"
 
 /*--------------------------------------------------------------------------*/
 /*                                                                          */
@@ -19,6 +29,27 @@
 
 /*--------------------------------------------------------------------------*/
 
+/* JPEG weighting matrix, entry 8*l+k for coefficient (k,l) */
+static const double jpeg_weight[64] =
+   { 10,  15,  25,  37,  51,  66,  82, 100,
+     15,  19,  28,  39,  52,  67,  83, 101,
+     25,  28,  35,  45,  58,  72,  88, 105,
+     37,  39,  45,  54,  66,  79,  94, 111,
+     51,  52,  58,  66,  76,  89, 103, 119,
+     66,  67,  72,  79,  89, 101, 114, 130,
+     82,  83,  88,  94, 103, 114, 127, 142,
+    100, 101, 105, 111, 119, 130, 142, 156 };
+
+/* data of the parallel loops */
+typedef struct
+   {
+   image        *u;       /* image in, reconstruction out */
+   image        *c;       /* quantised coefficients, output */
+   quant_table  q;        /* quantisation steps and reciprocals */
+   } quantisation_task;
+
+/*--------------------------------------------------------------------------*/
+
 void alloc_double_vector
 
      (double **vector,   /* vector */
@@ -43,43 +74,6 @@ return;
 
 /*--------------------------------------------------------------------------*/
 
-void alloc_double_matrix
-
-     (double ***matrix,  /* matrix */
-      long   n1,         /* size in direction 1 */
-      long   n2)         /* size in direction 2 */
-
-/*
-  allocates memory for a double format matrix of size n1 * n2
-*/
-
-{
-long i;    /* loop variable */
-
-*matrix = (double **) malloc (n1 * sizeof(double *));
-
-if (*matrix == NULL)
-   {
-   printf("alloc_double_matrix: not enough memory available\n");
-   exit(1);
-   }
-
-for (i=0; i<n1; i++)
-    {
-    (*matrix)[i] = (double *) malloc (n2 * sizeof(double));
-    if ((*matrix)[i] == NULL)
-       {
-       printf("alloc_double_matrix: not enough memory available\n");
-       exit(1);
-       }
-    }
-
-return;
-
-}  /* alloc_double_matrix */
-
-/*--------------------------------------------------------------------------*/
-
 void free_double_vector
 
      (double  *vector,    /* vector */
@@ -98,198 +92,6 @@ return;
 
 /*--------------------------------------------------------------------------*/
 
-void free_double_matrix
-
-     (double  **matrix,   /* matrix */
-      long    n1,         /* size in direction 1 */
-      long    n2)         /* size in direction 2 */
-
-/*
-  frees memory for a double format matrix of size n1 * n2
-*/
-
-{
-long i;   /* loop variable */
-
-for (i=0; i<n1; i++)
-free(matrix[i]);
-
-free(matrix);
-
-return;
-
-}  /* free_double_matrix */
-
-/*--------------------------------------------------------------------------*/
-
-void read_string
-
-     (char *v)         /* string to be read */
-
-/*
-  reads a string v
-*/
-
-{
-fgets (v, 80, stdin);
-
-if (v[strlen(v)-1] == '\n')
-   v[strlen(v)-1] = 0;
-
-return;
-
-}  /* read_string */
-
-/*--------------------------------------------------------------------------*/
-
-void read_long
-
-     (long *v)         /* value to be read */
-
-/*
-  reads a long value v
-*/
-
-{
-char   row[80];    /* string for reading data */
-
-fgets (row, 80, stdin);
-if (row[strlen(row)-1] == '\n')
-   row[strlen(row)-1] = 0;
-sscanf(row, "%ld", &*v);
-
-return;
-
-}  /* read_long */
-
-/*--------------------------------------------------------------------------*/
-
-void skip_white_space_and_comments
-
-     (FILE *inimage)  /* input file */
-
-/*
-  skips over white space and comments while reading the file
-*/
-
-{
-
-int   ch = 0;   /* holds a character */
-char  row[80];  /* for reading data */
-
-/* skip spaces */
-while (((ch = fgetc(inimage)) != EOF) && isspace(ch));
-
-/* skip comments */
-if (ch == '#')
-   {
-   if (fgets(row, sizeof(row), inimage))
-      skip_white_space_and_comments (inimage);
-   else
-      {
-      printf("skip_white_space_and_comments: cannot read file\n");
-      exit(1);
-      }
-   }
-else
-   fseek (inimage, -1, SEEK_CUR);
-
-return;
-
-} /* skip_white_space_and_comments */
-
-/*--------------------------------------------------------------------------*/
-
-void read_pgm_to_double
-
-     (const char  *file_name,    /* name of pgm file */
-      long        *nx,           /* image size in x direction, output */
-      long        *ny,           /* image size in y direction, output */
-      double      ***u)          /* image, output */
-
-/*
-  reads a greyscale image that has been encoded in pgm format P5 to
-  an image u in double format;
-  allocates memory for the image u;
-  adds boundary layers of size 1 such that
-  - the relevant image pixels in x direction use the indices 1,...,nx
-  - the relevant image pixels in y direction use the indices 1,...,ny
-*/
-
-{
-char  row[80];      /* for reading data */
-long  i, j;         /* image indices */
-long  max_value;    /* maximum color value */
-FILE  *inimage;     /* input file */
-
-/* open file */
-inimage = fopen (file_name, "rb");
-if (inimage == NULL)
-   {
-   printf ("read_pgm_to_double: cannot open file '%s'\n", file_name);
-   exit(1);
-   }
-
-/* read header */
-if (fgets(row, 80, inimage) == NULL)
-   {
-   printf ("read_pgm_to_double: cannot read file\n");
-   exit(1);
-   }
-
-/* image type: P5 */
-if ((row[0] == 'P') && (row[1] == '5'))
-   {
-   /* P5: grey scale image */
-   }
-else
-   {
-   printf ("read_pgm_to_double: unknown image format\n");
-   exit(1);
-   }
-
-/* read image size in x direction */
-skip_white_space_and_comments (inimage);
-if (!fscanf (inimage, "%ld", nx))
-   {
-   printf ("read_pgm_to_double: cannot read image size nx\n");
-   exit(1);
-   }
-
-/* read image size in x direction */
-skip_white_space_and_comments (inimage);
-if (!fscanf (inimage, "%ld", ny))
-   {
-   printf ("read_pgm_to_double: cannot read image size ny\n");
-   exit(1);
-   }
-
-/* read maximum grey value */
-skip_white_space_and_comments (inimage);
-if (!fscanf (inimage, "%ld", &max_value))
-   {
-   printf ("read_pgm_to_double: cannot read maximal value\n");
-   exit(1);
-   }
-fgetc(inimage);
-
-/* allocate memory */
-alloc_double_matrix (u, (*nx)+2, (*ny)+2);
-
-/* read image data row by row */
-for (j=1; j<=(*ny); j++)
- for (i=1; i<=(*nx); i++)
-     (*u)[i][j] = (double) getc(inimage);
-
-/* close file */
-fclose (inimage);
-
-return;
-
-}  /* read_pgm_to_double */
-
-/*--------------------------------------------------------------------------*/
-
 void comment_line
 
      (char* comment,       /* comment string (output) */
@@ -331,854 +133,778 @@ return;
 
 /*--------------------------------------------------------------------------*/
 
-void write_double_to_pgm
+void DCT_2d
 
-     (double  **u,          /* image, unchanged */
-      long    nx,           /* image size in x direction */
-      long    ny,           /* image size in y direction */
-      char    *file_name,   /* name of pgm file */
-      char    *comments)    /* comment string (set 0 for no comments) */
+     (image   *u,           /* image, unchanged */
+      image   *c)           /* coefficients of the DCT */
 
 /*
-  writes a greyscale image in double format into a pgm P5 file
+  computes DCT of input image;
+  fast orthonormal DCT via the FFT, see common/dct.h
 */
 
 {
-FILE           *outimage;  /* output file */
-long           i, j;       /* loop variables */
-double         aux;        /* auxiliary variable */
-unsigned char  byte;       /* for data conversion */
-
-/* open file */
-outimage = fopen (file_name, "wb");
-if (NULL == outimage)
-   {
-   printf("could not open file '%s' for writing, aborting\n", file_name);
-   exit(1);
-   }
-
-/* write header */
-fprintf (outimage, "P5\n");                  /* format */
-if (comments != 0)
-   fputs (comments, outimage);               /* comments */
-fprintf (outimage, "%ld %ld\n", nx, ny);     /* image size */
-fprintf (outimage, "255\n");                 /* maximal value */
-
-/* write image data */
-for (j=1; j<=ny; j++)
- for (i=1; i<=nx; i++)
-     {
-     aux = u[i][j] + 0.499999;    /* for correct rounding */
-     if (aux < 0.0)
-        byte = (unsigned char)(0.0);
-     else if (aux > 255.0)
-        byte = (unsigned char)(255.0);
-     else
-        byte = (unsigned char)(aux);
-     fwrite (&byte, sizeof(unsigned char), 1, outimage);
-     }
-
-/* close file */
-fclose (outimage);
+dct2d (u, c);
 
 return;
 
-}  /* write_double_to_pgm */
+} /* DCT_2d */
 
 /*--------------------------------------------------------------------------*/
 
-void analyse_grey_double
+void IDCT_2d
 
-     (double  **u,         /* image, unchanged */
-      long    nx,          /* pixel number in x direction */
-      long    ny,          /* pixel number in y direction */
-      double  *min,        /* minimum, output */
-      double  *max,        /* maximum, output */
-      double  *mean,       /* mean, output */
-      double  *std)        /* standard deviation, output */
+     (image   *u,           /* image, output */
+      image   *c)           /* coefficients of the DCT */
 
 /*
-  computes minimum, maximum, mean, and standard deviation of a greyscale
-  image u in double format
+  computes inverse DCT of input image;
+  fast orthonormal DCT via the FFT, see common/dct.h
 */
 
 {
-long    i, j;       /* loop variables */
-double  help1;      /* auxiliary variable */
-double  help2;      /* auxiliary variable */
-
-/* compute maximum, minimum, and mean */
-*min  = u[1][1];
-*max  = u[1][1];
-help1 = 0.0;
-for (i=1; i<=nx; i++)
- for (j=1; j<=ny; j++)
-     {
-     if (u[i][j] < *min) *min = u[i][j];
-     if (u[i][j] > *max) *max = u[i][j];
-     help1 = help1 + u[i][j];
-     }
-*mean = help1 / (nx * ny);
-
-/* compute standard deviation */
-*std = 0.0;
-for (i=1; i<=nx; i++)
- for (j=1; j<=ny; j++)
-     {
-     help2  = u[i][j] - *mean;
-     *std = *std + help2 * help2;
-     }
-*std = sqrt(*std / (nx * ny));
+idct2d (c, u);
 
 return;
 
-}  /* analyse_grey_double */
+} /* IDCT_2d */
 
 /*--------------------------------------------------------------------------*/
 
-void jpeg_multiply_block
+void remove_freq_2d
 
-     (double  **c_block)    /* coefficients of the DCT */
+     (image   *c,           /* in and out: coefficients of the DCT */
+      long    nx,           /* pixel number in x-direction */
+      long    ny)           /* pixel number in y-direction */
 
 /*
-  weights 8x8 coefficient block with JPEG weighting matrix
+  removes frequencies
 */
 
 {
-c_block[0][0] *= 10;
-c_block[0][1] *= 15;
-c_block[0][2] *= 25;
-c_block[0][3] *= 37;
-c_block[0][4] *= 51;
-c_block[0][5] *= 66;
-c_block[0][6] *= 82;
-c_block[0][7] *= 100;
-
-c_block[1][0] *= 15;
-c_block[1][1] *= 19;
-c_block[1][2] *= 28;
-c_block[1][3] *= 39;
-c_block[1][4] *= 52;
-c_block[1][5] *= 67;
-c_block[1][6] *= 83;
-c_block[1][7] *= 101;
-
-c_block[2][0] *= 25;
-c_block[2][1] *= 28;
-c_block[2][2] *= 35;
-c_block[2][3] *= 45;
-c_block[2][4] *= 58;
-c_block[2][5] *= 72;
-c_block[2][6] *= 88;
-c_block[2][7] *= 105;
-
-c_block[3][0] *= 37;
-c_block[3][1] *= 39;
-c_block[3][2] *= 45;
-c_block[3][3] *= 54;
-c_block[3][4] *= 66;
-c_block[3][5] *= 79;
-c_block[3][6] *= 94;
-c_block[3][7] *= 111;
-
-c_block[4][0] *= 51;
-c_block[4][1] *= 52;
-c_block[4][2] *= 58;
-c_block[4][3] *= 66;
-c_block[4][4] *= 76;
-c_block[4][5] *= 89;
-c_block[4][6] *= 103;
-c_block[4][7] *= 119;
-
-c_block[5][0] *= 66;
-c_block[5][1] *= 67;
-c_block[5][2] *= 72;
-c_block[5][3] *= 79;
-c_block[5][4] *= 89;
-c_block[5][5] *= 101;
-c_block[5][6] *= 114;
-c_block[5][7] *= 130;
-
-c_block[6][0] *= 82;
-c_block[6][1] *= 83;
-c_block[6][2] *= 88;
-c_block[6][3] *= 94;
-c_block[6][4] *= 103;
-c_block[6][5] *= 114;
-c_block[6][6] *= 127;
-c_block[6][7] *= 142;
-
-c_block[7][0] *= 100;
-c_block[7][1] *= 101;
-c_block[7][2] *= 105;
-c_block[7][3] *= 111;
-c_block[7][4] *= 119;
-c_block[7][5] *= 130;
-c_block[7][6] *= 142;
-c_block[7][7] *= 156;
+long i, j;        /* loop variables */
 
-return;
+/* set frequencies to zero */
+for (j=0; j<ny; j++)
+ for (i=0; i<nx; i++)
+     if ((i >= nx / sqrt (10.0)) || (j >= ny / sqrt (10.0)))
+        PIX(c,i,j) = 0.0;
 
-}  /* jpeg_multiply_block */
+return;
+}
 
 /*--------------------------------------------------------------------------*/
 
-void equal_multiply_block
+void blockwise_DCT_2d
 
-     (double  **c_block,    /* coefficients of the DCT */
-      long    factor)       /* factor to multiply */
+     (image   *u,           /* in: image */
+      image   *c,           /* out: coefficients of the DCT */
+      long    nx,           /* pixel number in x-direction */
+      long    ny)           /* pixel number in y-direction */
 
 /*
-  multiplies an 8x8 coefficient block with a given factor
+  computes DCT in image blocks of size 8x8;
+  each block is transformed on the stack with the butterflies of dct8x8
 */
 
 {
-long i, j;        /* loop variables */
-
-for (i=0; i<=7; i++)
- for (j=0; j<=7; j++)
-     c_block[i][j] *= factor;
-
-return;
-}
+long    i, j, k, l;       /* loop variables */
+double  block[64];        /* 8x8 block, row-major */
 
-/*--------------------------------------------------------------------------*/
 
-void jpeg_divide_block
+/* ---- DCT on 8x8 blocks ---- */
 
-     (double  **c_block)    /* coefficients of the DCT */
+for (j=0; j<ny; j+=8)
+ for (i=0; i<nx; i+=8)
+     {
+     /* copy 8x8 block */
+     for (l=0; l<=7; l++)
+      for (k=0; k<=7; k++)
+          block[8*l+k] = PIX(u,i+k,j+l);
 
-/*
-  weights 8x8 coefficient block with inverse JPEG weighting matrix
-*/
+     /* DCT of 8x8 block */
+     dct8x8 (block);
 
-{
-c_block[0][0] /= 10;
-c_block[0][1] /= 15;
-c_block[0][2] /= 25;
-c_block[0][3] /= 37;
-c_block[0][4] /= 51;
-c_block[0][5] /= 66;
-c_block[0][6] /= 82;
-c_block[0][7] /= 100;
-
-c_block[1][0] /= 15;
-c_block[1][1] /= 19;
-c_block[1][2] /= 28;
-c_block[1][3] /= 39;
-c_block[1][4] /= 52;
-c_block[1][5] /= 67;
-c_block[1][6] /= 83;
-c_block[1][7] /= 101;
-
-c_block[2][0] /= 25;
-c_block[2][1] /= 28;
-c_block[2][2] /= 35;
-c_block[2][3] /= 45;
-c_block[2][4] /= 58;
-c_block[2][5] /= 72;
-c_block[2][6] /= 88;
-c_block[2][7] /= 105;
-
-c_block[3][0] /= 37;
-c_block[3][1] /= 39;
-c_block[3][2] /= 45;
-c_block[3][3] /= 54;
-c_block[3][4] /= 66;
-c_block[3][5] /= 79;
-c_block[3][6] /= 94;
-c_block[3][7] /= 111;
-
-c_block[4][0] /= 51;
-c_block[4][1] /= 52;
-c_block[4][2] /= 58;
-c_block[4][3] /= 66;
-c_block[4][4] /= 76;
-c_block[4][5] /= 89;
-c_block[4][6] /= 103;
-c_block[4][7] /= 119;
-
-c_block[5][0] /= 66;
-c_block[5][1] /= 67;
-c_block[5][2] /= 72;
-c_block[5][3] /= 79;
-c_block[5][4] /= 89;
-c_block[5][5] /= 101;
-c_block[5][6] /= 114;
-c_block[5][7] /= 130;
-
-c_block[6][0] /= 82;
-c_block[6][1] /= 83;
-c_block[6][2] /= 88;
-c_block[6][3] /= 94;
-c_block[6][4] /= 103;
-c_block[6][5] /= 114;
-c_block[6][6] /= 127;
-c_block[6][7] /= 142;
-
-c_block[7][0] /= 100;
-c_block[7][1] /= 101;
-c_block[7][2] /= 105;
-c_block[7][3] /= 111;
-c_block[7][4] /= 119;
-c_block[7][5] /= 130;
-c_block[7][6] /= 142;
-c_block[7][7] /= 156;
+     /* copy back coefficients */
+     for (l=0; l<=7; l++)
+      for (k=0; k<=7; k++)
+          PIX(c,i+k,j+l) = block[8*l+k];
+     }
 
 return;
 
-} /* jpeg_divide_block */
+} /* blockwise_DCT_2d */
 
 /*--------------------------------------------------------------------------*/
 
-void round_block_coeff
+void blockwise_IDCT_2d
 
-     (double  **c_block)    /* coefficients of the DCT */
+     (image   *u,           /* out: image */
+      image   *c,           /* in: coefficients of the DCT */
+      long    nx,           /* pixel number in x-direction */
+      long    ny)           /* pixel number in y-direction */
 
 /*
-  round entries of a 8x8 coefficient block
+  computes inverse DCT in image blocks of size 8x8;
+  each block is transformed on the stack with the butterflies of idct8x8
 */
 
 {
-long i, j;        /* loop variables */
-
-for (i=0; i<=7; i++)
- for (j=0; j<=7; j++)
-     c_block[i][j] = rint (c_block[i][j]);
-
-return;
-}
-
-/*--------------------------------------------------------------------------*/
+long    i, j, k, l;     /* loop variables */
+double  block[64];      /* 8x8 block, row-major */
 
-void equal_divide_block
 
-     (double  **c_block,    /* coefficients of the DCT */
-      long    factor)       /* factor to divide */
+/* ---- inverse DCT on 8x8 blocks ---- */
 
-/*
-  divides an 8x8 coefficient block by a given factor
-*/
+for (j=0; j<ny; j+=8)
+ for (i=0; i<nx; i+=8)
+     {
+     /* copy 8x8 block */
+     for (l=0; l<=7; l++)
+      for (k=0; k<=7; k++)
+          block[8*l+k] = PIX(c,i+k,j+l);
 
-{
-long i, j;        /* loop variables */
+     /* inverse DCT of 8x8 block */
+     idct8x8 (block);
 
-for (i=0; i<=7; i++)
- for (j=0; j<=7; j++)
-     c_block[i][j] /= factor;
+     /* copy back pixels */
+     for (l=0; l<=7; l++)
+      for (k=0; k<=7; k++)
+          PIX(u,i+k,j+l) = block[8*l+k];
+     }
 
 return;
-}
+
+} /* blockwise_IDCT_2d */
 
 /*--------------------------------------------------------------------------*/
 
-void DCT_2d
+void blockwise_remove_freq_2d
 
-     (double  **u,          /* image, unchanged */
-      double  **c,          /* coefficients of the DCT */
+     (image   *c,           /* in and out: coefficients of the DCT */
       long    nx,           /* pixel number in x-direction */
       long    ny)           /* pixel number in y-direction */
 
 /*
-  computes DCT of input image
+  removes frequencies within 8x8 block;
+  same cut-off as remove_freq_2d on an 8x8 block, applied in place
 */
 
 {
-long    i, j, m, p;    /* loop variables */
-double  nx_1;          /* time saver */
-double  ny_1;          /* time saver */
-double  pi;            /* variable pi */
-double  **tmp;         /* temporary image */
-double  *cx, *cy;      /* arrays for coefficients */
-
-
-/* ---- compute pi ---- */
-
-pi = 2.0 * asin (1.0);
-
-
-/* ---- set time savers ---- */
+long    i, j, k, l;       /* loop variables */
 
-nx_1 = pi / (2.0 * nx);
-ny_1 = pi / (2.0 * ny);
 
+/* ---- set frequencies to zero blockwise ---- */
 
-/* ---- allocate memory ---- */
+for (j=0; j<ny; j+=8)
+ for (i=0; i<nx; i+=8)
+  for (l=0; l<=7; l++)
+   for (k=0; k<=7; k++)
+       if ((k >= 8 / sqrt (10.0)) || (l >= 8 / sqrt (10.0)))
+          PIX(c,i+k,j+l) = 0.0;
 
-alloc_double_matrix (&tmp, nx, ny);
-alloc_double_vector (&cx, nx);
-alloc_double_vector (&cy, ny);
+return;
 
+} /* blockwise_remove_freq_2d */
 
-/* ---- compute coefficients ---- */
+/*--------------------------------------------------------------------------*/
 
-cx[0] = sqrt (1.0 / nx);
-for (p=1; p<nx; p++)
-    cx[p] = sqrt (2.0 / nx);
+void quantisation_rows
 
-cy[0] = sqrt (1.0 / ny);
-for (p=1; p<ny; p++)
-    cy[p] = sqrt (2.0 / ny);
+     (long  first,       /* first row of blocks */
+      long  last,        /* last row of blocks */
+      void  *arg)        /* quantisation_task */
 
+/*
+  DCT, quantisation and inverse DCT of the 8x8 blocks in the block rows
+  first,...,last; each block stays on the stack from the forward
+  transform to the inverse one
+*/
 
-/* ---- DCT in y-direction ---- */
+{
+quantisation_task  *t = (quantisation_task *) arg;   /* task */
+long               i, j, k, l, b;                    /* loop variables */
+double             block[64];                        /* 8x8 block */
 
-for (i=0; i<nx; i++)
- for (p=0; p<ny; p++)
+for (b=first; b<=last; b++)
+ for (i=0; i<t->u->nx; i+=8)
      {
-      for(m=0; m<ny; m++)
-       tmp[i][p] += u[i][m] * cy[p] * cos(ny_1 * (2 * m + 1) * p);
-     }
+     j = 8 * b;
 
+     /* copy 8x8 block */
+     for (l=0; l<=7; l++)
+      for (k=0; k<=7; k++)
+          block[8*l+k] = PIX(t->u,i+k,j+l);
 
-/* ---- DCT in x-direction ---- */
+     /* DCT of 8x8 block */
+     dct8x8 (block);
 
-for (p=0; p<nx; p++)
- for (j=0; j<ny; j++)
-     {
-      for(m=0; m<nx; m++)
-       c[p][j] += tmp[m][j] * cx[p] * cos(nx_1 * (2 * m + 1) * p);
-     }
+     /* quantise: multiply by the reciprocal step, round, rescale */
+     quantise8x8 (&t->q, block);
 
+     /* quantised coefficients */
+     for (l=0; l<=7; l++)
+      for (k=0; k<=7; k++)
+          PIX(t->c,i+k,j+l) = block[8*l+k];
 
-/* ---- free memory ---- */
+     /* inverse DCT of 8x8 block */
+     idct8x8 (block);
 
-free_double_matrix (tmp, nx, ny);
-free_double_vector (cx, nx);
-free_double_vector (cy, ny);
+     /* copy back pixels */
+     for (l=0; l<=7; l++)
+      for (k=0; k<=7; k++)
+          PIX(t->u,i+k,j+l) = block[8*l+k];
+     }
 
 return;
 
-} /* DCT_2d */
+}  /* quantisation_rows */
 
 /*--------------------------------------------------------------------------*/
 
-void IDCT_2d
+void blockwise_quantisation_2d
 
-     (double  **u,          /* image, unchanged */
-      double  **c,          /* coefficients of the DCT */
-      long    nx,           /* pixel number in x-direction */
-      long    ny)           /* pixel number in y-direction */
+     (image              *u,   /* in: image, out: reconstruction */
+      image              *c,   /* out: quantised coefficients of the DCT */
+      const quant_table  *q)   /* quantisation table of an 8x8 block */
 
 /*
-  computes inverse DCT of input image
+  DCT, quantisation and inverse DCT of all 8x8 blocks in one sweep over
+  the image, in parallel over rows of blocks; coefficient (k,l) of a
+  block is quantised with the step q->step[8*l+k]
 */
 
 {
-long    i, j, m, p;    /* loop variables */
-double  nx_1;          /* time saver */
-double  ny_1;          /* time saver */
-double  pi;            /* variable pi */
-double  **tmp;         /* temporary image */
-double  *cx, *cy;      /* arrays for coefficients */
+quantisation_task  t;    /* task */
 
+t.u = u;
+t.c = c;
+t.q = *q;
 
-/* ---- compute pi ---- */
-
-pi = 2.0 * asin (1.0);
-
-
-/* ---- set time savers ---- */
-
-nx_1 = pi / (2.0 * nx);
-ny_1 = pi / (2.0 * ny);
-
-
-/* ---- allocate memory ---- */
+parallel_rows (0, u->ny / 8 - 1, quantisation_rows, &t);
 
-alloc_double_matrix (&tmp, nx, ny);
-alloc_double_vector (&cx, nx);
-alloc_double_vector (&cy, ny);
+return;
 
+} /* blockwise_quantisation_2d */
 
-/* ---- compute coefficients ---- */
+/*--------------------------------------------------------------------------*/
 
-cx[0] = sqrt (1.0 / nx);
-for (m=1; m<nx; m++)
-    cx[m] = sqrt (2.0 / nx);
+void blockwise_quantise_coeff_2d
 
-cy[0] = sqrt (1.0 / ny);
-for (m=1; m<ny; m++)
-    cy[m] = sqrt (2.0 / ny);
+     (image              *c,   /* in and out: coefficients of the DCT */
+      long               nx,   /* pixel number in x-direction */
+      long               ny,   /* pixel number in y-direction */
+      const quant_table  *q)   /* quantisation table of an 8x8 block */
 
+/*
+  quantises the coefficients of the 8x8 blocks of a blockwise DCT;
+  same steps as blockwise_quantisation_2d, without the transforms
+*/
 
-/* ---- DCT in y-direction ---- */
+{
+long    i, j, k, l;       /* loop variables */
+double  block[64];        /* 8x8 block, row-major */
 
-for (i=0; i<nx; i++)
- for (m=0; m<ny; m++)
+for (j=0; j<ny; j+=8)
+ for (i=0; i<nx; i+=8)
      {
-      for(p=0; p<ny; p++)
-       tmp[i][m] += cy[p] * c[i][p] * cos(ny_1 * (2 * m + 1) * p);
-     }
-
+     for (l=0; l<=7; l++)
+      for (k=0; k<=7; k++)
+          block[8*l+k] = PIX(c,i+k,j+l);
 
-/* ---- DCT in x-direction ---- */
+     quantise8x8 (q, block);
 
-for (m=0; m<nx; m++)
- for (j=0; j<ny; j++)
-     {
-      u[m][j] = 0;
-      for(p=0; p<nx; p++)
-       u[m][j] += cx[p] * tmp[p][j] * cos(nx_1 * (2 * m + 1) * p);
+     for (l=0; l<=7; l++)
+      for (k=0; k<=7; k++)
+          PIX(c,i+k,j+l) = block[8*l+k];
      }
 
-
-/* ---- free memory ---- */
-
-free_double_matrix (tmp, nx, ny);
-free_double_vector (cx, nx);
-free_double_vector (cy, ny);
-
 return;
 
-} /* IDCT_2d */
+} /* blockwise_quantise_coeff_2d */
 
 /*--------------------------------------------------------------------------*/
 
-void remove_freq_2d
+void log_spectrum_2d
 
-     (double  **c,          /* in and out: coefficients of the DCT */
+     (image   *c,           /* in: coefficients, out: spectrum image */
       long    nx,           /* pixel number in x-direction */
       long    ny)           /* pixel number in y-direction */
 
 /*
-  removes frequencies
+  logarithmic spectrum log (1 + |c|), normalised to the range 0..255;
+  c has indices 1,...,nx / 1,...,ny
 */
 
 {
-long i, j;        /* loop variables */
-
-/* set frequencies to zero */
-for (i=0; i<nx; i++)
- for (j=0; j<ny; j++)
-     if ((i >= nx / sqrt (10.0)) || (j >= ny / sqrt (10.0)))
-        c[i][j] = 0.0;
-
-return;
-}
-
-/*--------------------------------------------------------------------------*/
-
-void blockwise_DCT_2d
-
-     (double  **u,          /* in: image */
-      double  **c,          /* out: coefficients of the DCT */
-      long    nx,           /* pixel number in x-direction */
-      long    ny)           /* pixel number in y-direction */
+long    i, j;                 /* loop variables */
+double  max, min;             /* largest, smallest grey value */
+double  mean;                 /* average grey value */
+double  std;                  /* standard deviation */
 
-/*
-  computes DCT in image blocks of size 8x8
-*/
+/* ---- compute logarithmic spectrum of c ---- */
 
-{
-long    i, j, k, l;       /* loop variables */
-double  **u_block;        /* 8x8 block */
-double  **c_block;        /* 8x8 block */
+for (j=1; j<=ny; j++)
+ for (i=1; i<=nx; i++)
+     PIX(c,i,j) = log (1.0 + fabs (PIX(c,i,j)));
 
 
-/* ---- allocate memory for 8x8 blocks ---- */
+/* ---- normalise spectrum of c ---- */
 
-alloc_double_matrix (&u_block, 8, 8);
-alloc_double_matrix (&c_block, 8, 8);
+analyse_grey_double (c, &min, &max, &mean, &std);
 
+if (max != 0.0)
+   for (j=1; j<=ny; j++)
+    for (i=1; i<=nx; i++)
+        PIX(c,i,j) = PIX(c,i,j) * 255.0 / max;
 
-/* ---- DCT on 8x8 blocks ---- */
+return;
 
-for (i=0; i<nx; i+=8)
- for (j=0; j<ny; j+=8)
-     {
-     /* copy 8x8 block */
-     for (k=0; k<=7; k++)
-      for (l=0; l<=7; l++){
-        u_block[k][l] = u[i+k][j+l];
-        c_block[k][l] = 0;
-      }
+} /* log_spectrum_2d */
 
+/*--------------------------------------------------------------------------*/
 
-     /* DCT of 8x8 block */
-     DCT_2d (u_block, c_block, 8, 8);
+void load_quant_table
 
-     /* copy back coefficients */
-     for (k=0; k<=7; k++)
-      for (l=0; l<=7; l++)
-	        c[i+k][j+l] = c_block[k][l];
+     (char         *table,     /* "jpeg", "ijg" or a file name */
+      long         quality,    /* quality factor, 1,...,100 */
+      quant_table  *q)         /* quantisation table, output */
 
-     }
+/*
+  scaled quantisation table: JPEG weights, the example table of the
+  JPEG standard, or a table from a file
+*/
 
-/* ---- free memory for 8x8 block ---- */
+{
+long    i;              /* loop variable */
+double  base[64];       /* base quantisation table */
+
+if (strcmp (table, "jpeg") == 0)
+   for (i=0; i<64; i++)
+       base[i] = jpeg_weight[i];
+else if (strcmp (table, "ijg") == 0)
+   for (i=0; i<64; i++)
+       base[i] = jpeg_luminance[i];
+else
+   read_quant_table (table, base);
 
-free_double_matrix (u_block, 8, 8);
-free_double_matrix (c_block, 8, 8);
+quant_table_init (q, base, quality);
 
 return;
 
-} /* blockwise_DCT_2d */
+} /* load_quant_table */
 
 /*--------------------------------------------------------------------------*/
 
-void blockwise_IDCT_2d
-
-     (double  **u,          /* out: image */
-      double  **c,          /* in: coefficients of the DCT */
-      long    nx,           /* pixel number in x-direction */
-      long    ny)           /* pixel number in y-direction */
+double seconds (void)
 
 /*
-  computes inverse DCT in image blocks of size 8x8
+  returns a monotonic time stamp in seconds
 */
 
 {
-long    i, j, k, l;     /* loop variables */
-double  **u_block;      /* 8x8 block */
-double  **c_block;      /* 8x8 block */
+struct timespec  t;   /* time stamp */
 
+clock_gettime (CLOCK_MONOTONIC, &t);
+return (t.tv_sec + 1.0e-9 * t.tv_nsec);
 
-/* ---- allocate memory for 8x8 blocks ---- */
-
-alloc_double_matrix (&u_block, 8, 8);
-alloc_double_matrix (&c_block, 8, 8);
-
-
-/* ---- inverse DCT on 8x8 blocks ---- */
+}  /* seconds */
 
-for (i=0; i<nx; i+=8)
- for (j=0; j<ny; j+=8)
-     {
-     /* copy 8x8 block */
-     for (k=0; k<=7; k++)
-      for (l=0; l<=7; l++){
-        c_block[k][l] = c[i+k][j+l];
-        u_block[k][l] = 0;
-      }
+/*--------------------------------------------------------------------------*/
 
+double grey_byte
 
-     /* inverse DCT of 8x8 block */
-     IDCT_2d (u_block, c_block, 8, 8);
+     (double  v)            /* grey value */
 
-     /* copy back coefficients */
-     for (k=0; k<=7; k++)
-      for (l=0; l<=7; l++)
-	        u[i+k][j+l] = u_block[k][l];
-     }
-
-
-/* ---- free memory for 8x8 block ---- */
+/*
+  grey value as written to a pgm file: rounded and clipped to 0..255
+*/
 
-free_double_matrix (u_block, 8, 8);
-free_double_matrix (c_block, 8, 8);
+{
+v = v + 0.499999;
+if (v < 0.0)
+   return (0.0);
+if (v > 255.0)
+   return (255.0);
 
-return;
+return (floor (v));
 
-} /* blockwise_IDCT_2d */
+}  /* grey_byte */
 
 /*--------------------------------------------------------------------------*/
 
-void blockwise_remove_freq_2d
+double psnr_2d
 
-     (double  **c,          /* in and out: coefficients of the DCT */
+     (image   *f,           /* original image, indices from 0 */
+      image   *u,           /* processed image, indices from 0 */
       long    nx,           /* pixel number in x-direction */
       long    ny)           /* pixel number in y-direction */
 
 /*
-  removes frequencies within 8x8 block
+  peak signal to noise ratio in dB of the 8-bit output image u
 */
 
 {
-long    i, j, k, l;       /* loop variables */
-double  **c_block;        /* 8x8 block */
-
-
-/* ---- allocate memory for 8x8 block ---- */
-
-alloc_double_matrix (&c_block, 8, 8);
-
-
-/* ---- scale coefficients blockwise ---- */
+long    i, j;      /* loop variables */
+double  d;         /* difference */
+double  mse;       /* mean squared error */
 
-for (i=0; i<nx; i+=8)
- for (j=0; j<ny; j+=8)
+mse = 0.0;
+for (j=0; j<ny; j++)
+ for (i=0; i<nx; i++)
      {
-     /* copy 8x8 block */
-     for (k=0; k<=7; k++)
-      for (l=0; l<=7; l++)
-          c_block[k][l] = c[i+k][j+l];
-
-     /* set frequencies to zero */
-     remove_freq_2d (c_block, 8, 8);
-
-     /* copy back coefficients */
-     for (k=0; k<=7; k++)
-      for (l=0; l<=7; l++)
-          c[i+k][j+l] = c_block[k][l];
+     d   = grey_byte (PIX(u,i,j)) - PIX(f,i,j);
+     mse = mse + d * d;
      }
+mse = mse / (nx * ny);
 
+if (mse == 0.0)
+   return (INFINITY);
 
-/* ---- free memory for 8x8 block ---- */
+return (10.0 * log10 (255.0 * 255.0 / mse));
 
-free_double_matrix (c_block, 8, 8);
-
-return;
-
-} /* blockwise_remove_freq_2d */
+}  /* psnr_2d */
 
 /*--------------------------------------------------------------------------*/
 
-void blockwise_quantisation_jpeg_2d
+double ssim_2d
 
-     (double  **c,          /* in and out: coefficients of the DCT */
+     (image   *f,           /* original image, indices from 0 */
+      image   *u,           /* processed image, indices from 0 */
       long    nx,           /* pixel number in x-direction */
       long    ny)           /* pixel number in y-direction */
 
 /*
-  quantises coefficients of 8x8 block
+  mean structural similarity index (Wang et al. 2004) of the 8-bit output
+  image u: local means, variances and covariance with a Gaussian window
+  of standard deviation 1.5 (reflecting boundary), K1 = 0.01, K2 = 0.03
 */
 
 {
-long    i, j, k, l;       /* loop variables */
-double  **c_block;        /* 8x8 block */
+image   *mf, *mu;             /* local means */
+image   *ff, *uu, *fu;        /* local second moments */
+long    i, j;                 /* loop variables */
+double  a, b;                 /* grey values */
+double  vf, vu, cv;           /* local variances and covariance */
+double  c1, c2;               /* stabilising constants */
+double  sum;                  /* sum of the SSIM map */
 
+alloc_image (&mf, 1, nx, ny, 1);
+alloc_image (&mu, 1, nx, ny, 1);
+alloc_image (&ff, 1, nx, ny, 1);
+alloc_image (&uu, 1, nx, ny, 1);
+alloc_image (&fu, 1, nx, ny, 1);
 
-/* ---- allocate memory for 8x8 block ---- */
+for (j=0; j<ny; j++)
+ for (i=0; i<nx; i++)
+     {
+     a = PIX(f,i,j);
+     b = grey_byte (PIX(u,i,j));
+     PIX(mf,i+1,j+1) = a;
+     PIX(mu,i+1,j+1) = b;
+     PIX(ff,i+1,j+1) = a * a;
+     PIX(uu,i+1,j+1) = b * b;
+     PIX(fu,i+1,j+1) = a * b;
+     }
 
-alloc_double_matrix (&c_block, 8, 8);
+gauss_conv (1.5, 0, 3.0, nx, ny, 1.0, 1.0, mf);
+gauss_conv (1.5, 0, 3.0, nx, ny, 1.0, 1.0, mu);
+gauss_conv (1.5, 0, 3.0, nx, ny, 1.0, 1.0, ff);
+gauss_conv (1.5, 0, 3.0, nx, ny, 1.0, 1.0, uu);
+gauss_conv (1.5, 0, 3.0, nx, ny, 1.0, 1.0, fu);
 
+c1  = (0.01 * 255.0) * (0.01 * 255.0);
+c2  = (0.03 * 255.0) * (0.03 * 255.0);
+sum = 0.0;
+for (j=1; j<=ny; j++)
+ for (i=1; i<=nx; i++)
+     {
+     a   = PIX(mf,i,j);
+     b   = PIX(mu,i,j);
+     vf  = PIX(ff,i,j) - a * a;
+     vu  = PIX(uu,i,j) - b * b;
+     cv  = PIX(fu,i,j) - a * b;
+     sum = sum + ((2.0 * a * b + c1) * (2.0 * cv + c2))
+                 / ((a * a + b * b + c1) * (vf + vu + c2));
+     }
 
-/* ---- scale coefficients blockwise ---- */
+free_image (mf);
+free_image (mu);
+free_image (ff);
+free_image (uu);
+free_image (fu);
 
-for (i=0; i<nx; i+=8)
- for (j=0; j<ny; j+=8)
-     {
-     /* copy 8x8 block */
-     for (k=0; k<=7; k++)
-      for (l=0; l<=7; l++)
-          c_block[k][l] = c[i+k][j+l];
+return (sum / (nx * ny));
 
-     /* scale coefficients of 8x8 block */
-     jpeg_divide_block (c_block);
+}  /* ssim_2d */
 
-     /* round coefficients */
-     round_block_coeff (c_block);
+/*--------------------------------------------------------------------------*/
 
-     /* rescale coefficients of 8x8 block */
-     jpeg_multiply_block (c_block);
+void write_shifted
 
-     /* copy back coefficients */
-     for (k=0; k<=7; k++)
-      for (l=0; l<=7; l++)
-          c[i+k][j+l] = c_block[k][l];
-     }
+     (image   *v,           /* image or coefficients, indices from 0 */
+      long    nx,           /* pixel number in x-direction */
+      long    ny,           /* pixel number in y-direction */
+      long    spectrum,     /* 1: write the logarithmic spectrum of v */
+      char    *file_name,   /* pgm file */
+      char    *comments)    /* comment string */
 
+/*
+  writes v with the original indices 1,...,nx / 1,...,ny
+*/
 
-/* ---- free memory for 8x8 block ---- */
+{
+image   *w;       /* shifted copy */
+long    i, j;     /* loop variables */
 
-free_double_matrix (c_block, 8, 8);
+alloc_image (&w, 1, nx, ny, 1);
+for (j=0; j<ny; j++)
+ for (i=0; i<nx; i++)
+     PIX(w,i+1,j+1) = PIX(v,i,j);
+if (spectrum)
+   log_spectrum_2d (w, nx, ny);
+write_double_to_pgm (w, file_name, comments);
+free_image (w);
 
 return;
 
-} /* blockwise_quantisation_jpeg_2d */
+}  /* write_shifted */
 
 /*--------------------------------------------------------------------------*/
 
-void blockwise_quantisation_equal_2d
+void sweep
 
-     (double **c,          /* in and out: coefficients of the DCT */
-      long   nx,           /* pixel number in x-direction */
-      long   ny)           /* pixel number in y-direction */
+     (image   *f,           /* input image, indices from 0, unchanged */
+      long    nx,           /* pixel number in x-direction */
+      long    ny,           /* pixel number in y-direction */
+      char    *out1,        /* prefix of the spectrum images */
+      char    *out2,        /* prefix of the output images */
+      char    *csv,         /* CSV file */
+      char    *table,       /* quantisation table of the grid */
+      char    *grid)        /* quality factors 1,...,100, comma separated */
 
 /*
- quantises coefficients of 8x8 block
+  runs the processing modes 1-6 and mode 7 with the given table for each
+  quality factor of the grid on one image; the DCT of the whole image
+  and the blockwise DCT are computed once and shared by all modes.
+  Writes the spectrum and output image of each run (prefix + mode, or
+  prefix + q + quality factor) and one CSV line per run with the time
+  of the shared forward transform, the time of the mode itself (removal
+  or quantisation and inverse DCT), the number of nonzero coefficients,
+  PSNR and SSIM
 */
 
 {
-long    i, j, k, l;        /* loop variables */
-double  **c_block;         /* 8x8 block */
+image        *cw, *cb;          /* DCT of the whole image, blockwise DCT */
+image        *c;                /* coefficients of the current run */
+image        *u;                /* output image of the current run */
+quant_table  q;                 /* quantisation table */
+FILE         *out;              /* CSV file */
+char         name[128];         /* file name */
+char         comments[1600];    /* string for comments */
+char         *p;                /* position in grid */
+char         *tname;            /* name of the quantisation table */
+char         qtext[24];         /* quality factor or empty */
+long         mode;              /* processing mode */
+long         quality;           /* quality factor */
+long         i, j;              /* loop variables */
+long         nonzero;           /* number of nonzero coefficients */
+double       t0;                /* time stamp */
+double       tw, tb;            /* times of the forward transforms */
+double       tf, tm;            /* forward time and time of the run */
+double       psnr, ssim;        /* quality measures */
+double       base[64];          /* base quantisation table */
+
+out = fopen (csv, "w");
+if (out == NULL)
+   {
+   printf ("sweep: cannot open file '%s'\n", csv);
+   exit(1);
+   }
+fprintf (out, "mode,table,quality,forward_ms,mode_ms,nonzero,"
+              "nonzero_percent,psnr_db,ssim\n");
 
+alloc_image (&cw, 1, nx, ny, 0);
+alloc_image (&cb, 1, nx, ny, 0);
+alloc_image (&c, 1, nx, ny, 0);
+alloc_image (&u, 1, nx, ny, 0);
 
-/* ---- allocate memory for 8x8 block ---- */
 
-alloc_double_matrix (&c_block, 8, 8);
+/* ---- shared forward transforms ---- */
 
+t0 = seconds ();
+DCT_2d (f, cw);
+tw = seconds () - t0;
 
-/* ---- scale coefficients blockwise ---- */
+t0 = seconds ();
+blockwise_DCT_2d (f, cb, nx, ny);
+tb = seconds () - t0;
 
-for (i=0; i<nx; i+=8)
- for (j=0; j<ny; j+=8)
-     {
-     /* copy 8x8 block */
-     for (k=0; k<=7; k++)
-      for (l=0; l<=7; l++)
-          c_block[k][l] = c[i+k][j+l];
 
-     /* scale coefficients of 8x8 block */
-     equal_divide_block (c_block, 40);
+/* ---- one run per mode and quality factor ---- */
 
-     /* round coefficients */
-     round_block_coeff (c_block);
+printf ("mode  table  quality  forward [ms]  mode [ms]  nonzero  "
+        "PSNR [dB]    SSIM\n");
 
-     /* rescale coefficients of 8x8 block */
-     equal_multiply_block (c_block, 40);
+mode    = 1;
+quality = 50;
+p       = grid;
+while (mode <= 7)
+   {
+   if (mode == 7)
+      {
+      /* next quality factor of the grid */
+      while ((*p == ',') || (*p == ' '))
+         p++;
+      if (*p == '\0')
+         break;
+      quality = strtol (p, &p, 10);
+      if (((*p != ',') && (*p != ' ') && (*p != '\0'))
+          || (quality < 1) || (quality > 100))
+         {
+         printf ("sweep: invalid quality factors '%s'\n", grid);
+         exit(1);
+         }
+      load_quant_table (table, quality, &q);
+      }
 
-     /* copy back coefficients */
-     for (k=0; k<=7; k++)
-      for (l=0; l<=7; l++)
-          c[i+k][j+l] = c_block[k][l];
+   /* coefficients of the shared forward transform */
+   copy_image (((mode == 1) || (mode == 3)) ? cw : cb, c);
+   tf = ((mode == 1) || (mode == 3)) ? tw : tb;
+
+   t0 = seconds ();
+   switch (mode)
+     {
+     case 1 :
+       IDCT_2d (u, c);
+       break;
+     case 2 :
+       blockwise_IDCT_2d (u, c, nx, ny);
+       break;
+     case 3 :
+       remove_freq_2d (c, nx, ny);
+       IDCT_2d (u, c);
+       break;
+     case 4 :
+       blockwise_remove_freq_2d (c, nx, ny);
+       blockwise_IDCT_2d (u, c, nx, ny);
+       break;
+     case 5 :
+       for (i=0; i<64; i++)
+           base[i] = 40.0;
+       quant_table_init (&q, base, 50);
+       blockwise_quantise_coeff_2d (c, nx, ny, &q);
+       blockwise_IDCT_2d (u, c, nx, ny);
+       break;
+     case 6 :
+       quant_table_init (&q, jpeg_weight, 50);
+       blockwise_quantise_coeff_2d (c, nx, ny, &q);
+       blockwise_IDCT_2d (u, c, nx, ny);
+       break;
+     case 7 :
+       blockwise_quantise_coeff_2d (c, nx, ny, &q);
+       blockwise_IDCT_2d (u, c, nx, ny);
+       break;
      }
+   tm = seconds () - t0;
+
+   nonzero = 0;
+   for (j=0; j<ny; j++)
+    for (i=0; i<nx; i++)
+        if (PIX(c,i,j) != 0.0)
+           nonzero++;
+   psnr = psnr_2d (f, u, nx, ny);
+   ssim = ssim_2d (f, u, nx, ny);
+
+   /* quantisation of modes 5-7 */
+   tname    = (mode == 5) ? "equal" : ((mode == 6) ? "jpeg" : table);
+   qtext[0] = '\0';
+   if (mode >= 5)
+      snprintf (qtext, sizeof qtext, "%ld", (mode == 7) ? quality : 50);
+
+   printf ("%4ld  %5.5s  %7s  %12.2f  %9.2f  %7ld  %9.2f  %6.4f\n",
+           mode, (mode >= 5) ? tname : "-", (mode >= 5) ? qtext : "-",
+           1000.0 * tf, 1000.0 * tm, nonzero, psnr, ssim);
+   fprintf (out, "%ld,%s,%s,%.3f,%.3f,%ld,%.3f,%.4f,%.6f\n",
+            mode, (mode >= 5) ? tname : "", qtext, 1000.0 * tf,
+            1000.0 * tm, nonzero, 100.0 * nonzero / (nx * ny), psnr, ssim);
+
+   /* spectrum and output image */
+   comments[0]='\0';
+   comment_line (comments, "# Discrete Cosine Transform (sweep)\n");
+   comment_line (comments, "# menu option: %8ld\n", mode);
+   if (mode == 7)
+      {
+      comment_line (comments, "# quantisation table: %.50s\n", table);
+      comment_line (comments, "# quality factor: %8ld\n", quality);
+      snprintf (name, sizeof name, "%.80sq%ld.pgm", out1, quality);
+      }
+   else
+      snprintf (name, sizeof name, "%.80s%ld.pgm", out1, mode);
+   write_shifted (c, nx, ny, 1, name, comments);
+   if (mode == 7)
+      snprintf (name, sizeof name, "%.80sq%ld.pgm", out2, quality);
+   else
+      snprintf (name, sizeof name, "%.80s%ld.pgm", out2, mode);
+   write_shifted (u, nx, ny, 0, name, comments);
 
+   if (mode < 7)
+      mode++;
+   }
 
-/* ---- free memory for 8x8 block ---- */
+fclose (out);
+printf ("\nCSV file %s successfully written\n\n", csv);
 
-free_double_matrix (c_block, 8, 8);
+free_image (cw);
+free_image (cb);
+free_image (c);
+free_image (u);
 
 return;
 
-} /* blockwise_quantisation_equal_2d */
+}  /* sweep */
 
 /*--------------------------------------------------------------------------*/
 
-int main ()
-
-{
-char    in[80];               /* for reading data */
-char    out1[80];             /* for reading data */
-char    out2[80];             /* for reading data */
-double  **f;                  /* image */
-double  **u;                  /* shifted image */
-double  **c;                  /* DCT coefficients */
-double  **c0;                 /* shifted DCT coefficients */
-long    nx, ny;               /* image size in x, y direction */
-long    i, j;                 /* loop variables */
-long    flag;                 /* processing flag */
-double  max, min;             /* largest, smallest grey value */
-double  mean;                 /* average grey value */
-double  std;                  /* standard deviation */
-char    comments[1600];       /* string for comments */
+void run_job ()
 
-printf ("\n");
-printf ("DISCRETE COSINE TRANSFORM\n\n");
-printf ("**************************************************\n\n");
-printf ("    Copyright 2021 by Joachim Weickert            \n");
-printf ("    and 2007 by Andres Bruhn                      \n");
-printf ("    Dept. of Mathematics and Computer Science     \n");
-printf ("    Saarland University, Saarbruecken, Germany    \n\n");
-printf ("    All rights reserved. Unauthorized usage,      \n");
-printf ("    copying, hiring, and selling prohibited.      \n\n");
-printf ("    Send bug reports to                           \n");
-printf ("    weickert@mia.uni-saarland.de                  \n\n");
-printf ("**************************************************\n\n");
+/*
+  reads the parameters of one job and processes it
+*/
 
+{
+char         in[80];               /* for reading data */
+char         out1[80];             /* for reading data */
+char         out2[80];             /* for reading data */
+char         jpg[80];              /* JPEG file */
+char         csv[80];              /* CSV file of the sweep */
+char         grid[80];             /* quality factors of the sweep */
+image        *f;                   /* image */
+image        *u;                   /* shifted image */
+image        *c;                   /* DCT coefficients */
+image        *c0;                  /* shifted DCT coefficients */
+image        *g;                   /* decoded JPEG file */
+long         nx, ny;               /* image size in x, y direction */
+long         i, j;                 /* loop variables */
+long         flag;                 /* processing flag */
+long         quality;              /* quality factor of the quantisation */
+long         bytes;                /* size of the JPEG file */
+char         table[80];            /* quantisation table file */
+double       base[64];             /* base quantisation table */
+quant_table  q;                    /* quantisation table of an 8x8 block */
+double       max, min;             /* largest, smallest grey value */
+double       mean;                 /* average grey value */
+double       std;                  /* standard deviation */
+double       mse;                  /* mean squared error of the JPEG file */
+char         comments[1600];       /* string for comments */
 
 /* ---- read input image (pgm format P5) ---- */
 
 printf ("input image (pgm):                ");
 read_string (in);
-read_pgm_to_double (in, &nx, &ny, &f);  /* also allocates memory for f */
-
-/* check if image can be devided in blocks of size 8x8 */
-if ((nx % 8 != 0) || (ny % 8 != 0))
-   {
-   printf ("\n\n Image size does not allow decomposition! \n\n");
-   return(0);
-   }
+read_pgm_to_double (in, 1, &f);  /* also allocates memory for f */
+nx = f->nx;
+ny = f->ny;
 
 
 /* ---- read parameters ---- */
@@ -1199,23 +925,69 @@ printf ("\n        with removal of frequencies   ");
 printf ("\n    (5) DCT/IDCT of 8x8 blocks        ");
 printf ("\n        with equal quantisation       ");
 printf ("\n    (6) DCT/IDCT of 8x8 blocks        ");
-printf ("\n        with JPEG quantisation        \n");
-printf ("\nchose the processing mode (1-6):      ");
+printf ("\n        with JPEG quantisation        ");
+printf ("\n    (7) DCT/IDCT of 8x8 blocks        ");
+printf ("\n        with a quantisation table     ");
+printf ("\n        and a quality factor          ");
+printf ("\n    (8) baseline JPEG file with a     ");
+printf ("\n        quantisation table and a      ");
+printf ("\n        quality factor                ");
+printf ("\n    (9) sweep: modes 1-6 and mode 7   ");
+printf ("\n        for a grid of quality factors ");
+printf ("\n        with one forward transform,   ");
+printf ("\n        image names are prefixes      \n");
+printf ("\nchose the processing mode (1-9):      ");
 
 read_long (&flag);
 printf("\n\n");
 
+if (flag == 9)
+   {
+   printf ("CSV file:                         ");
+   read_string (csv);
+   }
+
+if ((flag >= 7) && (flag <= 9))
+   {
+   printf ("quantisation table (file, jpeg, ijg): ");
+   read_string (table);
+   if (flag == 9)
+      {
+      printf ("quality factors 1-100 (e.g. 10,50,90): ");
+      read_string (grid);
+      }
+   else
+      {
+      printf ("quality factor (1-100, 50: as is): ");
+      read_long (&quality);
+      }
+   if (flag == 8)
+      {
+      printf ("JPEG file (jpg):                  ");
+      read_string (jpg);
+      }
+   printf("\n\n");
+   }
+
+/* check if image can be devided in blocks of size 8x8 */
+if ((nx % 8 != 0) || (ny % 8 != 0))
+   {
+   printf ("\n\n Image size does not allow decomposition! \n\n");
+   free_image (f);
+   return;
+   }
+
 
 /* ---- allocate memory ---- */
 
-alloc_double_matrix (&c, nx+2, ny+2);
-alloc_double_matrix (&c0, nx, ny);
-alloc_double_matrix (&u, nx, ny);
+alloc_image (&c, 1, nx, ny, 1);
+alloc_image (&c0, 1, nx, ny, 0);
+alloc_image (&u, 1, nx, ny, 0);
 
 
 /* ---- analyse input image ---- */
 
-analyse_grey_double (f, nx, ny, &min, &max, &mean, &std);
+analyse_grey_double (f, &min, &max, &mean, &std);
 printf ("input image:\n");
 printf ("minimum:       %8.2lf \n", min);
 printf ("maximum:       %8.2lf \n", max);
@@ -1227,7 +999,20 @@ printf ("standard dev.: %8.2lf \n\n", std);
 
 for (j=0; j<ny; j++)
  for (i=0; i<nx; i++)
-     u[i][j] = f[i+1][j+1];
+     PIX(u,i,j) = PIX(f,i+1,j+1);
+
+
+/* ---- sweep over all modes ---- */
+
+if (flag == 9)
+   {
+   sweep (u, nx, ny, out1, out2, csv, table, grid);
+   free_image (f);
+   free_image (c);
+   free_image (c0);
+   free_image (u);
+   return;
+   }
 
 
 /* ---- process image ---- */
@@ -1236,8 +1021,8 @@ switch(flag)
   {
   case 1 :
     /* perform DCT and IDCT for the whole image */
-    DCT_2d (u, c0, nx, ny);
-    IDCT_2d (u, c0, nx, ny);
+    DCT_2d (u, c0);
+    IDCT_2d (u, c0);
     break;
   case 2 :
     /* perform DCT and IDCT in 8x8 blocks */
@@ -1247,9 +1032,9 @@ switch(flag)
   case 3 :
     /* perform DCT and IDCT for the whole image */
     /* remove frequencies */
-    DCT_2d (u, c0, nx, ny);
+    DCT_2d (u, c0);
     remove_freq_2d (c0, nx, ny);
-    IDCT_2d (u, c0, nx, ny);
+    IDCT_2d (u, c0);
     break;
   case 4 :
     /* perform DCT and IDCT in 8x8 blocks */
@@ -1261,20 +1046,60 @@ switch(flag)
   case 5 :
     /* perform DCT and IDCT in 8x8 blocks */
     /* and use equal quantisation */
-    blockwise_DCT_2d (u, c0, nx, ny);
-    blockwise_quantisation_equal_2d (c0, nx, ny);
-    blockwise_IDCT_2d (u, c0, nx, ny);
+    for (i=0; i<64; i++)
+        base[i] = 40.0;
+    quant_table_init (&q, base, 50);
+    blockwise_quantisation_2d (u, c0, &q);
     break;
   case 6 :
     /* perform DCT and IDCT in 8x8 blocks */
     /* and use JPEG quantisation */
+    quant_table_init (&q, jpeg_weight, 50);
+    blockwise_quantisation_2d (u, c0, &q);
+    break;
+  case 7 :
+  case 8 :
+    /* scaled quantisation table */
+    load_quant_table (table, quality, &q);
+
+    if (flag == 7)
+       {
+       /* perform DCT and IDCT in 8x8 blocks */
+       /* and quantise with the table */
+       blockwise_quantisation_2d (u, c0, &q);
+       break;
+       }
+
+    /* write a baseline JPEG file and decode it */
+    bytes = jpeg_encode (f, &q, jpg);
+    jpeg_decode (jpg, 0, &g);
+    mse = 0.0;
+    for (j=0; j<ny; j++)
+     for (i=0; i<nx; i++)
+         {
+         mse = mse + (PIX(g,i,j) - PIX(u,i,j)) * (PIX(g,i,j) - PIX(u,i,j));
+         PIX(u,i,j) = PIX(g,i,j);
+         }
+    mse = mse / (nx * ny);
+    free_image (g);
+    printf ("JPEG file:     %8ld bytes\n", bytes);
+    printf ("bits / pixel:  %8.3lf \n", 8.0 * bytes / (nx * ny));
+    if (mse > 0.0)
+       printf ("PSNR:          %8.2lf dB\n\n",
+               10.0 * log10 (255.0 * 255.0 / mse));
+    else
+       printf ("PSNR:          infinite\n\n");
+
+    /* spectrum of the decoded blocks */
     blockwise_DCT_2d (u, c0, nx, ny);
-    blockwise_quantisation_jpeg_2d (c0, nx, ny);
-    blockwise_IDCT_2d (u, c0, nx, ny);
     break;
   default :
     printf ("option (%ld) not available! \n\n\n",flag);
-    return(0);
+    free_image (f);
+    free_image (c);
+    free_image (c0);
+    free_image (u);
+    return;
   }
 
 
@@ -1283,31 +1108,19 @@ switch(flag)
 for (j=0; j<ny; j++)
  for (i=0; i<nx; i++)
      {
-     c[i+1][j+1] = c0[i][j];
-     f[i+1][j+1] = u[i][j];
+     PIX(c,i+1,j+1) = PIX(c0,i,j);
+     PIX(f,i+1,j+1) = PIX(u,i,j);
      }
 
 
-/* ---- compute logarithmic spectrum of c ---- */
-
-for (j=1; j<=ny; j++)
- for (i=1; i<=nx; i++)
-     c[i][j] = log (1.0 + fabs (c[i][j]));
-
+/* ---- compute normalised logarithmic spectrum of c ---- */
 
-/* ---- normalise spectrum of c ---- */
-
-analyse_grey_double (c, nx, ny, &min, &max, &mean, &std);
-
-if (max != 0.0)
-   for (j=1; j<=ny; j++)
-    for (i=1; i<=nx; i++)
-        c[i][j] = c[i][j] * 255.0 / max;
+log_spectrum_2d (c, nx, ny);
 
 
 /* ---- analyse filtered image ---- */
 
-analyse_grey_double (f, nx, ny, &min, &max, &mean, &std);
+analyse_grey_double (f, &min, &max, &mean, &std);
 printf ("filtered image:\n");
 printf ("minimum:       %8.2lf \n", min);
 printf ("maximum:       %8.2lf \n", max);
@@ -1321,9 +1134,14 @@ printf ("standard dev.: %8.2lf \n\n", std);
 comments[0]='\0';
 comment_line (comments, "# Discrete Cosine Transform (spectrum)\n");
 comment_line (comments, "# menu option: %8ld\n", flag);
+if ((flag == 7) || (flag == 8))
+   {
+   comment_line (comments, "# quantisation table: %.50s\n", table);
+   comment_line (comments, "# quality factor: %8ld\n", quality);
+   }
 
 /* write image */
-write_double_to_pgm (c, nx, ny, out1, comments);
+write_double_to_pgm (c, out1, comments);
 printf ("output image %s successfully written\n", out1);
 
 
@@ -1333,18 +1151,54 @@ printf ("output image %s successfully written\n", out1);
 comments[0]='\0';
 comment_line (comments, "# Discrete Cosine Transform (image)\n");
 comment_line (comments, "# menu option: %8ld\n", flag);
+if ((flag == 7) || (flag == 8))
+   {
+   comment_line (comments, "# quantisation table: %.50s\n", table);
+   comment_line (comments, "# quality factor: %8ld\n", quality);
+   }
 
 /* write image */
-write_double_to_pgm (f, nx, ny, out2, comments);
+write_double_to_pgm (f, out2, comments);
 printf ("output image %s successfully written\n\n", out2);
 
 
 /* ---- free memory  ---- */
 
-free_double_matrix (f, nx+2, ny+2);
-free_double_matrix (c, nx+2, ny+2);
-free_double_matrix (c0, nx, ny);
-free_double_matrix (u, nx, ny);
+free_image (f);
+free_image (c);
+free_image (c0);
+free_image (u);
+
+return;
+
+}  /* run_job */
+
+/*--------------------------------------------------------------------------*/
+
+int main
+
+     (int   argc,        /* number of command line arguments */
+      char  **argv)      /* command line arguments */
+
+{
+printf ("\n");
+printf ("DISCRETE COSINE TRANSFORM\n\n");
+printf ("**************************************************\n\n");
+printf ("    Copyright 2021 by Joachim Weickert            \n");
+printf ("    and 2007 by Andres Bruhn                      \n");
+printf ("    Dept. of Mathematics and Computer Science     \n");
+printf ("    Saarland University, Saarbruecken, Germany    \n\n");
+printf ("    All rights reserved. Unauthorized usage,      \n");
+printf ("    copying, hiring, and selling prohibited.      \n\n");
+printf ("    Send bug reports to                           \n");
+printf ("    weickert@mia.uni-saarland.de                  \n\n");
+printf ("**************************************************\n\n");
+
+/* ---- one run per job (interactive mode: exactly one) ---- */
+
+read_options (argc, argv);
+while (next_job ())
+   run_job ();
 
 return(0);
 
@@ -1,12 +1,7 @@
 input="boats.pgm"
-tests=("whole" "8X8" "whole_high_frequency_removed" "8X8_high_frequency_removed" "8X8_equal_quatified" "8X8_jpeg_quantified")
-for ((a=0;a<6;a++))
-do
-    echo $input > tes.txt
-    echo ./results/${tests[${a}]}_spectrum.pgm >> tes.txt
-    echo ./results/${tests[${a}]}_backtransfered.pgm >> tes.txt
-    b=$[a+1]
-    echo $b >> tes.txt
-    ./dct < tes.txt >> 1.log.txt
-done
-rm tes.txt
\ No newline at end of file
+# one sweep over the loaded image: modes 1-6, and mode 7 (JPEG weights) for
+# a grid of quality factors; the forward transforms are computed once.
+# Writes results/spectrum<m>.pgm and results/backtransfered<m>.pgm for mode m,
+# results/spectrumq<q>.pgm and results/backtransferedq<q>.pgm for quality q,
+# and PSNR, SSIM, timings and nonzero coefficients to results/sweep.csv
+./dct $input ./results/spectrum ./results/backtransfered 9 ./results/sweep.csv jpeg 10,25,50,75,90 >> 1.log.txt
@@ -5,6 +5,10 @@
 #include <stdarg.h>
 #include <ctype.h>
 
+#include "image.h"
+#include "cli.h"
+#include "parallel.h"
+
 /*--------------------------------------------------------------------------*/
 /*                                                                          */
 /*                          POINT TRANSFORMATIONS                           */
@@ -46,43 +50,6 @@ return;
 
 /*--------------------------------------------------------------------------*/
 
-void alloc_double_matrix
-
-     (double ***matrix,  /* matrix */
-      long   n1,         /* size in direction 1 */
-      long   n2)         /* size in direction 2 */
-
-/*
-  allocates memory for a double format matrix of size n1 * n2 
-*/
-
-{
-long i;    /* loop variable */
-
-*matrix = (double **) malloc (n1 * sizeof(double *));
-
-if (*matrix == NULL)
-   {
-   printf("alloc_double_matrix: not enough memory available\n");
-   exit(1);
-   }
-
-for (i=0; i<n1; i++)
-    {
-    (*matrix)[i] = (double *) malloc (n2 * sizeof(double));
-    if ((*matrix)[i] == NULL)
-       {
-       printf("alloc_double_matrix: not enough memory available\n");
-       exit(1);
-       }
-    }
-
-return;
-
-}  /* alloc_double_matrix */
-
-/*--------------------------------------------------------------------------*/
-
 void free_double_vector
 
      (double  *vector,    /* vector */
@@ -101,221 +68,6 @@ return;
 
 /*--------------------------------------------------------------------------*/
 
-void free_double_matrix
-
-     (double  **matrix,   /* matrix */
-      long    n1,         /* size in direction 1 */
-      long    n2)         /* size in direction 2 */
-
-/*
-  frees memory for a double format matrix of size n1 * n2
-*/
-
-{
-long i;   /* loop variable */
-
-for (i=0; i<n1; i++)
-free(matrix[i]);
-
-free(matrix);
-
-return;
-
-}  /* free_double_matrix */
-
-/*--------------------------------------------------------------------------*/
-
-void read_string
-
-     (char *v)         /* string to be read */
-
-/*
-  reads a string v
-*/
-
-{
-fgets (v, 80, stdin);
-
-if (v[strlen(v)-1] == '\n')
-   v[strlen(v)-1] = 0;
-
-return;
-
-}  /* read_string */
-
-/*--------------------------------------------------------------------------*/
-
-void read_long
-
-     (long *v)         /* value to be read */
-
-/*
-  reads a long value v
-*/
-
-{
-char   row[80];    /* string for reading data */
-
-fgets (row, 80, stdin);
-if (row[strlen(row)-1] == '\n')
-   row[strlen(row)-1] = 0;
-sscanf(row, "%ld", &*v);
-
-return;
-
-}  /* read_long */
-
-/*--------------------------------------------------------------------------*/
-
-void read_double
-
-     (double *v)         /* value to be read */
-
-/*
-  reads a double value v
-*/
-
-{
-char   row[80];    /* string for reading data */
-
-fgets (row, 80, stdin);
-
-if (row[strlen(row)-1] == '\n')
-   row[strlen(row)-1] = 0;
-sscanf(row, "%lf", &*v);
-
-return;
-
-}  /* read_double */
-
-/*--------------------------------------------------------------------------*/
-
-void skip_white_space_and_comments 
-
-     (FILE *inimage)  /* input file */
-
-/*
-  skips over white space and comments while reading the file
-*/
-
-{
-
-int   ch = 0;   /* holds a character */
-char  row[80];  /* for reading data */
-
-/* skip spaces */
-while (((ch = fgetc(inimage)) != EOF) && isspace(ch));
-  
-/* skip comments */
-if (ch == '#')
-   {
-   if (fgets(row, sizeof(row), inimage))
-      skip_white_space_and_comments (inimage);
-   else
-      {
-      printf("skip_white_space_and_comments: cannot read file\n");
-      exit(1);
-      }
-   }
-else
-   fseek (inimage, -1, SEEK_CUR);
-
-return;
-
-} /* skip_white_space_and_comments */
-
-/*--------------------------------------------------------------------------*/
-
-void read_pgm_to_double
-
-     (const char  *file_name,    /* name of pgm file */
-      long        *nx,           /* image size in x direction, output */
-      long        *ny,           /* image size in y direction, output */
-      double      ***u)          /* image, output */
-
-/*
-  reads a greyscale image that has been encoded in pgm format P5 to
-  an image u in double format;
-  allocates memory for the image u;
-  adds boundary layers of size 1 such that
-  - the relevant image pixels in x direction use the indices 1,...,nx
-  - the relevant image pixels in y direction use the indices 1,...,ny
-*/
-
-{
-char  row[80];      /* for reading data */
-long  i, j;         /* image indices */
-long  max_value;    /* maximum color value */
-FILE  *inimage;     /* input file */
-
-/* open file */
-inimage = fopen (file_name, "rb");
-if (inimage == NULL)
-   {
-   printf ("read_pgm_to_double: cannot open file '%s'\n", file_name);
-   exit(1);
-   }
-
-/* read header */
-if (fgets(row, 80, inimage) == NULL)
-   {
-   printf ("read_pgm_to_double: cannot read file\n");
-   exit(1);
-   }
-
-/* image type: P5 */
-if ((row[0] == 'P') && (row[1] == '5'))
-   {
-   /* P5: grey scale image */
-   }
-else
-   {
-   printf ("read_pgm_to_double: unknown image format\n");
-   exit(1);
-   }
-
-/* read image size in x direction */
-skip_white_space_and_comments (inimage);
-if (!fscanf (inimage, "%ld", nx))
-   {
-   printf ("read_pgm_to_double: cannot read image size nx\n");
-   exit(1);
-   }
-
-/* read image size in x direction */
-skip_white_space_and_comments (inimage);
-if (!fscanf (inimage, "%ld", ny))
-   {
-   printf ("read_pgm_to_double: cannot read image size ny\n");
-   exit(1);
-   }
-
-/* read maximum grey value */
-skip_white_space_and_comments (inimage);
-if (!fscanf (inimage, "%ld", &max_value))
-   {
-   printf ("read_pgm_to_double: cannot read maximal value\n");
-   exit(1);
-   }
-fgetc(inimage);
-
-/* allocate memory */
-alloc_double_matrix (u, (*nx)+2, (*ny)+2);
-
-/* read image data row by row */
-for (j=1; j<=(*ny); j++)
- for (i=1; i<=(*nx); i++)
-     (*u)[i][j] = (double) getc(inimage);
-
-/* close file */
-fclose (inimage);
-
-return;
-
-}  /* read_pgm_to_double */
-
-/*--------------------------------------------------------------------------*/
-
 void comment_line
 
      (char* comment,       /* comment string (output) */
@@ -357,114 +109,9 @@ return;
 
 /*--------------------------------------------------------------------------*/
 
-void write_double_to_pgm
-
-     (double  **u,          /* image, unchanged */
-      long    nx,           /* image size in x direction */
-      long    ny,           /* image size in y direction */
-      char    *file_name,   /* name of pgm file */
-      char    *comments)    /* comment string (set 0 for no comments) */
-
-/*
-  writes a greyscale image in double format into a pgm P5 file
-*/
-
-{
-FILE           *outimage;  /* output file */
-long           i, j;       /* loop variables */
-double         aux;        /* auxiliary variable */
-unsigned char  byte;       /* for data conversion */
-
-/* open file */
-outimage = fopen (file_name, "wb");
-if (NULL == outimage)
-   {
-   printf("could not open file '%s' for writing, aborting\n", file_name);
-   exit(1);
-   }
-
-/* write header */
-fprintf (outimage, "P5\n");                  /* format */
-if (comments != 0)
-   fputs (comments, outimage);               /* comments */
-fprintf (outimage, "%ld %ld\n", nx, ny);     /* image size */
-fprintf (outimage, "255\n");                 /* maximal value */
-
-/* write image data */
-for (j=1; j<=ny; j++)
- for (i=1; i<=nx; i++)
-     {
-     aux = u[i][j] + 0.499999;    /* for correct rounding */
-     if (aux < 0.0)
-        byte = (unsigned char)(0.0);
-     else if (aux > 255.0)
-        byte = (unsigned char)(255.0);
-     else
-        byte = (unsigned char)(aux);
-     fwrite (&byte, sizeof(unsigned char), 1, outimage);
-     }
-
-/* close file */
-fclose (outimage);
-
-return;
-
-}  /* write_double_to_pgm */
-
-/*--------------------------------------------------------------------------*/
-
-void analyse_grey_double
-
-     (double  **u,         /* image, unchanged */
-      long    nx,          /* pixel number in x direction */
-      long    ny,          /* pixel number in y direction */
-      double  *min,        /* minimum, output */
-      double  *max,        /* maximum, output */
-      double  *mean,       /* mean, output */
-      double  *std)        /* standard deviation, output */
-
-/*
-  computes minimum, maximum, mean, and standard deviation of a greyscale
-  image u in double format
-*/
-
-{
-long    i, j;       /* loop variables */
-double  help1;      /* auxiliary variable */
-double  help2;      /* auxiliary variable */
-
-/* compute maximum, minimum, and mean */
-*min  = u[1][1];
-*max  = u[1][1];
-help1 = 0.0;
-for (i=1; i<=nx; i++)
- for (j=1; j<=ny; j++)
-     {
-     if (u[i][j] < *min) *min = u[i][j];
-     if (u[i][j] > *max) *max = u[i][j];
-     help1 = help1 + u[i][j];
-     }
-*mean = help1 / (nx * ny);
-
-/* compute standard deviation */
-*std = 0.0;
-for (i=1; i<=nx; i++)
- for (j=1; j<=ny; j++)
-     {
-     help2  = u[i][j] - *mean;
-     *std = *std + help2 * help2;
-     }
-*std = sqrt(*std / (nx * ny));
-
-return;
-
-}  /* analyse_grey_double */
-
-/*--------------------------------------------------------------------------*/
-
 void rescale 
 
-     (double  **u,        /* input image, range [0,255] */
+     (image   *u,         /* input image, range [0,255] */
       long    nx,         /* size in x direction */
       long    ny,         /* size in y direction */
       double  a,          /* smallest transformed grey level */
@@ -487,15 +134,15 @@ double  aux;           /* time saver */
 min = 255.0f;
 max = 0.0f;
 
-for (i = 1; i <= nx; i++)
- for (j = 1; j <= ny; j++)
+for (j = 1; j <= ny; j++)
+ for (i = 1; i <= nx; i++)
  {
 
-    if (u[i][j] < min)
-      min = u[i][j];
+    if (PIX(u,i,j) < min)
+      min = PIX(u,i,j);
 
-    if(u[i][j] > max)
-      max = u[i][j];
+    if(PIX(u,i,j) > max)
+      max = PIX(u,i,j);
  }
 
 /* rescale */
@@ -535,7 +182,7 @@ return;
 
 void hist_equal
 
-     (double  **u,        /* input image, range [0,255] */
+     (image   *u,         /* input image, range [0,255] */
       long    nx,         /* size in x direction */
       long    ny,         /* size in y direction */
       double  *g)         /* transformed grey levels */
@@ -558,9 +205,9 @@ for (k = 0; k <= 255; k++)
   hist[k] = 0;
 
 /* create histogram of u with bin width 1 */
-for (i = 1; i <= nx; i++)
- for (j = 1; j <= ny; j++)
-     hist[(int)u[i][j]] += 1;
+for (j = 1; j <= ny; j++)
+ for (i = 1; i <= nx; i++)
+     hist[(int)PIX(u,i,j)] += 1;
 
 /* equalisation */
 k_r = 0;
@@ -587,41 +234,113 @@ return;
 
 /*--------------------------------------------------------------------------*/
 
-int main ()
+typedef struct
+   {
+   image        *u;      /* image, changed */
+   long         nx;      /* image dimension in x direction */
+   double       *g;      /* grey level mapping */
+   image_stats  *row;    /* statistics of each transformed row, output */
+   } lut_task;
+
+/*--------------------------------------------------------------------------*/
+
+void apply_lut_rows
+
+     (long     first,     /* first row */
+      long     last,      /* last row */
+      void     *arg)      /* lut_task */
+
+/*
+  applies the grey level mapping to the rows first,...,last and collects
+  the statistics of each finished row
+*/
+
+{
+lut_task  *t = (lut_task *) arg;   /* task */
+long      i, j;                    /* loop variables */
+
+for (j=first; j<=last; j++)
+    {
+    for (i=1; i<=t->nx; i++)
+        PIX(t->u,i,j) = t->g[(long)(PIX(t->u,i,j))];
+    stats_init (&t->row[j-1]);
+    stats_add_row (&t->row[j-1], ROW(t->u,j) + 1, t->nx);
+    }
+
+return;
+
+}  /* apply_lut_rows */
+
+/*--------------------------------------------------------------------------*/
+
+void apply_lut
+
+     (long         nx,    /* image dimension in x direction */
+      long         ny,    /* image dimension in y direction */
+      double       *g,    /* grey level mapping, unchanged */
+      image        *u,    /* input: original; output: transformed */
+      image_stats  *s)    /* statistics of the transformed image, output */
+
+/*
+  applies the grey level mapping g to all pixels of u
+*/
+
+{
+long      j;       /* loop variable */
+lut_task  t;       /* rows to be transformed */
+
+t.u   = u;
+t.nx  = nx;
+t.g   = g;
+t.row = (image_stats *) malloc (ny * sizeof(image_stats));
+if (t.row == NULL)
+   {
+   printf("apply_lut: not enough memory available\n");
+   exit(1);
+   }
+
+parallel_rows (1, ny, apply_lut_rows, &t);
+
+/* merge row statistics in row order */
+stats_init (s);
+for (j=0; j<ny; j++)
+    stats_merge (s, &t.row[j]);
+
+free (t.row);
+return;
+
+}  /* apply_lut */
+
+/*--------------------------------------------------------------------------*/
+
+void run_job ()
+
+/*
+  reads the parameters of one job and processes it
+*/
 
 {
 char    in[80];               /* for reading data */
 char    out[80];              /* for reading data */
-double  **u;                  /* image */
+image   *u;                   /* image */
 double  *g;                   /* grey level mapping */
 long    nx, ny;               /* image size in x, y direction */ 
-long    i, j;                 /* loop variables */ 
 long    transform;            /* type of point transformation */
 double  a, b;                 /* rescaling bounds */
 double  gamma;                /* gamma correction factor */
 double  max, min;             /* largest, smallest grey value */
 double  mean;                 /* average grey value */
 double  std;                  /* standard deviation */
+image_stats  s;               /* statistics of the transformed image */
 char    comments[1600];       /* string for comments */
 
-printf ("\n");
-printf ("POINT TRANSFORMATIONS\n\n");
-printf ("**************************************************\n\n");
-printf ("    Copyright 2021 by Joachim Weickert            \n");
-printf ("    Dept. of Mathematics and Computer Science     \n");
-printf ("    Saarland University, Saarbruecken, Germany    \n\n");
-printf ("    All rights reserved. Unauthorized usage,      \n");
-printf ("    copying, hiring, and selling prohibited.      \n\n");
-printf ("    Send bug reports to                           \n");
-printf ("    weickert@mia.uni-saarland.de                  \n\n");
-printf ("**************************************************\n\n");
-
-
 /* ---- read input image (pgm format P5) ---- */
 
 printf ("input image (pgm):                ");
 read_string (in);
-read_pgm_to_double (in, &nx, &ny, &u);   /* also allocates memory for u */
+read_pgm_to_double (in, 1, &u);   /* also allocates memory for u */
+nx = u->nx;
+ny = u->ny;
 
 
 /* ---- read parameters ---- */
@@ -654,7 +373,7 @@ printf ("\n");
 
 /* ---- analyse input image ---- */
 
-analyse_grey_double (u, nx, ny, &min, &max, &mean, &std);
+analyse_grey_double (u, &min, &max, &mean, &std);
 printf ("input image\n");
 printf ("minimum:          %8.2lf \n", min);
 printf ("maximum:          %8.2lf \n", max);
@@ -675,15 +394,14 @@ if (transform == 1)
 if (transform == 2) 
    hist_equal (u, nx, ny, g);
 
-/* apply greyscale transformation to the image */
-for (i=1; i<=nx; i++)
- for (j=1; j<=ny; j++)
-     u[i][j] = g[(long)(u[i][j])];
+/* apply greyscale transformation to the image and collect the */
+/* statistics of the transformed image */
+apply_lut (nx, ny, g, u, &s);
 
 
 /* ---- analyse transformed image ---- */
 
-analyse_grey_double (u, nx, ny, &min, &max, &mean, &std);
+stats_result (&s, &min, &max, &mean, &std);
 printf ("transformed image\n");
 printf ("minimum:          %8.2lf \n", min);
 printf ("maximum:          %8.2lf \n", max);
@@ -730,16 +448,45 @@ if (transform == 2)
 
 
 /* write image */
-write_double_to_pgm (u, nx, ny, out, comments);
+write_double_to_pgm (u, out, comments);
 printf ("output image %s successfully written\n\n", out);
 
 
 /* ---- free memory  ---- */
 
 free_double_vector (g, 256);
-free_double_matrix (u, nx+2, ny+2);
+free_image (u);
+
+return;
+
+}  /* run_job */
+
+/*--------------------------------------------------------------------------*/
+
+int main
+
+     (int   argc,        /* number of command line arguments */
+      char  **argv)      /* command line arguments */
+
+{
+printf ("\n");
+printf ("POINT TRANSFORMATIONS\n\n");
+printf ("**************************************************\n\n");
+printf ("    Copyright 2021 by Joachim Weickert            \n");
+printf ("    Dept. of Mathematics and Computer Science     \n");
+printf ("    Saarland University, Saarbruecken, Germany    \n\n");
+printf ("    All rights reserved. Unauthorized usage,      \n");
+printf ("    copying, hiring, and selling prohibited.      \n\n");
+printf ("    Send bug reports to                           \n");
+printf ("    weickert@mia.uni-saarland.de                  \n\n");
+printf ("**************************************************\n\n");
+
+/* ---- one run per job (interactive mode: exactly one) ---- */
+
+read_options (argc, argv);
+while (next_job ())
+   run_job ();
 
 return(0);
 
 }  /* main */
-
@@ -5,6 +5,12 @@
 #include <stdarg.h>
 #include <ctype.h>
 
+#include "image.h"
+#include "cli.h"
+#include "parallel.h"
+#include "gauss.h"
+#include "pyramid.h"
+
 /*--------------------------------------------------------------------------*/
 /*                                                                          */
 /*          GAUSSIAN-BASED HIGHPASS, LOWPASS AND BANDPASS FILTERS           */
@@ -19,6 +25,10 @@
 
 /*--------------------------------------------------------------------------*/
 
+#define BANK_MAX  8    /* maximum number of scales of the filter bank */
+
+/*--------------------------------------------------------------------------*/
+
 void alloc_double_vector
 
      (double **vector,   /* vector */
@@ -43,43 +53,6 @@ return;
 
 /*--------------------------------------------------------------------------*/
 
-void alloc_double_matrix
-
-     (double ***matrix,  /* matrix */
-      long   n1,         /* size in direction 1 */
-      long   n2)         /* size in direction 2 */
-
-/*
-  allocates memory for a double format matrix of size n1 * n2 
-*/
-
-{
-long i;    /* loop variable */
-
-*matrix = (double **) malloc (n1 * sizeof(double *));
-
-if (*matrix == NULL)
-   {
-   printf("alloc_double_matrix: not enough memory available\n");
-   exit(1);
-   }
-
-for (i=0; i<n1; i++)
-    {
-    (*matrix)[i] = (double *) malloc (n2 * sizeof(double));
-    if ((*matrix)[i] == NULL)
-       {
-       printf("alloc_double_matrix: not enough memory available\n");
-       exit(1);
-       }
-    }
-
-return;
-
-}  /* alloc_double_matrix */
-
-/*--------------------------------------------------------------------------*/
-
 void free_double_vector
 
      (double  *vector,    /* vector */
@@ -98,221 +71,6 @@ return;
 
 /*--------------------------------------------------------------------------*/
 
-void free_double_matrix
-
-     (double  **matrix,   /* matrix */
-      long    n1,         /* size in direction 1 */
-      long    n2)         /* size in direction 2 */
-
-/*
-  frees memory for a double format matrix of size n1 * n2
-*/
-
-{
-long i;   /* loop variable */
-
-for (i=0; i<n1; i++)
-free(matrix[i]);
-
-free(matrix);
-
-return;
-
-}  /* free_double_matrix */
-
-/*--------------------------------------------------------------------------*/
-
-void read_string
-
-     (char *v)         /* string to be read */
-
-/*
-  reads a string v
-*/
-
-{
-fgets (v, 80, stdin);
-
-if (v[strlen(v)-1] == '\n')
-   v[strlen(v)-1] = 0;
-
-return;
-
-}  /* read_string */
-
-/*--------------------------------------------------------------------------*/
-
-void read_long
-
-     (long *v)         /* value to be read */
-
-/*
-  reads a long value v
-*/
-
-{
-char   row[80];    /* string for reading data */
-
-fgets (row, 80, stdin);
-if (row[strlen(row)-1] == '\n')
-   row[strlen(row)-1] = 0;
-sscanf(row, "%ld", &*v);
-
-return;
-
-}  /* read_long */
-
-/*--------------------------------------------------------------------------*/
-
-void read_double
-
-     (double *v)         /* value to be read */
-
-/*
-  reads a double value v
-*/
-
-{
-char   row[80];    /* string for reading data */
-
-fgets (row, 80, stdin);
-
-if (row[strlen(row)-1] == '\n')
-   row[strlen(row)-1] = 0;
-sscanf(row, "%lf", &*v);
-
-return;
-
-}  /* read_double */
-
-/*--------------------------------------------------------------------------*/
-
-void skip_white_space_and_comments 
-
-     (FILE *inimage)  /* input file */
-
-/*
-  skips over white space and comments while reading the file
-*/
-
-{
-
-int   ch = 0;   /* holds a character */
-char  row[80];  /* for reading data */
-
-/* skip spaces */
-while (((ch = fgetc(inimage)) != EOF) && isspace(ch));
-  
-/* skip comments */
-if (ch == '#')
-   {
-   if (fgets(row, sizeof(row), inimage))
-      skip_white_space_and_comments (inimage);
-   else
-      {
-      printf("skip_white_space_and_comments: cannot read file\n");
-      exit(1);
-      }
-   }
-else
-   fseek (inimage, -1, SEEK_CUR);
-
-return;
-
-} /* skip_white_space_and_comments */
-
-/*--------------------------------------------------------------------------*/
-
-void read_pgm_to_double
-
-     (const char  *file_name,    /* name of pgm file */
-      long        *nx,           /* image size in x direction, output */
-      long        *ny,           /* image size in y direction, output */
-      double      ***u)          /* image, output */
-
-/*
-  reads a greyscale image that has been encoded in pgm format P5 to
-  an image u in double format;
-  allocates memory for the image u;
-  adds boundary layers of size 1 such that
-  - the relevant image pixels in x direction use the indices 1,...,nx
-  - the relevant image pixels in y direction use the indices 1,...,ny
-*/
-
-{
-char  row[80];      /* for reading data */
-long  i, j;         /* image indices */
-long  max_value;    /* maximum color value */
-FILE  *inimage;     /* input file */
-
-/* open file */
-inimage = fopen (file_name, "rb");
-if (inimage == NULL)
-   {
-   printf ("read_pgm_to_double: cannot open file '%s'\n", file_name);
-   exit(1);
-   }
-
-/* read header */
-if (fgets(row, 80, inimage) == NULL)
-   {
-   printf ("read_pgm_to_double: cannot read file\n");
-   exit(1);
-   }
-
-/* image type: P5 */
-if ((row[0] == 'P') && (row[1] == '5'))
-   {
-   /* P5: grey scale image */
-   }
-else
-   {
-   printf ("read_pgm_to_double: unknown image format\n");
-   exit(1);
-   }
-
-/* read image size in x direction */
-skip_white_space_and_comments (inimage);
-if (!fscanf (inimage, "%ld", nx))
-   {
-   printf ("read_pgm_to_double: cannot read image size nx\n");
-   exit(1);
-   }
-
-/* read image size in x direction */
-skip_white_space_and_comments (inimage);
-if (!fscanf (inimage, "%ld", ny))
-   {
-   printf ("read_pgm_to_double: cannot read image size ny\n");
-   exit(1);
-   }
-
-/* read maximum grey value */
-skip_white_space_and_comments (inimage);
-if (!fscanf (inimage, "%ld", &max_value))
-   {
-   printf ("read_pgm_to_double: cannot read maximal value\n");
-   exit(1);
-   }
-fgetc(inimage);
-
-/* allocate memory */
-alloc_double_matrix (u, (*nx)+2, (*ny)+2);
-
-/* read image data row by row */
-for (j=1; j<=(*ny); j++)
- for (i=1; i<=(*nx); i++)
-     (*u)[i][j] = (double) getc(inimage);
-
-/* close file */
-fclose (inimage);
-
-return;
-
-}  /* read_pgm_to_double */
-
-/*--------------------------------------------------------------------------*/
-
 void comment_line
 
      (char* comment,       /* comment string (output) */
@@ -354,304 +112,76 @@ return;
 
 /*--------------------------------------------------------------------------*/
 
-void write_double_to_pgm
-
-     (double  **u,          /* image, unchanged */
-      long    nx,           /* image size in x direction */
-      long    ny,           /* image size in y direction */
-      char    *file_name,   /* name of pgm file */
-      char    *comments)    /* comment string (set 0 for no comments) */
-
-/*
-  writes a greyscale image in double format into a pgm P5 file
-*/
-
-{
-FILE           *outimage;  /* output file */
-long           i, j;       /* loop variables */
-double         aux;        /* auxiliary variable */
-unsigned char  byte;       /* for data conversion */
-
-/* open file */
-outimage = fopen (file_name, "wb");
-if (NULL == outimage)
+typedef struct
    {
-   printf("could not open file '%s' for writing, aborting\n", file_name);
-   exit(1);
-   }
-
-/* write header */
-fprintf (outimage, "P5\n");                  /* format */
-if (comments != 0)
-   fputs (comments, outimage);               /* comments */
-fprintf (outimage, "%ld %ld\n", nx, ny);     /* image size */
-fprintf (outimage, "255\n");                 /* maximal value */
-
-/* write image data */
-for (j=1; j<=ny; j++)
- for (i=1; i<=nx; i++)
-     {
-     aux = u[i][j] + 0.499999;    /* for correct rounding */
-     if (aux < 0.0)
-        byte = (unsigned char)(0.0);
-     else if (aux > 255.0)
-        byte = (unsigned char)(255.0);
-     else
-        byte = (unsigned char)(aux);
-     fwrite (&byte, sizeof(unsigned char), 1, outimage);
-     }
-
-/* close file */
-fclose (outimage);
-
-return;
-
-}  /* write_double_to_pgm */
+   image   *u;           /* image */
+   long    nx;           /* size in x direction */
+   double  *min, *max;   /* extrema of each row, output */
+   double  a;            /* smallest transformed grey level */
+   double  width;        /* b - a */
+   double  shift;        /* minimum of u */
+   double  range;        /* max - min */
+   } rescale_task;
 
 /*--------------------------------------------------------------------------*/
 
-void analyse_grey_double
+void extrema_rows
 
-     (double  **u,         /* image, unchanged */
-      long    nx,          /* pixel number in x direction */
-      long    ny,          /* pixel number in y direction */
-      double  *min,        /* minimum, output */
-      double  *max,        /* maximum, output */
-      double  *mean,       /* mean, output */
-      double  *std)        /* standard deviation, output */
+     (long    first,      /* first row */
+      long    last,       /* last row */
+      void    *arg)       /* rescale_task */
 
 /*
-  computes minimum, maximum, mean, and standard deviation of a greyscale
-  image u in double format
+  extrema of the rows first,...,last
 */
 
 {
-long    i, j;       /* loop variables */
-double  help1;      /* auxiliary variable */
-double  help2;      /* auxiliary variable */
-
-/* compute maximum, minimum, and mean */
-*min  = u[1][1];
-*max  = u[1][1];
-help1 = 0.0;
-for (i=1; i<=nx; i++)
- for (j=1; j<=ny; j++)
-     {
-     if (u[i][j] < *min) *min = u[i][j];
-     if (u[i][j] > *max) *max = u[i][j];
-     help1 = help1 + u[i][j];
-     }
-*mean = help1 / (nx * ny);
-
-/* compute standard deviation */
-*std = 0.0;
-for (i=1; i<=nx; i++)
- for (j=1; j<=ny; j++)
-     {
-     help2  = u[i][j] - *mean;
-     *std = *std + help2 * help2;
-     }
-*std = sqrt(*std / (nx * ny));
+rescale_task  *t = (rescale_task *) arg;   /* task */
+long          i, j;                        /* loop variables */
+
+for (j=first; j<=last; j++)
+    {
+    t->min[j] = t->max[j] = PIX(t->u,1,j);
+    for (i=1; i<=t->nx; i++)
+        {
+        if (PIX(t->u,i,j) < t->min[j]) t->min[j] = PIX(t->u,i,j);
+        if (PIX(t->u,i,j) > t->max[j]) t->max[j] = PIX(t->u,i,j);
+        }
+    }
 
 return;
 
-}  /* analyse_grey_double */
+}  /* extrema_rows */
 
 /*--------------------------------------------------------------------------*/
 
-void gauss_conv 
-
-    (double   sigma,     /* standard deviation of the Gaussian */
-     long     btype,     /* type of boundary condition */
-     double   prec,      /* cutoff at precision * sigma */
-     long     nx,        /* image dimension in x direction */
-     long     ny,        /* image dimension in y direction */
-     double   hx,        /* pixel size in x direction */
-     double   hy,        /* pixel size in y direction */
-     double   **u)       /* input: original image ;  output: smoothed */
+void rescale_rows
 
+     (long    first,      /* first row */
+      long    last,       /* last row */
+      void    *arg)       /* rescale_task */
 
 /*
-  Gaussian convolution with a truncated and resampled Gaussian
+  affine rescaling of the rows first,...,last
 */
 
-
 {
-long    i, j, k, l, p;        /* loop variables */
-long    length;               /* convolution vector: 0..length */
-long    pmax;                 /* upper bound for p */
-double  aux1, aux2;           /* time savers */
-double  sum;                  /* for summing up */
-double  *conv;                /* convolution vector */
-double  *help;                /* row or column with dummy boundaries */
-
-
-/* ----------------------- convolution in x direction -------------------- */
-
-/* compute length of convolution vector */
-length = (long)(prec * sigma / hx) + 1;
-
-/* allocate memory for convolution vector */
-alloc_double_vector (&conv, length+1);
-
-/* compute entries of convolution vector */
-aux1 = 1.0 / (sigma * sqrt(2.0 * 3.1415927));
-aux2 = (hx * hx) / (2.0 * sigma * sigma);
-for (i=0; i<=length; i++)
-    conv[i] = aux1 * exp (- i * i * aux2);
-
-/* normalisation */
-sum = conv[0];
-for (i=1; i<=length; i++)
-    sum = sum + 2.0 * conv[i];
-for (i=0; i<=length; i++)
-    conv[i] = conv[i] / sum;
-
-/* allocate memory for a row */
-alloc_double_vector (&help, nx+length+length);
-
-for (j=1; j<=ny; j++)
-    {
-    /* copy u in row vector */
-    for (i=1; i<=nx; i++)
-        help[i+length-1] = u[i][j];
-
-    /* extend signal according to the boundary conditions */
-    k = length;
-    l = length + nx - 1;
-    while (k > 0)
-          {
-          /* pmax = min (k, nx) */
-          if (k < nx)
-             pmax = k;
-          else
-             pmax = nx;
- 
-          /* extension on both sides */
-          if (btype == 0) 
-             /* reflecting b.c.: symmetric extension */
-             for (p=1; p<=pmax; p++)
-                 {
-                 help[k-p] = help[k+p-1];
-                 help[l+p] = help[l-p+1];
-                 }
-          else
-             /* Dirichlet b.c.: antisymmetric extension */
-             for (p=1; p<=pmax; p++)
-                 {
-                 help[k-p] = - help[k+p-1];
-                 help[l+p] = - help[l-p+1];
-                 }
-
-          /* update k and l */
-          k = k - nx;
-          l = l + nx;
-          }
-
-    /* convolution step */
-    for (i=length; i<=nx+length-1; i++)
-        {
-        /* compute convolution */
-        sum = conv[0] * help[i];
-        for (p=1; p<=length; p++)
-            sum = sum + conv[p] * (help[i+p] + help[i-p]);
-        /* write back */
-        u[i-length+1][j] = sum;
-        }
-    } /* for j */
-
-/* free memory */
-free_double_vector (help, nx+length+length);
-free_double_vector (conv, length + 1);
-
-
-/* ----------------------- convolution in y direction -------------------- */
-
-/* compute length of convolution vector */
-length = (long)(prec * sigma / hy) + 1;
-
-/* allocate memory for convolution vector */
-alloc_double_vector (&conv, length + 1);
-
-/* compute entries of convolution vector */
-aux1 = 1.0 / (sigma * sqrt(2.0 * 3.1415927));
-aux2 = (hy * hy) / (2.0 * sigma * sigma);
-for (j=0; j<=length; j++)
-    conv[j] = aux1 * exp (- j * j * aux2);
+rescale_task  *t = (rescale_task *) arg;   /* task */
+long          i, j;                        /* loop variables */
 
-/* normalisation */
-sum = conv[0];
-for (j=1; j<=length; j++)
-    sum = sum + 2.0 * conv[j];
-for (j=0; j<=length; j++)
-    conv[j] = conv[j] / sum;
-
-/* allocate memory for a row */
-alloc_double_vector (&help, ny+length+length);
-
-for (i=1; i<=nx; i++)
-    {
-    /* copy u in column vector */
-    for (j=1; j<=ny; j++)
-        help[j+length-1] = u[i][j];
-
-    /* extend signal according to the boundary conditions */
-    k = length;
-    l = length + ny - 1;
-    while (k > 0)
-          {
-          /* pmax = min (k, ny) */
-          if (k < ny)
-             pmax = k;
-          else
-             pmax = ny;
-
-          /* extension on both sides */
-          if (btype == 0)
-             /* reflecting b.c.: symmetric extension */
-             for (p=1; p<=pmax; p++)
-                 {
-                 help[k-p] = help[k+p-1];
-                 help[l+p] = help[l-p+1];
-                 }
-          else
-             /* Dirichlet b.c.: antisymmetric extension */
-             for (p=1; p<=pmax; p++)
-                 {
-                 help[k-p] = - help[k+p-1];
-                 help[l+p] = - help[l-p+1];
-                 }
-
-          /* update k and l */
-          k = k - ny;
-          l = l + ny;
-          }
-
-    /* convolution step */
-    for (j=length; j<=ny+length-1; j++)
-        {
-        /* compute convolution */
-        sum = conv[0] * help[j];
-        for (p=1; p<=length; p++)
-            sum = sum + conv[p] * (help[j+p] + help[j-p]);
-        /* write back */
-        u[i][j-length+1] = sum;
-        }
-    } /* for i */
-
-/* free memory */
-free_double_vector (help, ny+length+length);
-free_double_vector (conv, length+1);
+for (j=first; j<=last; j++)
+ for (i=1; i<=t->nx; i++)
+     PIX(t->u,i,j) = t->a + (PIX(t->u,i,j) - t->shift) / t->range * t->width;
 
 return;
 
-} /* gauss_conv */
+}  /* rescale_rows */
 
 /*--------------------------------------------------------------------------*/
 
 void rescale 
 
-     (double  **u,        /* input image */
+     (image   *u,         /* input image */
       long    nx,         /* size in x direction */
       long    ny,         /* size in y direction */
       double  a,          /* smallest transformed grey level */
@@ -663,23 +193,39 @@ void rescale
 */
 
 {
-long    i, j;       /* loop variables */
-double  min, max;   /* extrema of u */
+long          j;          /* loop variable */
+double        min, max;   /* extrema of u */
+rescale_task  t;          /* rows to be rescaled */
+
+t.u   = u;
+t.nx  = nx;
+t.min = (double *) malloc ((ny + 1) * sizeof(double));
+t.max = (double *) malloc ((ny + 1) * sizeof(double));
+if ((t.min == NULL) || (t.max == NULL))
+   {
+   printf("rescale: not enough memory available\n");
+   exit(1);
+   }
 
 /* find extrema of u */
-min = max = u[1][1];
-for (i=1; i<=nx; i++)
- for (j=1; j<=ny; j++)
-     {
-     if (u[i][j] < min) min = u[i][j];
-     if (u[i][j] > max) max = u[i][j];
-     }
+parallel_rows (1, ny, extrema_rows, &t);
+min = t.min[1];
+max = t.max[1];
+for (j=2; j<=ny; j++)
+    {
+    if (t.min[j] < min) min = t.min[j];
+    if (t.max[j] > max) max = t.max[j];
+    }
 
 /* rescale */
-for (i=1; i<=nx; i++)
- for (j=1; j<=ny; j++)
-     u[i][j] = a + (u[i][j] - min) / (max - min) * (b - a);
-
+t.a     = a;
+t.width = b - a;
+t.shift = min;
+t.range = max - min;
+parallel_rows (1, ny, rescale_rows, &t);
+
+free (t.min);
+free (t.max);
 return;
 
 }  /* rescale */
@@ -689,11 +235,12 @@ return;
 void lowpass
 
      (double  sigma,      /* standard deviation of Gaussian */
+      long    backend,    /* GAUSS_AUTO, GAUSS_FFT or GAUSS_RECURSIVE */
       long    nx,         /* image dimension in x direction */
       long    ny,         /* image dimension in y direction */
       double  hx,         /* pixel size in x direction */
       double  hy,         /* pixel size in y direction */
-      double  **u)        /* input: original; output: lowpass filtered */
+      image   *u)         /* input: original; output: lowpass filtered */
 
 /* 
   lowpass filter 
@@ -701,7 +248,7 @@ void lowpass
 
 {  
 /* apply Gaussian convolution */
-gauss_conv (sigma, 0, 3.0, nx, ny, hx, hy, u);
+gauss_conv_backend (backend, sigma, 0, 3.0, nx, ny, hx, hy, u);
 
 return;
 
@@ -712,40 +259,30 @@ return;
 void highpass
 
      (double   sigma,      /* standard deviation of Gaussian */
+      long     backend,    /* GAUSS_AUTO, GAUSS_FFT or GAUSS_RECURSIVE */
       long     nx,         /* image dimension in x direction */
       long     ny,         /* image dimension in y direction */
       double   hx,         /* pixel size in x direction */
       double   hy,         /* pixel size in y direction */
-      double   **u)        /* input: original; output: highpass filtered */
+      image    *u)         /* input: original; output: highpass filtered */
       
 /*
-  highpass filter 
+  highpass filter u - G_sigma * u, computed as the first band of a
+  filter bank with one scale, which may overwrite u
 */
 
 {  
-long    i, j;      /* loop variables */
-double  **v;       /* Gaussian-smoothed image */
+image   *band[2];   /* highpass (= u) and lowpass */
 
 /* allocate memory */
-alloc_double_matrix (&v, nx+2, ny+2);
-
-/* copy image u to v */
-for (i=1; i<=nx; i++)
- for (j=1; j<=ny; j++)
-     v[i][j] = u[i][j];
-
-/* apply Gaussian to temporary array */
-gauss_conv (sigma, 0, 3.0, nx, ny, hx, hy, v);
+alloc_image (&band[1], 1, nx, ny, 1);
 
 /* compute highpass filter */
-for (i=1; i<=nx; i++)
- for (j=1; j<=ny; j++) 
-     {
-     /* SUPPLEMENT YOUR CODE HERE */
-     }
+band[0] = u;
+gauss_bank (1, &sigma, 0, 3.0, backend, nx, ny, hx, hy, u, band);
   
 /* free memory */
-free_double_matrix (v, nx+2, ny+2);
+free_image (band[1]);
 
 return;
 
@@ -757,47 +294,38 @@ void bandpass
 
      (double   sigma1,     /* standard deviation of first Gaussian */
       double   sigma2,     /* standard deviation of second Gaussian */
+      long     backend,    /* GAUSS_AUTO, GAUSS_FFT or GAUSS_RECURSIVE */
       long     nx,         /* image dimension in x direction */
       long     ny,         /* image dimension in y direction */
       double   hx,         /* pixel size in x direction */
       double   hy,         /* pixel size in y direction */
-      double   **u)        /* input: original; output: bandpass filtered */
+      image    *u)         /* input: original; output: bandpass filtered */
 
 /* 
-  bandpass filter with sigma1 > sigma2 
+  bandpass filter G_sigma2 * u - G_sigma1 * u with sigma1 > sigma2,
+  computed as the middle band of a filter bank with the scales sigma2,
+  sigma1
 */
 
 {
-long    i, j;   /* loop variables */
-double  **v;    /* Gaussian-smoothed image with standard deviation sigma1 */
-double  **w;    /* Gaussian-smoothed image with standard deviation sigma2 */
+long    k;            /* loop variable */
+double  sigma[2];     /* scales of the filter bank */
+image   *band[3];     /* highpass, bandpass, lowpass */
 
 /* allocate memory */
-alloc_double_matrix (&v, nx+2, ny+2);
-alloc_double_matrix (&w, nx+2, ny+2);
-
-/* copy f to v and w */
-for (i=1; i<=nx; i++)
- for (j=1; j<=ny; j++) 
-     {
-     v[i][j] = u[i][j];
-     w[i][j] = u[i][j];
-     }
-
-/* Gaussian smoothing of v and w */
-gauss_conv (sigma1, 0, 3.0, nx, ny, hx, hy, v);
-gauss_conv (sigma2, 0, 3.0, nx, ny, hx, hy, w);
-
-/* compute bandpass filter */
-for (i=1; i<=nx; i++)
- for (j=1; j<=ny; j++) 
-     {
-     /* SUPPLEMENT YOUR CODE HERE */
-     }
+for (k=1; k<=2; k++)
+    alloc_image (&band[k], 1, nx, ny, 1);
+
+/* compute bandpass filter; the highpass band may overwrite u */
+sigma[0] = sigma2;
+sigma[1] = sigma1;
+band[0]  = u;
+gauss_bank (2, sigma, 0, 3.0, backend, nx, ny, hx, hy, u, band);
+copy_image (band[1], u);
 
 /* free memory */
-free_double_matrix (v, nx+2, ny+2);
-free_double_matrix (w, nx+2, ny+2);
+for (k=1; k<=2; k++)
+    free_image (band[k]);
 
 return;
 
@@ -805,40 +333,179 @@ return;
 
 /*--------------------------------------------------------------------------*/
 
-int main ()
+void filter_bank
+
+     (long    n,          /* number of scales */
+      double  *sigma,     /* standard deviations, increasing */
+      long    backend,    /* GAUSS_AUTO, GAUSS_FFT or GAUSS_RECURSIVE */
+      image   *u,         /* original image, unchanged */
+      char    *in,        /* name of the input image */
+      char    *prefix)    /* output images: prefix0.pgm,...,prefixn.pgm */
+
+/*
+  splits u into a highpass, n-1 differences of Gaussians and a lowpass
+  in one sweep, and writes the bands; all but the lowpass are affinely
+  rescaled to [0,255]
+*/
+
+{
+long    k;                    /* loop variable */
+image   *band[BANK_MAX+1];    /* bands */
+double  max, min;             /* largest, smallest grey value */
+double  mean;                 /* average grey value */
+double  std;                  /* standard deviation */
+char    out[100];             /* name of an output image */
+char    comments[1600];       /* string for comments */
+
+/* ---- filter ---- */
+
+for (k=0; k<=n; k++)
+    alloc_image (&band[k], 1, u->nx, u->ny, 1);
+gauss_bank (n, sigma, 0, 3.0, backend, u->nx, u->ny, 1.0, 1.0, u, band);
+
+
+/* ---- analyse, rescale and write the bands ---- */
+
+for (k=0; k<=n; k++)
+    {
+    analyse_grey_double (band[k], &min, &max, &mean, &std);
+    printf ("band %ld: min %8.2lf  max %8.2lf  mean %8.2lf  std %8.2lf\n",
+            k, min, max, mean, std);
+
+    comments[0]='\0';
+    if (k == 0)
+       comment_line (comments, "# Gaussian filter bank: highpass\n");
+    else if (k < n)
+       comment_line (comments, "# Gaussian filter bank: bandpass\n");
+    else
+       comment_line (comments, "# Gaussian filter bank: lowpass\n");
+    comment_line (comments, "# input image:  %s\n", in);
+    if (k > 0)
+       comment_line (comments, "# sigma1:     %8.2lf\n", sigma[k-1]);
+    if (k < n)
+       comment_line (comments, "# sigma2:     %8.2lf\n", sigma[k]);
+    comment_line (comments, "# min:        %8.2lf\n", min);
+    comment_line (comments, "# max:        %8.2lf\n", max);
+    comment_line (comments, "# mean:       %8.2lf\n", mean);
+    comment_line (comments, "# st. dev.:   %8.2lf\n", std);
+    if (k < n)
+       {
+       rescale (band[k], u->nx, u->ny, 0.0, 255.0);
+       comment_line (comments, "# affinely rescaled to [0,255]");
+       }
+
+    sprintf (out, "%s%ld.pgm", prefix, k);
+    write_double_to_pgm (band[k], out, comments);
+    printf ("output image %s successfully written\n", out);
+    }
+printf ("\n");
+
+for (k=0; k<=n; k++)
+    free_image (band[k]);
+
+return;
+
+}  /* filter_bank */
+
+/*--------------------------------------------------------------------------*/
+
+void scale_space
+
+     (long    octaves,    /* number of octaves */
+      long    scales,     /* steps per octave */
+      double  sigma0,     /* scale of level 0 */
+      long    backend,    /* GAUSS_AUTO, GAUSS_FFT or GAUSS_RECURSIVE */
+      image   *u,         /* original image, unchanged */
+      char    *in,        /* name of the input image */
+      char    *prefix)    /* output images: prefix0.pgm, prefix1.pgm, ... */
+
+/*
+  builds a Gaussian pyramid of u, smoothing each level incrementally from
+  the previous one and halving the size after each octave, and writes all
+  levels
+*/
+
+{
+long     k;                   /* loop variable */
+pyramid  *p;                  /* pyramid */
+double   max, min;            /* largest, smallest grey value */
+double   mean;                /* average grey value */
+double   std;                 /* standard deviation */
+char     out[100];            /* name of an output image */
+char     comments[1600];      /* string for comments */
+
+/* ---- filter ---- */
+
+alloc_pyramid (&p, u->nx, u->ny, octaves, scales, sigma0);
+build_pyramid (p, 0, 3.0, backend, u);
+
+
+/* ---- analyse and write the levels ---- */
+
+for (k=0; k<p->levels; k++)
+    {
+    analyse_grey_double (&p->level[k], &min, &max, &mean, &std);
+    printf ("level %ld: %4ld x %-4ld  sigma %8.2lf  mean %8.2lf  "
+            "std %8.2lf\n", k, p->level[k].nx, p->level[k].ny,
+            p->sigma[k], mean, std);
+
+    comments[0]='\0';
+    comment_line (comments, "# Gaussian scale-space pyramid\n");
+    comment_line (comments, "# input image:  %s\n", in);
+    comment_line (comments, "# level:      %8ld\n", k);
+    comment_line (comments, "# sigma:      %8.2lf\n", p->sigma[k]);
+    comment_line (comments, "# grid size:  %8.2lf\n", p->h[k]);
+    comment_line (comments, "# min:        %8.2lf\n", min);
+    comment_line (comments, "# max:        %8.2lf\n", max);
+    comment_line (comments, "# mean:       %8.2lf\n", mean);
+    comment_line (comments, "# st. dev.:   %8.2lf\n", std);
+
+    sprintf (out, "%s%ld.pgm", prefix, k);
+    write_double_to_pgm (&p->level[k], out, comments);
+    printf ("output image %s successfully written\n", out);
+    }
+printf ("\n");
+
+free_pyramid (p);
+
+return;
+
+}  /* scale_space */
+
+/*--------------------------------------------------------------------------*/
+
+void run_job ()
+
+/*
+  reads the parameters of one job and processes it
+*/
 
 {
 char    in[80];               /* for reading data */
 char    out[80];              /* for reading data */
-double  **u;                  /* image */
+image   *u;                   /* image */
 long    nx, ny;               /* image size in x, y direction */ 
 double  sigma1;               /* standard deviation for first Gaussian */
 double  sigma2;               /* standard deviation for second Gaussian */
 long    filter;               /* variable for filter choice */
+long    backend;              /* backend of the Gaussian convolution */
+long    n;                    /* number of scales of the filter bank */
+long    k;                    /* loop variable */
+double  sigma[BANK_MAX];      /* scales of the filter bank */
+long    octaves;              /* number of octaves of the pyramid */
+long    scales;               /* steps per octave of the pyramid */
 double  max, min;             /* largest, smallest grey value */
 double  mean;                 /* average grey value */
 double  std;                  /* standard deviation */
 char    comments[1600];       /* string for comments */
 
-printf ("\n");
-printf ("GAUSSIAN-BASED HIGHPASS, LOWPASS, AND BANDPASS FILTERS\n\n");
-printf ("*****************************************************\n\n");
-printf ("    Copyright 2021 by Joachim Weickert               \n");
-printf ("    and Pascal Peter                                 \n");
-printf ("    Dept. of Mathematics and Computer Science        \n");
-printf ("    Saarland University, Saarbruecken, Germany       \n\n");
-printf ("    All rights reserved. Unauthorized usage,         \n");
-printf ("    copying, hiring, and selling prohibited.         \n\n");
-printf ("    Send bug reports to                              \n");
-printf ("    weickert@mia.uni-saarland.de                     \n\n");
-printf ("*****************************************************\n\n");
-
-
 /* ---- read input image (pgm format P5) ---- */
 
 printf ("input image (pgm):                           ");
 read_string (in);
-read_pgm_to_double (in, &nx, &ny, &u);
+read_pgm_to_double (in, 1, &u);
+nx = u->nx;
+ny = u->ny;
 
 
 /* ---- read parameters ---- */
@@ -847,9 +514,24 @@ printf ("available linear filters:\n");
 printf (" (0) lowpass             \n");
 printf (" (1) highpass            \n");
 printf (" (2) bandpass            \n");
+printf (" (3) filter bank         \n");
+printf (" (4) scale-space pyramid \n");
 printf ("your choice:                                 ");
 read_long (&filter);
 
+printf ("Gaussian convolution:\n");
+printf (" (0) direct or FFT, by sigma                 \n");
+printf (" (1) FFT                                     \n");
+printf (" (2) recursive (inaccurate for small sigma)  \n");
+printf ("your choice:                                 ");
+read_long (&backend);
+if ((backend != GAUSS_AUTO) && (backend != GAUSS_FFT)
+    && (backend != GAUSS_RECURSIVE))
+   {
+   printf ("Gaussian convolution (%ld) not available!\n\n", backend);
+   exit(1);
+   }
+
 if ((filter == 0) || (filter == 1))
    {
    printf ("Gaussian standard deviation sigma:           ");
@@ -862,15 +544,53 @@ if (filter == 2)
    printf ("smaller Gaussian standard deviation sigma2:  ");
    read_double (&sigma2);
    }
-
-printf ("output image (pgm):                          ");
-read_string (out);
-printf ("\n");
+if (filter == 3)
+   {
+   printf ("number of scales (1,...,%d):                 ", BANK_MAX);
+   read_long (&n);
+   if ((n < 1) || (n > BANK_MAX))
+      {
+      printf ("number of scales (%ld) not available!\n\n", n);
+      exit(1);
+      }
+   for (k=0; k<n; k++)
+       {
+       printf ("standard deviation sigma%ld (increasing):     ", k + 1);
+       read_double (&sigma[k]);
+       }
+   printf ("output images (prefix):                      ");
+   read_string (out);
+   printf ("\n");
+   }
+else if (filter == 4)
+   {
+   printf ("number of octaves (>= 1):                    ");
+   read_long (&octaves);
+   printf ("steps per octave (>= 1):                     ");
+   read_long (&scales);
+   if ((octaves < 1) || (scales < 1))
+      {
+      printf ("pyramid with %ld octaves of %ld steps not available!\n\n",
+              octaves, scales);
+      exit(1);
+      }
+   printf ("standard deviation sigma0 of level 0:        ");
+   read_double (&sigma1);
+   printf ("output images (prefix):                      ");
+   read_string (out);
+   printf ("\n");
+   }
+else
+   {
+   printf ("output image (pgm):                          ");
+   read_string (out);
+   printf ("\n");
+   }
 
 
 /* ---- analyse input image ---- */
 
-analyse_grey_double (u, nx, ny, &min, &max, &mean, &std);
+analyse_grey_double (u, &min, &max, &mean, &std);
 printf ("input image:\n");
 printf ("minimum:       %8.2lf \n", min);
 printf ("maximum:       %8.2lf \n", max);
@@ -878,28 +598,50 @@ printf ("mean:          %8.2lf \n", mean);
 printf ("standard dev.: %8.2lf \n\n", std);
 
 
+/* ---- filter bank: all bands analysed and written separately ---- */
+
+if (filter == 3)
+   {
+   printf ("applying filter bank\n\n");
+   filter_bank (n, sigma, backend, u, in, out);
+   free_image (u);
+   return;
+   }
+
+
+/* ---- scale-space pyramid: all levels analysed and written ---- */
+
+if (filter == 4)
+   {
+   printf ("building scale-space pyramid\n\n");
+   scale_space (octaves, scales, sigma1, backend, u, in, out);
+   free_image (u);
+   return;
+   }
+
+
 /* ---- process image with linear filter ---- */
 
 if (filter == 0) 
    {
    printf ("applying lowpass filter\n\n");
-   lowpass (sigma1, nx, ny, 1.0, 1.0, u);
+   lowpass (sigma1, backend, nx, ny, 1.0, 1.0, u);
    }
 else if (filter == 1) 
    {
    printf ("applying highpass filter\n\n");
-   highpass (sigma1, nx, ny, 1.0, 1.0, u);
+   highpass (sigma1, backend, nx, ny, 1.0, 1.0, u);
    } 
 else if (filter == 2) 
    {
    printf ("applying bandpass filter\n\n");
-   bandpass (sigma1, sigma2, nx, ny, 1.0, 1.0, u);
+   bandpass (sigma1, sigma2, backend, nx, ny, 1.0, 1.0, u);
    }
 
 
 /* ---- analyse filtered image ---- */
 
-analyse_grey_double (u, nx, ny, &min, &max, &mean, &std);
+analyse_grey_double (u, &min, &max, &mean, &std);
 printf ("filtered image:\n");
 printf ("minimum:       %8.2lf \n", min);
 printf ("maximum:       %8.2lf \n", max);
@@ -952,13 +694,45 @@ else if (filter == 2)
    }
 
 /* write image */
-write_double_to_pgm (u, nx, ny, out, comments);
+write_double_to_pgm (u, out, comments);
 printf ("output image %s successfully written\n\n", out);
 
 
 /* ---- free memory  ---- */
 
-free_double_matrix (u, nx+2, ny+2);
+free_image (u);
+
+return;
+
+}  /* run_job */
+
+/*--------------------------------------------------------------------------*/
+
+int main
+
+     (int   argc,        /* number of command line arguments */
+      char  **argv)      /* command line arguments */
+
+{
+printf ("\n");
+printf ("GAUSSIAN-BASED HIGHPASS, LOWPASS, AND BANDPASS FILTERS\n\n");
+printf ("*****************************************************\n\n");
+printf ("    Copyright 2021 by Joachim Weickert               \n");
+printf ("    and Pascal Peter                                 \n");
+printf ("    Dept. of Mathematics and Computer Science        \n");
+printf ("    Saarland University, Saarbruecken, Germany       \n\n");
+printf ("    All rights reserved. Unauthorized usage,         \n");
+printf ("    copying, hiring, and selling prohibited.         \n\n");
+printf ("    Send bug reports to                              \n");
+printf ("    weickert@mia.uni-saarland.de                     \n\n");
+printf ("*****************************************************\n\n");
+
+/* ---- one run per job (interactive mode: exactly one) ---- */
+
+read_options (argc, argv);
+while (next_job ())
+   run_job ();
 
 return(0);
-}
+
+}  /* main */
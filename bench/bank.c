@@ -0,0 +1,151 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+#include "image.h"
+#include "parallel.h"
+#include "gauss.h"
+
+/*--------------------------------------------------------------------------*/
+/*                                                                          */
+/*           BENCHMARK: GAUSSIAN FILTER BANK VS. SEPARATE FILTERS           */
+/*                                                                          */
+/*--------------------------------------------------------------------------*/
+
+/*
+  computes a highpass, differences of Gaussians and a lowpass for 4 and 6
+  scales sigma = 1, 1.6, 2.56, ... once band by band as the former
+  highpass and bandpass of linear_filters did (fresh copies of the image,
+  one gauss_conv per Gaussian, then the difference) and once with
+  gauss_bank; reports both times and the largest difference of the bands.
+  usage: bank [size ...]     (default 512 2048)
+*/
+
+/*--------------------------------------------------------------------------*/
+
+double seconds (void)
+
+/*
+  returns a monotonic time stamp in seconds
+*/
+
+{
+struct timespec  t;   /* time stamp */
+
+clock_gettime (CLOCK_MONOTONIC, &t);
+return (t.tv_sec + 1.0e-9 * t.tv_nsec);
+
+}  /* seconds */
+
+/*--------------------------------------------------------------------------*/
+
+void separate
+
+     (long    n,          /* number of scales */
+      double  *sigma,     /* standard deviations, increasing */
+      image   *u,         /* original image, unchanged */
+      image   **band)     /* n+1 bands, output */
+
+/*
+  bands one by one: band k = G_(k-1) * u - G_k * u, with G_(-1) = identity
+  and G_n = 0
+*/
+
+{
+long    i, j, k;    /* loop variables */
+image   *v, *w;     /* smoothed copies of u */
+
+alloc_image (&v, 1, u->nx, u->ny, 1);
+alloc_image (&w, 1, u->nx, u->ny, 1);
+
+for (k=0; k<=n; k++)
+    {
+    copy_image (u, v);
+    copy_image (u, w);
+    if (k > 0)
+       gauss_conv (sigma[k-1], 0, 3.0, u->nx, u->ny, 1.0, 1.0, v);
+    if (k < n)
+       gauss_conv (sigma[k], 0, 3.0, u->nx, u->ny, 1.0, 1.0, w);
+    for (j=1; j<=u->ny; j++)
+     for (i=1; i<=u->nx; i++)
+         PIX(band[k],i,j) = (k < n) ? PIX(v,i,j) - PIX(w,i,j) : PIX(v,i,j);
+    }
+
+free_image (v);
+free_image (w);
+return;
+
+}  /* separate */
+
+/*--------------------------------------------------------------------------*/
+
+int main (int argc, char **argv)
+
+{
+image   *u;                 /* test image */
+image   *a[7], *b[7];       /* bands: separate, filter bank */
+long    sizes[2] = {512, 2048};   /* default sizes */
+long    scales[2] = {4, 6};       /* numbers of scales */
+double  sigma[6];           /* standard deviations */
+long    count;              /* number of sizes */
+long    nx;                 /* image size in x and y direction */
+long    n;                  /* number of scales */
+long    i, j, k, m, s;      /* loop variables */
+double  t0;                 /* time stamp */
+double  tsep, tbank;        /* timings */
+double  diff;               /* largest difference */
+
+count = (argc > 1) ? argc - 1 : 2;
+for (k=0; k<6; k++)
+    sigma[k] = pow (1.6, (double) k);
+
+printf ("processors: %ld\n\n", parallel_threads ());
+printf ("size    scales  separate [ms]  bank [ms]  speedup  max. diff.\n");
+
+for (m=0; m<count; m++)
+    {
+    nx = (argc > 1) ? atol (argv[m+1]) : sizes[m];
+    alloc_image (&u, 1, nx, nx, 1);
+    for (j=1; j<=nx; j++)
+     for (i=1; i<=nx; i++)
+         PIX(u,i,j) = (double)((i * 7 + j * 13) % 256);
+    for (k=0; k<7; k++)
+        {
+        alloc_image (&a[k], 1, nx, nx, 1);
+        alloc_image (&b[k], 1, nx, nx, 1);
+        }
+
+    for (s=0; s<2; s++)
+        {
+        n = scales[s];
+
+        t0 = seconds ();
+        separate (n, sigma, u, a);
+        tsep = seconds () - t0;
+
+        t0 = seconds ();
+        gauss_bank (n, sigma, 0, 3.0, GAUSS_AUTO, nx, nx, 1.0, 1.0, u, b);
+        tbank = seconds () - t0;
+
+        diff = 0.0;
+        for (k=0; k<=n; k++)
+         for (j=1; j<=nx; j++)
+          for (i=1; i<=nx; i++)
+              diff = fmax (diff, fabs (PIX(a[k],i,j) - PIX(b[k],i,j)));
+
+        printf ("%-6ld  %6ld  %13.1f  %9.1f  %7.2f  %10.3g\n", nx, n,
+                1000.0 * tsep, 1000.0 * tbank, tsep / tbank, diff);
+        }
+
+    free_image (u);
+    for (k=0; k<7; k++)
+        {
+        free_image (a[k]);
+        free_image (b[k]);
+        }
+    }
+
+return (0);
+
+}  /* main */
@@ -0,0 +1,375 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+#include "image.h"
+#include "parallel.h"
+#include "fft.h"
+#include "dct.h"
+#include "quant.h"
+
+#ifndef M_PI
+#define M_PI  3.14159265358979323846
+#endif
+
+/*--------------------------------------------------------------------------*/
+/*                                                                          */
+/*              BENCHMARK: DIRECT VS. FAST DISCRETE COSINE TRANSFORM        */
+/*                                                                          */
+/*--------------------------------------------------------------------------*/
+
+/*
+  times the former DCT_2d of the dct program (one sum with cos() per
+  coefficient and direction, cubic in the image side) and dct2d (Makhoul
+  FFT, cached cosine tables) for increasing sizes, and reports the largest
+  difference of the coefficients and the round trip error of idct2d.
+  Then the same for the 8x8 blocks of the image: the former
+  blockwise_DCT_2d (each block copied into an image and transformed with
+  the former DCT_2d) against dct8x8 on a block on the stack. Finally the
+  quantisation of these blocks: a division and rint per coefficient as
+  in the former jpeg_divide_block / round_block_coeff against the
+  reciprocal table of quantise8x8.
+  usage: dct [size ...]     (default 64 128 256 512)
+*/
+
+/*--------------------------------------------------------------------------*/
+
+double seconds (void)
+
+/*
+  returns a monotonic time stamp in seconds
+*/
+
+{
+struct timespec  t;   /* time stamp */
+
+clock_gettime (CLOCK_MONOTONIC, &t);
+return (t.tv_sec + 1.0e-9 * t.tv_nsec);
+
+}  /* seconds */
+
+/*--------------------------------------------------------------------------*/
+
+void direct_dct
+
+     (image  *u,         /* image, unchanged */
+      image  *c)         /* coefficients, output */
+
+/*
+  former DCT_2d: y direction over whole rows, then x direction
+*/
+
+{
+long    nx = u->nx;        /* image width */
+long    ny = u->ny;        /* image height */
+long    i, j, m, p;        /* loop variables */
+double  w, sum;            /* weight, for summing up */
+double  *tmp;              /* result of the y direction */
+
+tmp = (double *) calloc (nx * ny, sizeof(double));
+if (tmp == NULL)
+   {
+   printf("direct_dct: not enough memory available\n");
+   exit(1);
+   }
+
+for (p=0; p<ny; p++)
+ for (m=0; m<ny; m++)
+     {
+     w = ((p == 0) ? sqrt (1.0 / ny) : sqrt (2.0 / ny))
+         * cos (M_PI / (2.0 * ny) * (2 * m + 1) * p);
+     for (i=0; i<nx; i++)
+         tmp[p*nx+i] += PIX(u,i+1,m+1) * w;
+     }
+
+for (j=0; j<ny; j++)
+ for (p=0; p<nx; p++)
+     {
+     sum = 0.0;
+     for (m=0; m<nx; m++)
+         sum += tmp[j*nx+m] * ((p == 0) ? sqrt (1.0 / nx) : sqrt (2.0 / nx))
+                * cos (M_PI / (2.0 * nx) * (2 * m + 1) * p);
+     PIX(c,p+1,j+1) = sum;
+     }
+
+free (tmp);
+return;
+
+}  /* direct_dct */
+
+/*--------------------------------------------------------------------------*/
+
+void direct_blocks
+
+     (image  *u,         /* image, unchanged */
+      image  *c)         /* coefficients, output */
+
+/*
+  former blockwise_DCT_2d
+*/
+
+{
+long    i, j, k, l;       /* loop variables */
+image   *ub, *cb;         /* 8x8 blocks */
+
+alloc_image (&ub, 1, 8, 8, 1);
+alloc_image (&cb, 1, 8, 8, 1);
+
+for (j=1; j<=u->ny; j+=8)
+ for (i=1; i<=u->nx; i+=8)
+     {
+     for (l=0; l<8; l++)
+      for (k=0; k<8; k++)
+          PIX(ub,k+1,l+1) = PIX(u,i+k,j+l);
+     direct_dct (ub, cb);
+     for (l=0; l<8; l++)
+      for (k=0; k<8; k++)
+          PIX(c,i+k,j+l) = PIX(cb,k+1,l+1);
+     }
+
+free_image (ub);
+free_image (cb);
+return;
+
+}  /* direct_blocks */
+
+/*--------------------------------------------------------------------------*/
+
+void fast_blocks
+
+     (image  *u,         /* image, unchanged */
+      image  *c)         /* coefficients, output */
+
+/*
+  blockwise_DCT_2d with dct8x8
+*/
+
+{
+long    i, j, k, l;       /* loop variables */
+double  b[64];            /* 8x8 block */
+
+for (j=1; j<=u->ny; j+=8)
+ for (i=1; i<=u->nx; i+=8)
+     {
+     for (l=0; l<8; l++)
+      for (k=0; k<8; k++)
+          b[8*l+k] = PIX(u,i+k,j+l);
+     dct8x8 (b);
+     for (l=0; l<8; l++)
+      for (k=0; k<8; k++)
+          PIX(c,i+k,j+l) = b[8*l+k];
+     }
+
+return;
+
+}  /* fast_blocks */
+
+/*--------------------------------------------------------------------------*/
+
+void divide_blocks
+
+     (image   *c,         /* coefficients of the 8x8 blocks, in and out */
+      double  *step)      /* quantisation steps, 64 */
+
+/*
+  former quantisation: divide, round, multiply, one coefficient at a time
+*/
+
+{
+long    i, j, k, l;    /* loop variables */
+double  b[64];         /* block */
+
+for (j=1; j<=c->ny; j+=8)
+ for (i=1; i<=c->nx; i+=8)
+     {
+     for (l=0; l<8; l++)
+      for (k=0; k<8; k++)
+          b[8*l+k] = PIX(c,i+k,j+l);
+     for (k=0; k<64; k++)
+         b[k] = rint (b[k] / step[k]) * step[k];
+     for (l=0; l<8; l++)
+      for (k=0; k<8; k++)
+          PIX(c,i+k,j+l) = b[8*l+k];
+     }
+
+return;
+
+}  /* divide_blocks */
+
+/*--------------------------------------------------------------------------*/
+
+void table_blocks
+
+     (image        *c,    /* coefficients of the 8x8 blocks, in and out */
+      quant_table  *q)    /* quantisation table */
+
+/*
+  quantisation with the reciprocal table
+*/
+
+{
+long    i, j, k, l;    /* loop variables */
+double  b[64];         /* block */
+
+for (j=1; j<=c->ny; j+=8)
+ for (i=1; i<=c->nx; i+=8)
+     {
+     for (l=0; l<8; l++)
+      for (k=0; k<8; k++)
+          b[8*l+k] = PIX(c,i+k,j+l);
+     quantise8x8 (q, b);
+     for (l=0; l<8; l++)
+      for (k=0; k<8; k++)
+          PIX(c,i+k,j+l) = b[8*l+k];
+     }
+
+return;
+
+}  /* table_blocks */
+
+/*--------------------------------------------------------------------------*/
+
+int main (int argc, char **argv)
+
+{
+image        *u, *c, *d;         /* image, direct and fast coefficients */
+quant_table  q;                  /* quantisation table */
+double       base[64];           /* base table */
+long         sizes[4] = {64, 128, 256, 512};   /* default sizes */
+long         count;              /* number of sizes */
+long         n;                  /* image size in x and y direction */
+long         i, j, k, r;         /* loop variables */
+long         reps;               /* number of repetitions */
+long         differ;             /* number of differing coefficients */
+double       t0;                 /* time stamp */
+double       direct, fast;       /* timings */
+double       diff, back;         /* largest differences */
+
+count = (argc > 1) ? argc - 1 : 4;
+
+printf ("processors: %ld\n\n", parallel_threads ());
+printf ("size    direct [ms]  fast [ms]  speedup  max. diff.  round trip\n");
+
+for (k=0; k<count; k++)
+    {
+    n = (argc > 1) ? atol (argv[k+1]) : sizes[k];
+    alloc_image (&u, 1, n, n, 1);
+    alloc_image (&c, 1, n, n, 1);
+    alloc_image (&d, 1, n, n, 1);
+    for (j=1; j<=n; j++)
+     for (i=1; i<=n; i++)
+         PIX(u,i,j) = (double)((i * 7 + j * 13) % 256);
+
+    t0 = seconds ();
+    direct_dct (u, c);
+    direct = seconds () - t0;
+
+    /* first call creates the plans */
+    dct2d (u, d);
+    t0 = seconds ();
+    dct2d (u, d);
+    fast = seconds () - t0;
+
+    diff = 0.0;
+    for (j=1; j<=n; j++)
+     for (i=1; i<=n; i++)
+         diff = fmax (diff, fabs (PIX(c,i,j) - PIX(d,i,j)));
+
+    idct2d (d, d);
+    back = 0.0;
+    for (j=1; j<=n; j++)
+     for (i=1; i<=n; i++)
+         back = fmax (back, fabs (PIX(u,i,j) - PIX(d,i,j)));
+
+    printf ("%-6ld  %11.1f  %9.2f  %7.0f  %10.3g  %10.3g\n", n,
+            1000.0 * direct, 1000.0 * fast, direct / fast, diff, back);
+
+    free_image (u);
+    free_image (c);
+    free_image (d);
+    }
+
+printf ("\nsize    blocks [ms]  dct8x8 [ms]  speedup  max. diff.\n");
+
+for (k=0; k<count; k++)
+    {
+    n = (argc > 1) ? atol (argv[k+1]) : sizes[k];
+    n = (n / 8) * 8;
+    alloc_image (&u, 1, n, n, 1);
+    alloc_image (&c, 1, n, n, 1);
+    alloc_image (&d, 1, n, n, 1);
+    for (j=1; j<=n; j++)
+     for (i=1; i<=n; i++)
+         PIX(u,i,j) = (double)((i * 7 + j * 13) % 256);
+
+    t0 = seconds ();
+    direct_blocks (u, c);
+    direct = seconds () - t0;
+
+    t0 = seconds ();
+    fast_blocks (u, d);
+    fast = seconds () - t0;
+
+    diff = 0.0;
+    for (j=1; j<=n; j++)
+     for (i=1; i<=n; i++)
+         diff = fmax (diff, fabs (PIX(c,i,j) - PIX(d,i,j)));
+
+    printf ("%-6ld  %11.2f  %11.3f  %7.0f  %10.3g\n", n, 1000.0 * direct,
+            1000.0 * fast, direct / fast, diff);
+
+    free_image (u);
+    free_image (c);
+    free_image (d);
+    }
+
+for (k=0; k<64; k++)
+    base[k] = 8.0 + 6.0 * (k % 8 + k / 8);
+quant_table_init (&q, base, 50);
+
+printf ("\nsize    divide [ms]  table [ms]  speedup  differing\n");
+
+for (k=0; k<count; k++)
+    {
+    n    = (argc > 1) ? atol (argv[k+1]) : sizes[k];
+    n    = (n / 8) * 8;
+    reps = 20;
+    alloc_image (&u, 1, n, n, 1);
+    alloc_image (&c, 1, n, n, 1);
+    alloc_image (&d, 1, n, n, 1);
+    for (j=1; j<=n; j++)
+     for (i=1; i<=n; i++)
+         PIX(u,i,j) = (double)((i * 7 + j * 13) % 256);
+    fast_blocks (u, u);
+
+    /* quantisation is idempotent, so repeated runs time the same work */
+    copy_image (u, c);
+    t0 = seconds ();
+    for (r=0; r<reps; r++)
+        divide_blocks (c, q.step);
+    direct = (seconds () - t0) / reps;
+
+    copy_image (u, d);
+    t0 = seconds ();
+    for (r=0; r<reps; r++)
+        table_blocks (d, &q);
+    fast = (seconds () - t0) / reps;
+
+    differ = 0;
+    for (j=1; j<=n; j++)
+     for (i=1; i<=n; i++)
+         if (PIX(c,i,j) != PIX(d,i,j))
+            differ++;
+
+    printf ("%-6ld  %11.3f  %10.3f  %7.2f  %9ld\n", n, 1000.0 * direct,
+            1000.0 * fast, direct / fast, differ);
+
+    free_image (u);
+    free_image (c);
+    free_image (d);
+    }
+
+return (0);
+
+}  /* main */
@@ -0,0 +1,206 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+#include "image.h"
+#include "parallel.h"
+#include "fft.h"
+
+/*--------------------------------------------------------------------------*/
+/*                                                                          */
+/*                 BENCHMARK: COLUMN PASS OF THE 2-D FFT                    */
+/*                                                                          */
+/*--------------------------------------------------------------------------*/
+
+/*
+  compares the former column pass of FT2D (each column gathered into a
+  vector with stride nx, transformed and scattered back) with the blocked
+  column pass of fft_columns (8 columns per cache line gathered into a
+  tile); the row pass is the same for both and timed separately.
+  Also checks that both column passes give identical results.
+  usage: fft2d [size ...]     (default 512 2048 8192)
+*/
+
+/*--------------------------------------------------------------------------*/
+
+typedef struct
+   {
+   image     *ur, *ui;     /* real / imaginary image or Fourier data */
+   fft_plan  *plan;        /* FFT plan for the columns */
+   } column_task;
+
+/*--------------------------------------------------------------------------*/
+
+double seconds (void)
+
+/*
+  returns a monotonic time stamp in seconds
+*/
+
+{
+struct timespec  t;   /* time stamp */
+
+clock_gettime (CLOCK_MONOTONIC, &t);
+return (t.tv_sec + 1.0e-9 * t.tv_nsec);
+
+}  /* seconds */
+
+/*--------------------------------------------------------------------------*/
+
+void gather_columns
+
+     (long  first,       /* first column */
+      long  last,        /* last column */
+      void  *arg)        /* column_task */
+
+/*
+  former column pass of FT2D: one column at a time
+*/
+
+{
+column_task  *t = (column_task *) arg;   /* task */
+long         ny = t->ur->ny;             /* column length */
+long         i, j;                       /* loop variables */
+double       *vr, *vi, *work;            /* column and scratch vector */
+
+vr   = (double *) malloc (ny * sizeof(double));
+vi   = (double *) malloc (ny * sizeof(double));
+work = (double *) malloc (t->plan->scratch * sizeof(double));
+if ((vr == NULL) || (vi == NULL) || (work == NULL))
+   {
+   printf("gather_columns: not enough memory available\n");
+   exit(1);
+   }
+
+for (i=first; i<=last; i++)
+    {
+    for (j=1; j<=ny; j++)
+        {
+        vr[j-1] = PIX(t->ur,i,j);
+        vi[j-1] = PIX(t->ui,i,j);
+        }
+    fft_execute (t->plan, vr, vi, work);
+    for (j=1; j<=ny; j++)
+        {
+        PIX(t->ur,i,j) = vr[j-1];
+        PIX(t->ui,i,j) = vi[j-1];
+        }
+    }
+
+free (vr);
+free (vi);
+free (work);
+return;
+
+}  /* gather_columns */
+
+/*--------------------------------------------------------------------------*/
+
+void fill
+
+     (image  *ur,        /* real part, output */
+      image  *ui)        /* imaginary part, output */
+
+/*
+  test pattern
+*/
+
+{
+long  i, j;    /* loop variables */
+
+for (j=1; j<=ur->ny; j++)
+ for (i=1; i<=ur->nx; i++)
+     {
+     PIX(ur,i,j) = (double)((i * 7 + j * 13) % 256);
+     PIX(ui,i,j) = 0.0;
+     }
+
+return;
+
+}  /* fill */
+
+/*--------------------------------------------------------------------------*/
+
+int main (int argc, char **argv)
+
+{
+image        *ur, *ui;          /* blocked column pass */
+image        *vr, *vi;          /* former column pass */
+column_task  t;                 /* task */
+long         sizes[3] = {512, 2048, 8192};   /* default sizes */
+long         count;             /* number of sizes */
+long         n;                 /* image size in x and y direction */
+long         reps;              /* number of repetitions */
+long         i, j, k, r;        /* loop variables */
+double       t0;                /* time stamp */
+double       rows, old, blocked; /* timings */
+double       diff;              /* largest difference */
+
+count = (argc > 1) ? argc - 1 : 3;
+
+printf ("processors: %ld\n\n", parallel_threads ());
+printf ("size    rows [ms]  columns [ms]  blocked [ms]  speedup  "
+        "2-D speedup  max. diff.\n");
+
+for (k=0; k<count; k++)
+    {
+    n    = (argc > 1) ? atol (argv[k+1]) : sizes[k];
+    reps = (n <= 1024) ? 20 : ((n <= 4096) ? 3 : 1);
+
+    alloc_image (&ur, 1, n, n, 1);
+    alloc_image (&ui, 1, n, n, 1);
+    alloc_image (&vr, 1, n, n, 1);
+    alloc_image (&vi, 1, n, n, 1);
+    fill (ur, ui);
+    fill (vr, vi);
+    t.ur   = vr;
+    t.ui   = vi;
+    t.plan = fft_plan_cached (n);
+
+    /* warm up plans and thread pool */
+    fft_rows (ur, ui);
+    fft_columns (ur, ui);
+    parallel_rows (1, n, gather_columns, &t);
+
+    t0 = seconds ();
+    for (r=0; r<reps; r++)
+        fft_rows (ur, ui);
+    rows = (seconds () - t0) / reps;
+
+    t0 = seconds ();
+    for (r=0; r<reps; r++)
+        parallel_rows (1, n, gather_columns, &t);
+    old = (seconds () - t0) / reps;
+
+    t0 = seconds ();
+    for (r=0; r<reps; r++)
+        fft_columns (ur, ui);
+    blocked = (seconds () - t0) / reps;
+
+    /* same input, one pass each: results must agree */
+    fill (ur, ui);
+    fill (vr, vi);
+    fft_columns (ur, ui);
+    parallel_rows (1, n, gather_columns, &t);
+    diff = 0.0;
+    for (j=1; j<=n; j++)
+     for (i=1; i<=n; i++)
+         {
+         diff = fmax (diff, fabs (PIX(ur,i,j) - PIX(vr,i,j)));
+         diff = fmax (diff, fabs (PIX(ui,i,j) - PIX(vi,i,j)));
+         }
+
+    printf ("%-6ld  %9.2f  %12.2f  %12.2f  %7.2f  %11.2f  %10.3g\n",
+            n, 1000.0 * rows, 1000.0 * old, 1000.0 * blocked,
+            old / blocked, (rows + old) / (rows + blocked), diff);
+
+    free_image (ur);
+    free_image (ui);
+    free_image (vr);
+    free_image (vi);
+    }
+
+return (0);
+
+}  /* main */
@@ -0,0 +1,57 @@
+#!/bin/bash
+# Regression check of the float pixel mode: builds every program once with
+# double and once with float pixels (-DIMAGE_FLOAT), runs the same jobs with
+# both and compares the 8-bit outputs with pnmdiff (tolerance +-1).
+# usage: bench/float_check.sh [work directory]     (run from the repo root)
+set -e
+root=$(pwd)
+work=${1:-/tmp/float_check}
+common="$root/common/*.c"
+mkdir -p "$work/double" "$work/float"
+
+for mode in double float
+do
+    flags="-Wall -O2 -I$root/common"
+    [ $mode = float ] && flags="$flags -DIMAGE_FLOAT"
+    out="$work/$mode"
+    gcc $flags -o $out/quantisation $root/Ex01/Program_problem/quantisation.c $common -lm -pthread
+    gcc $flags -o $out/YCbCr $root/Ex02/Program_problem/YCbCr.c $common -lm -pthread
+    gcc $flags -o $out/DFT $root/Ex03/Program_Problem/DFT.c $common -lm -pthread
+    gcc $flags -o $out/dct "$root/Ex04/Program Problem/dct.c" $common -lm -pthread
+    gcc $flags -o $out/pointtrans "$root/Ex05/Program Problem/pointtrans.c" $common -lm -pthread
+    gcc $flags -o $out/linear_filters "$root/Ex06/Program Problem/linear_filters.c" $common -lm -pthread
+
+    cp $root/Ex01/Program_problem/boat.pgm $root/Ex02/Program_problem/kodim23.ppm \
+       $root/Ex03/Program_Problem/*.pgm "$root/Ex04/Program Problem/boats.pgm" \
+       "$root/Ex05/Program Problem/"*.pgm "$root/Ex06/Program Problem/"*.pgm $out
+    cd $out
+    ./quantisation boat.pgm 1 1 q1.out.pgm boat.pgm 3 1 q3.out.pgm > /dev/null
+    ./YCbCr kodim23.ppm 1 ycc1.out.ppm kodim23.ppm 2 ycc2.out.ppm \
+            kodim23.ppm 4 ycc4.out.ppm kodim23.ppm 8 ycc8.out.ppm > /dev/null
+    ./DFT fire.pgm fire.spec.out.pgm fire.back.out.pgm 1 \
+          smoke.pgm smoke.spec.out.pgm smoke.back.out.pgm 0 \
+          fire.pgm lp.spec.out.pgm lp.back.out.pgm lowpass butterworth 2 30 > /dev/null
+    for m in 1 2 3 4 5 6
+    do
+        ./dct boats.pgm dct$m.spec.out.pgm dct$m.out.pgm $m > /dev/null
+    done
+    ./pointtrans machine.pgm 0 20 220 pt0.out.pgm asbest.pgm 1 2.1 pt1.out.pgm \
+                 office.pgm 2 pt2.out.pgm > /dev/null
+    ./linear_filters leopard.pgm 0 0 2.5 lf0.out.pgm tile.pgm 1 0 2 lf1.out.pgm \
+                     angiogram.pgm 2 0 4 1.5 lf2.out.pgm \
+                     angiogram.pgm 0 0 12 lf3.out.pgm > /dev/null
+    cd $root
+done
+
+gcc -Wall -O2 -I$root/common -o $work/pnmdiff $root/bench/pnmdiff.c \
+    $root/common/image.c $root/common/parallel.c -lm -pthread
+
+# every output, including the quantising DCT modes 5 and 6, must agree
+# within one grey value
+status=0
+cd $work
+for f in $(cd double && ls *.out.p?m)
+do
+    ./pnmdiff double/$f float/$f 1 || status=1
+done
+exit $status
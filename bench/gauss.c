@@ -0,0 +1,177 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+#include "image.h"
+#include "parallel.h"
+#include "gauss.h"
+
+/*--------------------------------------------------------------------------*/
+/*                                                                          */
+/*              BENCHMARK: DIRECT VS. FOURIER GAUSSIAN CONVOLUTION          */
+/*                                                                          */
+/*--------------------------------------------------------------------------*/
+
+/*
+  times gauss_conv_direct (truncation at 3 sigma), gauss_conv_fft and
+  gauss_conv_recursive for increasing sigma and reports the accuracy of
+  the Fourier and the recursive result against the direct one (largest
+  and root mean square difference in grey values of the 0..255 test
+  image), and the crossover, i.e. the smallest sigma for which the
+  Fourier domain is faster than the direct convolution, together with
+  the ratio (3 sigma + 1) / log2 (2n) that GAUSS_FFT_RATIO in gauss.h is
+  taken from.
+  usage: gauss [size ...]     (default 512 2048 4096)
+*/
+
+/*--------------------------------------------------------------------------*/
+
+double seconds (void)
+
+/*
+  returns a monotonic time stamp in seconds
+*/
+
+{
+struct timespec  t;   /* time stamp */
+
+clock_gettime (CLOCK_MONOTONIC, &t);
+return (t.tv_sec + 1.0e-9 * t.tv_nsec);
+
+}  /* seconds */
+
+/*--------------------------------------------------------------------------*/
+
+void fill
+
+     (image  *u)         /* image, output */
+
+/*
+  test pattern
+*/
+
+{
+long  i, j;    /* loop variables */
+
+for (j=1; j<=u->ny; j++)
+ for (i=1; i<=u->nx; i++)
+     PIX(u,i,j) = (double)((i * 7 + j * 13) % 256);
+
+return;
+
+}  /* fill */
+
+/*--------------------------------------------------------------------------*/
+
+void compare
+
+     (image   *u,         /* reference */
+      image   *v,         /* result */
+      double  *max,       /* largest difference, output */
+      double  *rms)       /* root mean square difference, output */
+
+/*
+  differences between two images
+*/
+
+{
+long    i, j;    /* loop variables */
+double  d;       /* difference */
+
+*max = 0.0;
+*rms = 0.0;
+for (j=1; j<=u->ny; j++)
+ for (i=1; i<=u->nx; i++)
+     {
+     d    = fabs (PIX(u,i,j) - PIX(v,i,j));
+     *max = fmax (*max, d);
+     *rms = *rms + d * d;
+     }
+*rms = sqrt (*rms / (u->nx * u->ny));
+
+return;
+
+}  /* compare */
+
+/*--------------------------------------------------------------------------*/
+
+int main (int argc, char **argv)
+
+{
+image   *u, *v, *w;         /* direct, Fourier and recursive result */
+long    sizes[3] = {512, 2048, 4096};   /* default sizes */
+double  sigmas[12] = {1.0, 2.0, 3.0, 5.0, 8.0, 12.0, 20.0, 30.0, 50.0,
+                      80.0, 120.0, 200.0};
+long    count;              /* number of sizes */
+long    n;                  /* image size in x and y direction */
+long    k, s;               /* loop variables */
+double  t0;                 /* time stamp */
+double  direct, fourier;    /* timings */
+double  recursive;          /* timing */
+double  fmax_, frms;        /* difference Fourier - direct */
+double  rmax, rrms;         /* difference recursive - direct */
+double  cross;              /* crossover sigma */
+
+count = (argc > 1) ? argc - 1 : 3;
+
+printf ("processors: %ld\n\n", parallel_threads ());
+printf ("                 time [ms]                  Fourier - direct  "
+        "recursive - direct\n");
+printf ("size    sigma   direct  Fourier  recursive      max      rms  "
+        "     max      rms\n");
+
+for (k=0; k<count; k++)
+    {
+    n = (argc > 1) ? atol (argv[k+1]) : sizes[k];
+    alloc_image (&u, 1, n, n, 1);
+    alloc_image (&v, 1, n, n, 1);
+    alloc_image (&w, 1, n, n, 1);
+    cross = 0.0;
+
+    for (s=0; s<12; s++)
+        {
+        fill (u);
+        t0 = seconds ();
+        gauss_conv_direct (sigmas[s], 0, 3.0, n, n, 1.0, 1.0, u);
+        direct = seconds () - t0;
+
+        /* first call creates the FFT plan */
+        fill (v);
+        gauss_conv_fft (sigmas[s], 0, n, n, 1.0, 1.0, v);
+        fill (v);
+        t0 = seconds ();
+        gauss_conv_fft (sigmas[s], 0, n, n, 1.0, 1.0, v);
+        fourier = seconds () - t0;
+
+        fill (w);
+        t0 = seconds ();
+        gauss_conv_recursive (sigmas[s], 0, n, n, 1.0, 1.0, w);
+        recursive = seconds () - t0;
+
+        compare (u, v, &fmax_, &frms);
+        compare (u, w, &rmax, &rrms);
+
+        if ((cross == 0.0) && (fourier < direct))
+           cross = sigmas[s];
+
+        printf ("%-6ld  %5.1f  %7.1f  %7.1f  %9.1f  %7.4f  %7.4f  "
+                "%8.4f  %7.4f\n", n, sigmas[s], 1000.0 * direct,
+                1000.0 * fourier, 1000.0 * recursive, fmax_, frms,
+                rmax, rrms);
+        }
+
+    if (cross > 0.0)
+       printf ("crossover for %ld: sigma = %.1f, ratio = %.2f\n\n", n,
+               cross, (3.0 * cross + 1.0) / log2 (2.0 * n));
+    else
+       printf ("crossover for %ld: beyond sigma = 200\n\n", n);
+
+    free_image (u);
+    free_image (v);
+    free_image (w);
+    }
+
+return (0);
+
+}  /* main */
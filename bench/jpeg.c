@@ -0,0 +1,112 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+#include "image.h"
+#include "parallel.h"
+#include "quant.h"
+#include "jpeg.h"
+
+/*--------------------------------------------------------------------------*/
+/*                                                                          */
+/*             BENCHMARK: RATE AND DISTORTION OF BASELINE JPEG              */
+/*                                                                          */
+/*--------------------------------------------------------------------------*/
+
+/*
+  encodes a greyscale image with jpeg_encode for a range of IJG quality
+  factors (example luminance table of the standard), decodes the file
+  with jpeg_decode and reports the file size, the bits per pixel, the
+  PSNR of the decoded image and the times for encoding and decoding
+  (best of the repetitions, including the file access).
+  The file jpeg_bench.jpg in the current directory is overwritten and
+  removed.
+  usage: jpeg image.pgm [repetitions]     (default 5)
+*/
+
+/*--------------------------------------------------------------------------*/
+
+double seconds (void)
+
+/*
+  returns a monotonic time stamp in seconds
+*/
+
+{
+struct timespec  t;   /* time stamp */
+
+clock_gettime (CLOCK_MONOTONIC, &t);
+return (t.tv_sec + 1.0e-9 * t.tv_nsec);
+
+}  /* seconds */
+
+/*--------------------------------------------------------------------------*/
+
+int main (int argc, char **argv)
+
+{
+image        *u, *v;             /* original and decoded image */
+quant_table  q;                  /* quantisation table */
+long         quality[9] = {5, 10, 20, 30, 50, 75, 90, 95, 100};
+long         reps;               /* number of repetitions */
+long         bytes;              /* file size */
+long         i, j, k, r;         /* loop variables */
+double       t0;                 /* time stamp */
+double       enc, dec;           /* best timings */
+double       mse;                /* mean squared error */
+double       mpix;               /* million pixels */
+char         *file = "jpeg_bench.jpg";   /* JPEG file */
+
+if (argc < 2)
+   {
+   printf ("usage: jpeg image.pgm [repetitions]\n");
+   return (1);
+   }
+reps = (argc > 2) ? atol (argv[2]) : 5;
+
+read_pgm_to_double (argv[1], 1, &u);
+mpix = 1.0e-6 * u->nx * u->ny;
+
+printf ("processors: %ld, image %ld x %ld\n\n", parallel_threads (),
+        u->nx, u->ny);
+printf ("quality    bytes  bits/pixel  PSNR [dB]  encode [ms]  "
+        "decode [ms]  encode [MP/s]  decode [MP/s]\n");
+
+for (k=0; k<9; k++)
+    {
+    quant_table_init (&q, jpeg_luminance, quality[k]);
+    enc = dec = 1.0e30;
+    bytes = 0;
+    v = NULL;
+    for (r=0; r<reps; r++)
+        {
+        t0    = seconds ();
+        bytes = jpeg_encode (u, &q, file);
+        enc   = fmin (enc, seconds () - t0);
+
+        if (v != NULL)
+           free_image (v);
+        t0  = seconds ();
+        jpeg_decode (file, 1, &v);
+        dec = fmin (dec, seconds () - t0);
+        }
+
+    mse = 0.0;
+    for (j=1; j<=u->ny; j++)
+     for (i=1; i<=u->nx; i++)
+         mse = mse + (PIX(u,i,j) - PIX(v,i,j)) * (PIX(u,i,j) - PIX(v,i,j));
+    mse = mse / (u->nx * u->ny);
+
+    printf ("%7ld  %7ld  %10.3f  %9.2f  %11.2f  %11.2f  %13.1f  %13.1f\n",
+            quality[k], bytes, 8.0 * bytes / (u->nx * u->ny),
+            10.0 * log10 (255.0 * 255.0 / fmax (mse, 1.0e-12)),
+            1000.0 * enc, 1000.0 * dec, mpix / enc, mpix / dec);
+    free_image (v);
+    }
+
+remove (file);
+free_image (u);
+return (0);
+
+}  /* main */
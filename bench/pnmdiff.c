@@ -0,0 +1,67 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "image.h"
+
+/*--------------------------------------------------------------------------*/
+/*                                                                          */
+/*                 REGRESSION: DIFFERENCE OF TWO PGM/PPM FILES              */
+/*                                                                          */
+/*--------------------------------------------------------------------------*/
+
+/*
+  compares two 8-bit pgm or ppm images sample by sample and prints the
+  number of differing samples and the largest difference; the exit status
+  is 1 if the largest difference exceeds the tolerance or the images
+  differ in size, 0 otherwise. Used by float_check.sh to compare the
+  outputs of the float and the double build.
+  usage: pnmdiff file1 file2 [tolerance]     (default 0)
+*/
+
+/*--------------------------------------------------------------------------*/
+
+int main (int argc, char **argv)
+
+{
+image   *u, *v;       /* images */
+long    i, j, m;      /* loop variables */
+long    count;        /* number of differing samples */
+double  tol;          /* tolerated difference */
+double  d, max;       /* difference, largest difference */
+
+if (argc < 3)
+   {
+   printf ("usage: pnmdiff file1 file2 [tolerance]\n");
+   return (1);
+   }
+tol = (argc > 3) ? atof (argv[3]) : 0.0;
+
+read_pgm_or_ppm_to_double (argv[1], 0, &u);
+read_pgm_or_ppm_to_double (argv[2], 0, &v);
+if ((u->nc != v->nc) || (u->nx != v->nx) || (u->ny != v->ny))
+   {
+   printf ("%-28s size differs\n", argv[2]);
+   return (1);
+   }
+
+count = 0;
+max   = 0.0;
+for (m=0; m<u->nc; m++)
+ for (j=0; j<u->ny; j++)
+  for (i=0; i<u->nx; i++)
+      {
+      d = fabs (CPIX(u,m,i,j) - CPIX(v,m,i,j));
+      if (d > 0.0)
+         count++;
+      max = fmax (max, d);
+      }
+
+printf ("%-26s %8ld differing, max. %3.0f%s\n", argv[2], count, max,
+        (max > tol) ? "  exceeds tolerance" : "");
+
+free_image (u);
+free_image (v);
+return ((max > tol) ? 1 : 0);
+
+}  /* main */
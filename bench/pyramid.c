@@ -0,0 +1,132 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+#include "image.h"
+#include "parallel.h"
+#include "gauss.h"
+#include "pyramid.h"
+
+/*--------------------------------------------------------------------------*/
+/*                                                                          */
+/*        BENCHMARK: SCALE-SPACE PYRAMID VS. REPEATED FULL LOWPASSES        */
+/*                                                                          */
+/*--------------------------------------------------------------------------*/
+
+/*
+  builds the scales sigma0 * 2^(o + s/3), sigma0 = 1.6, of 4 octaves once
+  as the lowpass of linear_filters did (a fresh copy of the image at full
+  resolution and one gauss_conv with the whole sigma per level) and once
+  with build_pyramid (incremental sigma, decimation after every octave);
+  reports both times and the largest difference between each pyramid
+  level and the full resolution result sampled on its grid, inside
+  (more than 4 sigma away from the boundary) and near the boundary,
+  where the mirror axis of a subsampled grid lies further out than the
+  one of the input.
+  usage: pyramid [size ...]     (default 512 2048)
+*/
+
+/*--------------------------------------------------------------------------*/
+
+double seconds (void)
+
+/*
+  returns a monotonic time stamp in seconds
+*/
+
+{
+struct timespec  t;   /* time stamp */
+
+clock_gettime (CLOCK_MONOTONIC, &t);
+return (t.tv_sec + 1.0e-9 * t.tv_nsec);
+
+}  /* seconds */
+
+/*--------------------------------------------------------------------------*/
+
+int main (int argc, char **argv)
+
+{
+image    *u;                 /* test image */
+image    **v;                /* full resolution levels */
+pyramid  *p;                 /* pyramid */
+long     sizes[2] = {512, 2048};   /* default sizes */
+long     count;              /* number of sizes */
+long     nx;                 /* image size in x and y direction */
+long     d;                  /* sampling distance of a level */
+long     b;                  /* width of the boundary zone of a level */
+long     i, j, k, m;         /* loop variables */
+double   t0;                 /* time stamp */
+double   tfull, tpyr;        /* timings */
+double   diff, bdiff;        /* largest difference inside, near boundary */
+double   e;                  /* difference */
+
+count = (argc > 1) ? argc - 1 : 2;
+
+printf ("processors: %ld\n\n", parallel_threads ());
+printf ("                                                  max. diff.\n");
+printf ("size    levels  full [ms]  pyramid [ms]  speedup  inside  boundary\n");
+
+for (m=0; m<count; m++)
+    {
+    nx = (argc > 1) ? atol (argv[m+1]) : sizes[m];
+    alloc_image (&u, 1, nx, nx, 1);
+    for (j=1; j<=nx; j++)
+     for (i=1; i<=nx; i++)
+         PIX(u,i,j) = (double)((i * 7 + j * 13) % 256);
+    alloc_pyramid (&p, nx, nx, 4, 3, 1.6);
+    v = (image **) malloc (p->levels * sizeof(image *));
+    if (v == NULL)
+       {
+       printf("pyramid: not enough memory available\n");
+       exit(1);
+       }
+    for (k=0; k<p->levels; k++)
+        alloc_image (&v[k], 1, nx, nx, 1);
+
+    t0 = seconds ();
+    for (k=0; k<p->levels; k++)
+        {
+        copy_image (u, v[k]);
+        gauss_conv (p->sigma[k], 0, 3.0, nx, nx, 1.0, 1.0, v[k]);
+        }
+    tfull = seconds () - t0;
+
+    t0 = seconds ();
+    build_pyramid (p, 0, 3.0, GAUSS_AUTO, u);
+    tpyr = seconds () - t0;
+
+    diff  = 0.0;
+    bdiff = 0.0;
+    for (k=0; k<p->levels; k++)
+        {
+        d = (long) p->h[k];
+        b = (long)(4.0 * p->sigma[k] / d) + 1;
+        for (j=1; j<=p->level[k].ny; j++)
+         for (i=1; i<=p->level[k].nx; i++)
+             {
+             e = fabs (PIX(&p->level[k],i,j)
+                       - PIX(v[k],d*(i-1)+1,d*(j-1)+1));
+             if ((i > b) && (i <= p->level[k].nx - b) &&
+                 (j > b) && (j <= p->level[k].ny - b))
+                diff = fmax (diff, e);
+             else
+                bdiff = fmax (bdiff, e);
+             }
+        }
+
+    printf ("%-6ld  %6ld  %9.1f  %12.1f  %7.2f  %6.3f  %8.3f\n", nx,
+            p->levels, 1000.0 * tfull, 1000.0 * tpyr, tfull / tpyr, diff,
+            bdiff);
+
+    for (k=0; k<p->levels; k++)
+        free_image (v[k]);
+    free (v);
+    free_pyramid (p);
+    free_image (u);
+    }
+
+return (0);
+
+}  /* main */
@@ -0,0 +1,257 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+#include "image.h"
+#include "parallel.h"
+
+/*--------------------------------------------------------------------------*/
+/*                                                                          */
+/*                    BENCHMARK: ROW-PARALLEL SCALING                       */
+/*                                                                          */
+/*--------------------------------------------------------------------------*/
+
+/*
+  runs typical per-pixel loops (quantisation, RGB to YCbCr conversion,
+  logarithmic spectrum, image statistics) through the row-parallel engine
+  with 1, 2, 4, ... threads and reports time, speedup and parallel
+  efficiency relative to one thread.
+  usage: scaling [size] [max. threads] [repetitions]
+*/
+
+/*--------------------------------------------------------------------------*/
+
+typedef struct
+   {
+   image   *u;           /* input image */
+   image   *v;           /* output image */
+   } bench_task;
+
+/*--------------------------------------------------------------------------*/
+
+double seconds (void)
+
+/*
+  returns a monotonic time stamp in seconds
+*/
+
+{
+struct timespec  t;   /* time stamp */
+
+clock_gettime (CLOCK_MONOTONIC, &t);
+return (t.tv_sec + 1.0e-9 * t.tv_nsec);
+
+}  /* seconds */
+
+/*--------------------------------------------------------------------------*/
+
+void quantise_rows
+
+     (long  first,       /* first row */
+      long  last,        /* last row */
+      void  *arg)        /* bench_task */
+
+/*
+  quantisation with 3 bits as in Ex01
+*/
+
+{
+bench_task  *t = (bench_task *) arg;   /* task */
+long        i, j;                      /* loop variables */
+
+for (j=first; j<=last; j++)
+ for (i=1; i<=t->u->nx; i++)
+     PIX(t->v,i,j) = ((int)(PIX(t->u,i,j) / 32.0) + 0.5) * 32.0;
+
+return;
+
+}  /* quantise_rows */
+
+/*--------------------------------------------------------------------------*/
+
+void colour_rows
+
+     (long  first,       /* first row */
+      long  last,        /* last row */
+      void  *arg)        /* bench_task */
+
+/*
+  RGB to YCbCr conversion as in Ex02
+*/
+
+{
+bench_task  *t = (bench_task *) arg;   /* task */
+image       *u = t->u;                 /* RGB image */
+image       *v = t->v;                 /* YCbCr image */
+long        i, j;                      /* loop variables */
+
+for (j=first; j<=last; j++)
+ for (i=1; i<=u->nx; i++)
+     {
+     CPIX(v,0,i,j) =  .2990 * CPIX(u,0,i,j) +  .5870 * CPIX(u,1,i,j)
+                   +  .1140 * CPIX(u,2,i,j);
+     CPIX(v,1,i,j) = -.1687 * CPIX(u,0,i,j) + -.3313 * CPIX(u,1,i,j)
+                   +  .5000 * CPIX(u,2,i,j) + 127.5;
+     CPIX(v,2,i,j) =  .5000 * CPIX(u,0,i,j) + -.4187 * CPIX(u,1,i,j)
+                   + -.0813 * CPIX(u,2,i,j) + 127.5;
+     }
+
+return;
+
+}  /* colour_rows */
+
+/*--------------------------------------------------------------------------*/
+
+void spectrum_rows
+
+     (long  first,       /* first row */
+      long  last,        /* last row */
+      void  *arg)        /* bench_task */
+
+/*
+  logarithmic spectrum as in Ex03 (channels 0 and 1: real and imaginary
+  part)
+*/
+
+{
+bench_task  *t = (bench_task *) arg;   /* task */
+image       *u = t->u;                 /* Fourier data */
+long        i, j;                      /* loop variables */
+
+for (j=first; j<=last; j++)
+ for (i=1; i<=u->nx; i++)
+     PIX(t->v,i,j) = log (1.0 + sqrt (CPIX(u,0,i,j) * CPIX(u,0,i,j)
+                                    + CPIX(u,1,i,j) * CPIX(u,1,i,j)));
+
+return;
+
+}  /* spectrum_rows */
+
+/*--------------------------------------------------------------------------*/
+
+void statistics_rows
+
+     (long  first,       /* first row */
+      long  last,        /* last row */
+      void  *arg)        /* bench_task */
+
+/*
+  image statistics; the parallel work is done inside analyse_grey_double,
+  this kernel is only called once
+*/
+
+{
+bench_task  *t = (bench_task *) arg;   /* task */
+double      min, max, mean, std;       /* statistics */
+
+analyse_grey_double (t->u, &min, &max, &mean, &std);
+PIX(t->v,1,1) = mean + std + min + max;
+
+return;
+
+}  /* statistics_rows */
+
+/*--------------------------------------------------------------------------*/
+
+double run
+
+     (row_kernel  kernel,   /* kernel */
+      long        rows,     /* number of rows, 0: call kernel directly */
+      bench_task  *t,       /* task */
+      long        reps)     /* number of repetitions */
+
+/*
+  returns the average time of one run of kernel over all rows
+*/
+
+{
+long    r;       /* loop variable */
+double  t0;      /* time stamp */
+
+/* warm up thread pool and caches */
+if (rows > 0)
+   parallel_rows (1, rows, kernel, t);
+else
+   kernel (1, 1, t);
+
+t0 = seconds ();
+for (r=0; r<reps; r++)
+    if (rows > 0)
+       parallel_rows (1, rows, kernel, t);
+    else
+       kernel (1, 1, t);
+
+return ((seconds () - t0) / reps);
+
+}  /* run */
+
+/*--------------------------------------------------------------------------*/
+
+int main (int argc, char **argv)
+
+{
+image       *grey, *colour, *out;  /* test images */
+bench_task  t;                     /* task */
+long        n;                     /* image size in x and y direction */
+long        max_threads;           /* largest number of threads */
+long        reps;                  /* number of repetitions */
+long        threads;               /* current number of threads */
+long        i, j, k;               /* loop variables */
+double      time[4], base[4];      /* timings */
+const char  *name[4] = {"quantise", "YCbCr", "log spectrum", "statistics"};
+
+n           = (argc > 1) ? atol (argv[1]) : 4096;
+max_threads = (argc > 2) ? atol (argv[2]) : parallel_threads ();
+reps        = (argc > 3) ? atol (argv[3]) : 5;
+
+alloc_image (&grey, 1, n, n, 1);
+alloc_image (&colour, 3, n, n, 1);
+alloc_image (&out, 3, n, n, 1);
+for (j=1; j<=n; j++)
+ for (i=1; i<=n; i++)
+     {
+     PIX(grey,i,j)      = (double)((i * 7 + j * 13) % 256);
+     CPIX(colour,0,i,j) = (double)((i * 3 + j) % 256);
+     CPIX(colour,1,i,j) = (double)((i + j * 5) % 256);
+     CPIX(colour,2,i,j) = (double)((i * 11 + j * 2) % 256);
+     }
+
+printf ("image size: %ld x %ld, processors: %ld\n\n", n, n,
+        parallel_threads ());
+printf ("threads  kernel          time [ms]  speedup  efficiency\n");
+
+threads = 1;
+for (;;)
+    {
+    parallel_init (threads);
+
+    t.u = grey;    t.v = out;
+    time[0] = run (quantise_rows, n, &t, reps);
+    t.u = colour;  t.v = out;
+    time[1] = run (colour_rows, n, &t, reps);
+    t.u = colour;  t.v = out;
+    time[2] = run (spectrum_rows, n, &t, reps);
+    t.u = grey;    t.v = out;
+    time[3] = run (statistics_rows, 0, &t, reps);
+
+    for (k=0; k<4; k++)
+        {
+        if (threads == 1)
+           base[k] = time[k];
+        printf ("%7ld  %-14s %10.2lf %8.2lf %10.2lf\n", threads, name[k],
+                1000.0 * time[k], base[k] / time[k],
+                base[k] / time[k] / threads);
+        }
+
+    if (threads >= max_threads)
+       break;
+    threads = (2 * threads < max_threads) ? 2 * threads : max_threads;
+    }
+
+free_image (grey);
+free_image (colour);
+free_image (out);
+
+return (0);
+}
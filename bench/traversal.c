@@ -0,0 +1,135 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+#include "image.h"
+
+/*--------------------------------------------------------------------------*/
+/*                                                                          */
+/*                     BENCHMARK: PIXEL TRAVERSAL ORDER                     */
+/*                                                                          */
+/*--------------------------------------------------------------------------*/
+
+/*
+  compares a sweep that walks the row-major image container along x
+  (j outside, i inside) with the former column order (i outside,
+  j inside) on images larger than the L2 cache.
+  usage: traversal [size] [repetitions]
+*/
+
+/*--------------------------------------------------------------------------*/
+
+double seconds (void)
+
+/*
+  returns a monotonic time stamp in seconds
+*/
+
+{
+struct timespec  t;   /* time stamp */
+
+clock_gettime (CLOCK_MONOTONIC, &t);
+return (t.tv_sec + 1.0e-9 * t.tv_nsec);
+
+}  /* seconds */
+
+/*--------------------------------------------------------------------------*/
+
+double sweep_rows
+
+     (image   *u,         /* image, changed */
+      double  d)          /* quantisation step */
+
+/*
+  quantises u and returns the sum of all grey values;
+  walks memory with unit stride
+*/
+
+{
+long    i, j;      /* loop variables */
+double  sum;       /* sum of grey values */
+
+sum = 0.0;
+for (j=1; j<=u->ny; j++)
+ for (i=1; i<=u->nx; i++)
+     {
+     PIX(u,i,j) = ((int)(PIX(u,i,j) / d) + 0.5) * d;
+     sum = sum + PIX(u,i,j);
+     }
+
+return (sum);
+
+}  /* sweep_rows */
+
+/*--------------------------------------------------------------------------*/
+
+double sweep_columns
+
+     (image   *u,         /* image, changed */
+      double  d)          /* quantisation step */
+
+/*
+  same as sweep_rows, but in the loop order used before the
+  container became row-major
+*/
+
+{
+long    i, j;      /* loop variables */
+double  sum;       /* sum of grey values */
+
+sum = 0.0;
+for (i=1; i<=u->nx; i++)
+ for (j=1; j<=u->ny; j++)
+     {
+     PIX(u,i,j) = ((int)(PIX(u,i,j) / d) + 0.5) * d;
+     sum = sum + PIX(u,i,j);
+     }
+
+return (sum);
+
+}  /* sweep_columns */
+
+/*--------------------------------------------------------------------------*/
+
+int main (int argc, char **argv)
+
+{
+image   *u;                   /* test image */
+long    n;                    /* image size in x and y direction */
+long    reps;                 /* number of repetitions */
+long    i, j, r;              /* loop variables */
+double  t0, t_rows, t_cols;   /* timings */
+double  check;                /* keeps the sweeps from being optimised away */
+
+n    = (argc > 1) ? atol (argv[1]) : 4096;
+reps = (argc > 2) ? atol (argv[2]) : 5;
+
+alloc_image (&u, 1, n, n, 1);
+for (j=1; j<=n; j++)
+ for (i=1; i<=n; i++)
+     PIX(u,i,j) = (double)((i * 7 + j * 13) % 256);
+
+check = 0.0;
+
+t0 = seconds ();
+for (r=0; r<reps; r++)
+    check = check + sweep_rows (u, 2.0);
+t_rows = (seconds () - t0) / reps;
+
+t0 = seconds ();
+for (r=0; r<reps; r++)
+    check = check + sweep_columns (u, 2.0);
+t_cols = (seconds () - t0) / reps;
+
+printf ("image size:         %ld x %ld (%.1lf MB)\n", n, n,
+        (double)(u->plane * sizeof(double)) / (1024.0 * 1024.0));
+printf ("row order (i inner):    %8.2lf ms\n", 1000.0 * t_rows);
+printf ("column order (j inner): %8.2lf ms\n", 1000.0 * t_cols);
+printf ("speedup:                %8.2lf\n", t_cols / t_rows);
+printf ("(checksum %g)\n", check);
+
+free_image (u);
+
+return (0);
+}
@@ -0,0 +1,317 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "image.h"
+#include "cli.h"
+#include "parallel.h"
+
+/*--------------------------------------------------------------------------*/
+/*                                                                          */
+/*                     PARAMETER INPUT AND BATCH MODE                       */
+/*                                                                          */
+/*--------------------------------------------------------------------------*/
+
+/*
+  answers to the parameter prompts, either from stdin (interactive mode)
+  or from the command line and job files (batch mode)
+*/
+
+/*--------------------------------------------------------------------------*/
+
+#define CLI_LENGTH  80    /* length of the string buffers of all programs */
+
+static long  batch    = 0;       /* batch mode? */
+static long  jobs     = 0;       /* number of jobs started */
+static long  n_fields = 0;       /* number of answers */
+static long  n_alloc  = 0;       /* allocated number of answers */
+static long  next     = 0;       /* next answer to be used */
+static char  **field  = NULL;    /* answers */
+
+/*--------------------------------------------------------------------------*/
+
+static void add_field
+
+     (const char  *s,      /* answer */
+      long        n)       /* length of s */
+
+/*
+  appends the first n characters of s to the list of answers
+*/
+
+{
+if (n_fields == n_alloc)
+   {
+   n_alloc = (n_alloc == 0) ? 64 : 2 * n_alloc;
+   field = (char **) realloc (field, (size_t) n_alloc * sizeof(char *));
+   if (field == NULL)
+      {
+      printf("add_field: not enough memory available\n");
+      exit(1);
+      }
+   }
+
+field[n_fields] = (char *) malloc ((size_t) n + 1);
+if (field[n_fields] == NULL)
+   {
+   printf("add_field: not enough memory available\n");
+   exit(1);
+   }
+memcpy (field[n_fields], s, (size_t) n);
+field[n_fields][n] = 0;
+n_fields++;
+
+return;
+
+}  /* add_field */
+
+/*--------------------------------------------------------------------------*/
+
+static void read_job_file
+
+     (const char  *file_name)    /* name of job file */
+
+/*
+  splits a job file into whitespace separated answers;
+  # starts a comment up to the end of the line, "..." quotes an answer
+  that contains blanks
+*/
+
+{
+FILE  *jobfile;    /* job file */
+char  *text;       /* file contents */
+char  *p, *q;      /* current position, start of answer */
+long  size;        /* file size */
+
+jobfile = fopen (file_name, "rb");
+if (NULL == jobfile)
+   {
+   printf("could not open job file '%s', aborting\n", file_name);
+   exit(1);
+   }
+
+fseek (jobfile, 0, SEEK_END);
+size = ftell (jobfile);
+fseek (jobfile, 0, SEEK_SET);
+
+text = (char *) malloc ((size_t) size + 1);
+if (text == NULL)
+   {
+   printf("read_job_file: not enough memory available\n");
+   exit(1);
+   }
+if (fread (text, 1, (size_t) size, jobfile) != (size_t) size)
+   {
+   printf("could not read job file '%s', aborting\n", file_name);
+   exit(1);
+   }
+text[size] = 0;
+fclose (jobfile);
+
+p = text;
+while (*p)
+   {
+   if (isspace ((unsigned char) *p))
+      p++;
+   else if (*p == '#')
+      {
+      /* skip comment */
+      while (*p && (*p != '\n'))
+         p++;
+      }
+   else if (*p == '"')
+      {
+      /* quoted answer */
+      q = ++p;
+      while (*p && (*p != '"') && (*p != '\n'))
+         p++;
+      add_field (q, (long)(p - q));
+      if (*p == '"')
+         p++;
+      }
+   else
+      {
+      q = p;
+      while (*p && !isspace ((unsigned char) *p))
+         p++;
+      add_field (q, (long)(p - q));
+      }
+   }
+
+free (text);
+return;
+
+}  /* read_job_file */
+
+/*--------------------------------------------------------------------------*/
+
+void read_options
+
+     (int   argc,        /* number of command line arguments */
+      char  **argv)      /* command line arguments */
+
+/*
+  collects the answers from the command line and from job files given
+  with -b and switches to batch mode if there are any;
+  -t sets the number of threads
+*/
+
+{
+long  k;    /* loop variable */
+
+for (k=1; k<argc; k++)
+    {
+    if ((strcmp (argv[k], "-b") == 0) && (k+1 < argc))
+       {
+       read_job_file (argv[k+1]);
+       batch = 1;
+       k++;
+       }
+    else if ((strcmp (argv[k], "-t") == 0) && (k+1 < argc))
+       {
+       parallel_init (atol (argv[k+1]));
+       k++;
+       }
+    else
+       {
+       add_field (argv[k], (long) strlen (argv[k]));
+       batch = 1;
+       }
+    }
+
+/* keep decoded input images between jobs */
+if (batch)
+   set_image_cache (8);
+
+return;
+
+}  /* read_options */
+
+/*--------------------------------------------------------------------------*/
+
+long next_job
+
+     (void)
+
+/*
+  returns 1 if another job is to be processed and 0 otherwise;
+  interactive mode runs exactly one job
+*/
+
+{
+if (!batch)
+   return (jobs++ == 0);
+
+if (next >= n_fields)
+   {
+   set_image_cache (0);
+   return (0);
+   }
+
+jobs++;
+printf ("\n---- job %ld ----\n\n", jobs);
+
+return (1);
+
+}  /* next_job */
+
+/*--------------------------------------------------------------------------*/
+
+static const char *next_field
+
+     (void)
+
+/*
+  returns the next answer in batch mode and echoes it after the prompt
+*/
+
+{
+if (next >= n_fields)
+   {
+   printf ("\njob %ld: not enough parameters, aborting\n", jobs);
+   exit(1);
+   }
+
+printf ("%s\n", field[next]);
+return (field[next++]);
+
+}  /* next_field */
+
+/*--------------------------------------------------------------------------*/
+
+void read_string
+
+     (char *v)         /* string to be read */
+
+/*
+  reads a string v
+*/
+
+{
+const char  *s;    /* answer in batch mode */
+
+if (batch)
+   {
+   s = next_field ();
+   if (strlen (s) >= CLI_LENGTH)
+      {
+      printf ("job %ld: answer '%s' too long, aborting\n", jobs, s);
+      exit(1);
+      }
+   strcpy (v, s);
+   return;
+   }
+
+if (fgets (v, CLI_LENGTH, stdin) == NULL)
+   {
+   printf("could not read string, aborting\n");
+   exit(1);
+   }
+
+if ((v[0] != 0) && (v[strlen(v)-1] == '\n'))
+   v[strlen(v)-1] = 0;
+
+return;
+
+}  /* read_string */
+
+/*--------------------------------------------------------------------------*/
+
+void read_long
+
+     (long *v)         /* value to be read */
+
+/*
+  reads a long value v
+*/
+
+{
+char   row[CLI_LENGTH];    /* string for reading data */
+
+read_string (row);
+sscanf(row, "%ld", &*v);
+
+return;
+
+}  /* read_long */
+
+/*--------------------------------------------------------------------------*/
+
+void read_double
+
+     (double *v)         /* value to be read */
+
+/*
+  reads a double value v
+*/
+
+{
+char   row[CLI_LENGTH];    /* string for reading data */
+
+read_string (row);
+sscanf(row, "%lf", &*v);
+
+return;
+
+}  /* read_double */
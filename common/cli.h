@@ -0,0 +1,43 @@
+#ifndef CLI_H
+#define CLI_H
+
+/*--------------------------------------------------------------------------*/
+/*                                                                          */
+/*                     PARAMETER INPUT AND BATCH MODE                       */
+/*                                                                          */
+/*--------------------------------------------------------------------------*/
+
+/*
+  All programs ask for their parameters with read_string, read_long and
+  read_double. Without command line arguments the answers come from stdin
+  as before and the program runs once. Otherwise they are taken from
+
+    program [-t threads] [-b job_file] [answer ...]
+
+  where the answers on the command line and the whitespace separated
+  fields of the job file (one job per line by convention, # starts a
+  comment, "..." quotes a field with blanks) are given in the order of the
+  prompts. The program repeats its work as long as answers remain, so one
+  invocation processes many input files and parameter sets; decoded input
+  images stay resident between jobs. -t sets the number of threads
+  (default: one per processor).
+*/
+
+/*--------------------------------------------------------------------------*/
+
+void read_options
+     (int argc, char **argv);
+
+long next_job
+     (void);
+
+void read_string
+     (char *v);
+
+void read_long
+     (long *v);
+
+void read_double
+     (double *v);
+
+#endif
@@ -0,0 +1,1035 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <pthread.h>
+
+#include "image.h"
+#include "parallel.h"
+#include "fft.h"
+#include "dct.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define DCT_X86
+#include <immintrin.h>
+#endif
+
+/*--------------------------------------------------------------------------*/
+/*                                                                          */
+/*                        DISCRETE COSINE TRANSFORM                         */
+/*                                                                          */
+/*--------------------------------------------------------------------------*/
+
+/*
+  fast DCT-II / DCT-III of images via the FFT (Makhoul)
+*/
+
+/*--------------------------------------------------------------------------*/
+
+#define DCT_CACHE_SIZE  8    /* number of cached plans */
+#define DCT_SMALL      16    /* longest side of the matrix form */
+
+#ifndef M_PI
+#define M_PI  3.14159265358979323846
+#endif
+
+/*
+  With the unitary FFT V of the reordered signal v, the orthonormal DCT is
+  c_p = g_p Re (exp (-i pi p / 2n) V_p) with g_0 = 1, g_p = sqrt (2);
+  since v is real, Re (exp (-i pi p / 2n) V_p) and
+  -Im (exp (-i pi p / 2n) V_p) are the (rescaled) coefficients p and n-p,
+  which gives the inverse
+  V_p = exp (i pi p / 2n) (c_p / g_p - i c_(n-p) / g_(n-p)), c_n = 0.
+*/
+
+/* data of the parallel loops */
+typedef struct
+   {
+   image     *u;           /* image */
+   image     *c;           /* coefficients */
+   image     *ur, *ui;     /* left / right half, reordered, or its FFT */
+   dct_plan  *plan;        /* plan for the current direction */
+   } dct_task;
+
+/*--------------------------------------------------------------------------*/
+
+static double *alloc_vector
+
+     (long  n)           /* size */
+
+/*
+  allocates a double vector of size n
+*/
+
+{
+double  *v;    /* vector */
+
+v = (double *) malloc ((size_t)(n > 0 ? n : 1) * sizeof(double));
+if (v == NULL)
+   {
+   printf("dct: not enough memory available\n");
+   exit(1);
+   }
+
+return (v);
+
+}  /* alloc_vector */
+
+/*--------------------------------------------------------------------------*/
+
+static long source
+
+     (long  m,           /* index in the reordered signal */
+      long  n)           /* signal length */
+
+/*
+  index of the sample that is moved to position m by the Makhoul
+  reordering: even samples ascending, then odd samples descending
+*/
+
+{
+return ((2 * m < n) ? 2 * m : 2 * (n - 1 - m) + 1);
+
+}  /* source */
+
+/*--------------------------------------------------------------------------*/
+
+dct_plan *dct_plan_cached
+
+     (long  n)           /* signal length (>0) */
+
+/*
+  returns a shared plan for length n; it is created on first request and
+  kept until the program ends; safe to call from several threads
+*/
+
+{
+static pthread_mutex_t  lock = PTHREAD_MUTEX_INITIALIZER;
+static dct_plan         *cache[DCT_CACHE_SIZE];   /* cached plans */
+static long             n_cached = 0;             /* number of plans */
+dct_plan                *p = NULL;                /* plan */
+long                    k;                        /* loop variable */
+
+pthread_mutex_lock (&lock);
+
+for (k=0; k<n_cached; k++)
+    if (cache[k]->n == n)
+       p = cache[k];
+
+if (p == NULL)
+   {
+   p = (dct_plan *) malloc (sizeof(dct_plan));
+   if (p == NULL)
+      {
+      printf("dct_plan_cached: not enough memory available\n");
+      exit(1);
+      }
+   p->n   = n;
+   p->fft = fft_plan_cached (n);
+   p->c   = alloc_vector (n);
+   p->s   = alloc_vector (n);
+   p->m   = NULL;
+   for (k=0; k<n; k++)
+       {
+       p->c[k] = cos (M_PI * k / (2.0 * n));
+       p->s[k] = sin (M_PI * k / (2.0 * n));
+       }
+   if (n <= DCT_SMALL)
+      {
+      p->m = alloc_vector (n * n);
+      for (k=0; k<n*n; k++)
+          p->m[k] = ((k < n) ? sqrt (1.0 / n) : sqrt (2.0 / n))
+                    * cos (M_PI * (2 * (k % n) + 1) * (k / n) / (2.0 * n));
+      }
+
+   if (n_cached < DCT_CACHE_SIZE)
+      cache[n_cached++] = p;
+   else
+      {
+      /* replace the oldest plan; earlier callers may still use it */
+      /* until they finish, so it is not freed */
+      for (k=1; k<DCT_CACHE_SIZE; k++)
+          cache[k-1] = cache[k];
+      cache[DCT_CACHE_SIZE-1] = p;
+      }
+   }
+
+pthread_mutex_unlock (&lock);
+
+return (p);
+
+}  /* dct_plan_cached */
+
+/*--------------------------------------------------------------------------*/
+
+static void rows_kernel
+
+     (long  first,       /* first pair of rows */
+      long  last,        /* last pair of rows */
+      void  *arg)        /* dct_task */
+
+/*
+  DCT in x direction of the rows 2q and 2q+1 (q = first,...,last, counted
+  from 0) of u into c: one complex FFT of z = a + i b of the reordered
+  rows, separated into A_p = (Z_p + conj Z_(n-p)) / 2 and
+  B_p = (Z_p - conj Z_(n-p)) / 2i and rotated; u and c may be the same
+*/
+
+{
+dct_task  *t = (dct_task *) arg;   /* task */
+dct_plan  *plan = t->plan;         /* plan */
+long      n = t->u->nx;            /* row length */
+long      hu = t->u->halo;         /* boundary layer of u */
+long      hc = t->c->halo;         /* boundary layer of c */
+long      q, p, m, np, ja, jb;     /* pair, loop variables, rows */
+pixel     *a, *b;                  /* rows of u */
+pixel     *ca, *cb;                /* rows of c */
+double    *zr, *zi;                /* z = a + i b */
+double    *work;                   /* scratch vector of the FFT */
+double    ar, ai, br, bi;          /* A_p, B_p */
+double    g;                       /* normalisation */
+
+zr   = alloc_vector (n);
+zi   = alloc_vector (n);
+work = alloc_vector (plan->fft->scratch);
+
+for (q=first; q<=last; q++)
+    {
+    ja = 2 * q;
+    jb = 2 * q + 1;
+    a  = ROW(t->u,ja+hu) + hu;
+    b  = (jb < t->u->ny) ? ROW(t->u,jb+hu) + hu : NULL;
+    for (m=0; m<n; m++)
+        {
+        zr[m] = a[source (m, n)];
+        zi[m] = (b != NULL) ? b[source (m, n)] : 0.0;
+        }
+
+    fft_execute (plan->fft, zr, zi, work);
+
+    ca = ROW(t->c,ja+hc) + hc;
+    cb = (b != NULL) ? ROW(t->c,jb+hc) + hc : NULL;
+    for (p=0; p<n; p++)
+        {
+        np = (n - p) % n;
+        ar =  0.5 * (zr[p] + zr[np]);
+        ai =  0.5 * (zi[p] - zi[np]);
+        br =  0.5 * (zi[p] + zi[np]);
+        bi = -0.5 * (zr[p] - zr[np]);
+        g  = (p == 0) ? 1.0 : M_SQRT2;
+        ca[p] = g * (plan->c[p] * ar + plan->s[p] * ai);
+        if (cb != NULL)
+           cb[p] = g * (plan->c[p] * br + plan->s[p] * bi);
+        }
+    }
+
+free (zr);
+free (zi);
+free (work);
+return;
+
+}  /* rows_kernel */
+
+/*--------------------------------------------------------------------------*/
+
+static void rows_inverse_kernel
+
+     (long  first,       /* first pair of rows */
+      long  last,        /* last pair of rows */
+      void  *arg)        /* dct_task */
+
+/*
+  inverse DCT in x direction of the rows 2q and 2q+1 of c into u: the
+  rotated spectra V_a, V_b are combined to Z = V_a + i V_b and
+  backtransformed with conj FFT conj; Re z and Im z are the reordered
+  rows; u and c may be the same
+*/
+
+{
+dct_task  *t = (dct_task *) arg;   /* task */
+dct_plan  *plan = t->plan;         /* plan */
+long      n = t->u->nx;            /* row length */
+long      hu = t->u->halo;         /* boundary layer of u */
+long      hc = t->c->halo;         /* boundary layer of c */
+long      q, p, m, ja, jb;         /* pair, loop variables, rows */
+pixel     *a, *b;                  /* rows of u */
+pixel     *ca, *cb;                /* rows of c */
+double    *zr, *zi;                /* Z = V_a + i V_b */
+double    *work;                   /* scratch vector of the FFT */
+double    ya, yan, yb, ybn;        /* rescaled coefficients p and n-p */
+
+zr   = alloc_vector (n);
+zi   = alloc_vector (n);
+work = alloc_vector (plan->fft->scratch);
+
+for (q=first; q<=last; q++)
+    {
+    ja = 2 * q;
+    jb = 2 * q + 1;
+    ca = ROW(t->c,ja+hc) + hc;
+    cb = (jb < t->c->ny) ? ROW(t->c,jb+hc) + hc : NULL;
+
+    for (p=0; p<n; p++)
+        {
+        if (p == 0)
+           {
+           ya  = ca[0];
+           yb  = (cb != NULL) ? cb[0] : 0.0;
+           yan = ybn = 0.0;
+           }
+        else
+           {
+           ya  = M_SQRT1_2 * ca[p];
+           yan = M_SQRT1_2 * ca[n-p];
+           yb  = (cb != NULL) ? M_SQRT1_2 * cb[p] : 0.0;
+           ybn = (cb != NULL) ? M_SQRT1_2 * cb[n-p] : 0.0;
+           }
+        /* Z = V_a + i V_b, conjugated */
+        zr[p] =   plan->c[p] * ya + plan->s[p] * yan
+                - plan->s[p] * yb + plan->c[p] * ybn;
+        zi[p] = - plan->s[p] * ya + plan->c[p] * yan
+                - plan->c[p] * yb - plan->s[p] * ybn;
+        }
+
+    fft_execute (plan->fft, zr, zi, work);
+
+    a = ROW(t->u,ja+hu) + hu;
+    b = (cb != NULL) ? ROW(t->u,jb+hu) + hu : NULL;
+    for (m=0; m<n; m++)
+        {
+        a[source (m, n)] = zr[m];
+        if (b != NULL)
+           b[source (m, n)] = -zi[m];
+        }
+    }
+
+free (zr);
+free (zi);
+free (work);
+return;
+
+}  /* rows_inverse_kernel */
+
+/*--------------------------------------------------------------------------*/
+
+static void split_kernel
+
+     (long  first,       /* first row */
+      long  last,        /* last row */
+      void  *arg)        /* dct_task */
+
+/*
+  rows m = first,...,last of the reordered halves: row m of ur (ui) is the
+  left (right) half of row source (m) of c; the last column of ui is 0 if
+  the width is odd
+*/
+
+{
+dct_task  *t = (dct_task *) arg;   /* task */
+long      nx = t->c->nx;           /* image width */
+long      ny = t->c->ny;           /* column length */
+long      h = t->ur->nx;           /* width of a half */
+long      hc = t->c->halo;         /* boundary layer of c */
+long      i, m;                    /* loop variables */
+pixel     *row;                    /* row of c */
+pixel     *pr, *pi;                /* rows of ur, ui */
+
+for (m=first; m<=last; m++)
+    {
+    row = ROW(t->c,source (m, ny)+hc) + hc;
+    pr  = ROW(t->ur,m+1) + 1;
+    pi  = ROW(t->ui,m+1) + 1;
+    for (i=0; i<h; i++)
+        pr[i] = row[i];
+    for (i=0; i<nx-h; i++)
+        pi[i] = row[h+i];
+    if (nx - h < h)
+       pi[h-1] = 0.0;
+    }
+
+return;
+
+}  /* split_kernel */
+
+/*--------------------------------------------------------------------------*/
+
+static void rotate_kernel
+
+     (long  first,       /* first frequency */
+      long  last,        /* last frequency */
+      void  *arg)        /* dct_task */
+
+/*
+  rows p = first,...,last of the DCT in y direction: separates the
+  Fourier coefficients of the left and the right half from rows p and
+  n-p of ur, ui, rotates them and writes row p of c
+*/
+
+{
+dct_task  *t = (dct_task *) arg;   /* task */
+dct_plan  *plan = t->plan;         /* plan */
+long      nx = t->c->nx;           /* image width */
+long      ny = t->c->ny;           /* column length */
+long      h = t->ur->nx;           /* width of a half */
+long      hc = t->c->halo;         /* boundary layer of c */
+long      i, p;                    /* loop variables */
+pixel     *row;                    /* row of c */
+pixel     *zr, *zi, *nr, *ni;      /* rows p and n-p of ur, ui */
+double    cg, sg;                  /* rotation and normalisation */
+double    ar, ai, br, bi;          /* A_p, B_p */
+
+for (p=first; p<=last; p++)
+    {
+    row = ROW(t->c,p+hc) + hc;
+    zr  = ROW(t->ur,p+1) + 1;
+    zi  = ROW(t->ui,p+1) + 1;
+    nr  = ROW(t->ur,(ny-p)%ny+1) + 1;
+    ni  = ROW(t->ui,(ny-p)%ny+1) + 1;
+    cg  = ((p == 0) ? 0.5 : 0.5 * M_SQRT2) * plan->c[p];
+    sg  = ((p == 0) ? 0.5 : 0.5 * M_SQRT2) * plan->s[p];
+    for (i=0; i<h; i++)
+        {
+        ar =  zr[i] + nr[i];
+        ai =  zi[i] - ni[i];
+        br =  zi[i] + ni[i];
+        bi = -zr[i] + nr[i];
+        row[i] = cg * ar + sg * ai;
+        if (h + i < nx)
+           row[h+i] = cg * br + sg * bi;
+        }
+    }
+
+return;
+
+}  /* rotate_kernel */
+
+/*--------------------------------------------------------------------------*/
+
+static void rotate_inverse_kernel
+
+     (long  first,       /* first frequency */
+      long  last,        /* last frequency */
+      void  *arg)        /* dct_task */
+
+/*
+  rows p = first,...,last of the inverse DCT in y direction: combines the
+  rotated spectra of the left and the right half of c (rows p and n-p)
+  to Z = V_a + i V_b and stores conj Z in row p of ur, ui
+*/
+
+{
+dct_task  *t = (dct_task *) arg;   /* task */
+dct_plan  *plan = t->plan;         /* plan */
+long      nx = t->c->nx;           /* image width */
+long      ny = t->c->ny;           /* column length */
+long      h = t->ur->nx;           /* width of a half */
+long      hc = t->c->halo;         /* boundary layer of c */
+long      i, p;                    /* loop variables */
+pixel     *row, *nrow;             /* rows p and n-p of c */
+pixel     *zr, *zi;                /* row p of ur, ui */
+double    cp, sp, cn, sn;          /* rotation and normalisation */
+double    ya, yan, yb, ybn;        /* coefficients p and n-p */
+
+for (p=first; p<=last; p++)
+    {
+    row  = ROW(t->c,p+hc) + hc;
+    nrow = ROW(t->c,(ny-p)%ny+hc) + hc;
+    zr   = ROW(t->ur,p+1) + 1;
+    zi   = ROW(t->ui,p+1) + 1;
+    /* coefficient n-p is absent for p = 0 */
+    cp = ((p == 0) ? 1.0 : M_SQRT1_2) * plan->c[p];
+    sp = ((p == 0) ? 1.0 : M_SQRT1_2) * plan->s[p];
+    cn = (p == 0) ? 0.0 : M_SQRT1_2 * plan->c[p];
+    sn = (p == 0) ? 0.0 : M_SQRT1_2 * plan->s[p];
+    for (i=0; i<h; i++)
+        {
+        ya  = row[i];
+        yan = nrow[i];
+        yb  = (h + i < nx) ? row[h+i] : 0.0;
+        ybn = (h + i < nx) ? nrow[h+i] : 0.0;
+        zr[i] =   cp * ya + sn * yan - sp * yb + cn * ybn;
+        zi[i] = - sp * ya + cn * yan - cp * yb - sn * ybn;
+        }
+    }
+
+return;
+
+}  /* rotate_inverse_kernel */
+
+/*--------------------------------------------------------------------------*/
+
+static void merge_kernel
+
+     (long  first,       /* first row */
+      long  last,        /* last row */
+      void  *arg)        /* dct_task */
+
+/*
+  rows m = first,...,last after the inverse FFT of the columns: Re z
+  (= ur) and Im z (= -ui) are the left and the right half of row
+  source (m) of u
+*/
+
+{
+dct_task  *t = (dct_task *) arg;   /* task */
+long      nx = t->u->nx;           /* image width */
+long      ny = t->u->ny;           /* column length */
+long      h = t->ur->nx;           /* width of a half */
+long      hu = t->u->halo;         /* boundary layer of u */
+long      i, m;                    /* loop variables */
+pixel     *row;                    /* row of u */
+pixel     *pr, *pi;                /* rows of ur, ui */
+
+for (m=first; m<=last; m++)
+    {
+    row = ROW(t->u,source (m, ny)+hu) + hu;
+    pr  = ROW(t->ur,m+1) + 1;
+    pi  = ROW(t->ui,m+1) + 1;
+    for (i=0; i<h; i++)
+        row[i] = pr[i];
+    for (i=0; i<nx-h; i++)
+        row[h+i] = -pi[i];
+    }
+
+return;
+
+}  /* merge_kernel */
+
+/*--------------------------------------------------------------------------*/
+
+static void small_2d
+
+     (image     *u,        /* image */
+      image     *c,        /* coefficients */
+      dct_plan  *px,       /* plan in x direction, with matrix */
+      dct_plan  *py,       /* plan in y direction, with matrix */
+      long      inverse)   /* 0: u -> c, 1: c -> u */
+
+/*
+  DCT or inverse DCT of a small image (e.g. an 8x8 block) as two products
+  with the cosine matrices of the plans; cheaper than the FFT for such
+  sizes and without any allocation; u and c may be the same
+*/
+
+{
+long    nx = px->n;                   /* image width */
+long    ny = py->n;                   /* image height */
+long    hu = u->halo;                 /* boundary layer of u */
+long    hc = c->halo;                 /* boundary layer of c */
+long    i, j, p, q;                   /* loop variables */
+double  tmp[DCT_SMALL*DCT_SMALL];     /* result of the first direction */
+double  sum;                          /* for summing up */
+
+if (inverse == 0)
+   {
+   /* y direction, then x direction */
+   for (q=0; q<ny; q++)
+    for (i=0; i<nx; i++)
+        {
+        sum = 0.0;
+        for (j=0; j<ny; j++)
+            sum += py->m[q*ny+j] * PIX(u,i+hu,j+hu);
+        tmp[q*nx+i] = sum;
+        }
+   for (q=0; q<ny; q++)
+    for (p=0; p<nx; p++)
+        {
+        sum = 0.0;
+        for (i=0; i<nx; i++)
+            sum += px->m[p*nx+i] * tmp[q*nx+i];
+        PIX(c,p+hc,q+hc) = sum;
+        }
+   }
+else
+   {
+   /* y direction, then x direction, with the transposed matrices */
+   for (j=0; j<ny; j++)
+    for (p=0; p<nx; p++)
+        {
+        sum = 0.0;
+        for (q=0; q<ny; q++)
+            sum += py->m[q*ny+j] * PIX(c,p+hc,q+hc);
+        tmp[j*nx+p] = sum;
+        }
+   for (j=0; j<ny; j++)
+    for (i=0; i<nx; i++)
+        {
+        sum = 0.0;
+        for (p=0; p<nx; p++)
+            sum += px->m[p*nx+i] * tmp[j*nx+p];
+        PIX(u,i+hu,j+hu) = sum;
+        }
+   }
+
+return;
+
+}  /* small_2d */
+
+/*--------------------------------------------------------------------------*/
+
+void dct2d
+
+     (image  *u,         /* image, unchanged (unless c = u) */
+      image  *c)         /* DCT coefficients, same size, output */
+
+/*
+  orthonormal DCT-II of u in x and y direction; coefficient (p,q) is
+  stored at the position of pixel (p,q); u and c may be the same image
+*/
+
+{
+dct_task  t;          /* task */
+long      nx, ny;     /* image size */
+long      h;          /* width of a half */
+
+nx = u->nx;
+ny = u->ny;
+h  = (nx + 1) / 2;
+
+if ((nx <= DCT_SMALL) && (ny <= DCT_SMALL))
+   {
+   small_2d (u, c, dct_plan_cached (nx), dct_plan_cached (ny), 0);
+   return;
+   }
+
+/* x direction, two rows per FFT */
+t.u    = u;
+t.c    = c;
+t.plan = dct_plan_cached (nx);
+parallel_rows (0, (ny - 1) / 2, rows_kernel, &t);
+
+/* y direction, left and right half in one FFT per column */
+alloc_image (&t.ur, 1, h, ny, 1);
+alloc_image (&t.ui, 1, h, ny, 1);
+t.plan = dct_plan_cached (ny);
+parallel_rows (0, ny - 1, split_kernel, &t);
+fft_columns (t.ur, t.ui);
+parallel_rows (0, ny - 1, rotate_kernel, &t);
+
+free_image (t.ur);
+free_image (t.ui);
+return;
+
+}  /* dct2d */
+
+/*--------------------------------------------------------------------------*/
+
+void idct2d
+
+     (image  *c,         /* DCT coefficients, unchanged (unless u = c) */
+      image  *u)         /* image, same size, output */
+
+/*
+  inverse of dct2d (orthonormal DCT-III in y and x direction); u and c
+  may be the same image
+*/
+
+{
+dct_task  t;          /* task */
+long      nx, ny;     /* image size */
+long      h;          /* width of a half */
+
+nx = c->nx;
+ny = c->ny;
+h  = (nx + 1) / 2;
+
+if ((nx <= DCT_SMALL) && (ny <= DCT_SMALL))
+   {
+   small_2d (u, c, dct_plan_cached (nx), dct_plan_cached (ny), 1);
+   return;
+   }
+
+/* y direction: backtransform conj Z with the forward FFT */
+t.u = u;
+t.c = c;
+alloc_image (&t.ur, 1, h, ny, 1);
+alloc_image (&t.ui, 1, h, ny, 1);
+t.plan = dct_plan_cached (ny);
+parallel_rows (0, ny - 1, rotate_inverse_kernel, &t);
+fft_columns (t.ur, t.ui);
+parallel_rows (0, ny - 1, merge_kernel, &t);
+free_image (t.ur);
+free_image (t.ui);
+
+/* x direction in place, two rows per FFT */
+t.c    = u;
+t.plan = dct_plan_cached (nx);
+parallel_rows (0, (ny - 1) / 2, rows_inverse_kernel, &t);
+
+return;
+
+}  /* idct2d */
+
+/*--------------------------------------------------------------------------*/
+/*                                                                          */
+/*                         DCT OF 8x8 BLOCKS                                */
+/*                                                                          */
+/*--------------------------------------------------------------------------*/
+
+/*
+  The 8-point DCT factorises into butterflies: with e_n = x_n + x_(7-n),
+  o_n = x_n - x_(7-n) (n = 0,...,3) and c_k = cos (k pi / 16) / 2,
+    X_0 = c_4 (e_0 + e_3 + e_1 + e_2),  X_4 = c_4 (e_0 + e_3 - e_1 - e_2),
+    X_2 = c_2 (e_0 - e_3) + c_6 (e_1 - e_2),
+    X_6 = c_6 (e_0 - e_3) - c_2 (e_1 - e_2),
+  and X_1, X_3, X_5, X_7 = A o with the symmetric 4x4 matrix
+    A = ( c1  c3  c5  c7 / c3 -c7 -c1 -c5 / c5 -c1  c7  c3 / c7 -c5  c3 -c1 ),
+  i.e. 22 multiplications instead of 64; the inverse runs the butterflies
+  backwards with the transposed (= same) matrices.
+  butterfly_columns transforms all 8 columns of a block at once: its loop
+  runs over the columns, so each x_n, e_n, X_k is a block row of 8
+  doubles, which the compiler keeps in one AVX-512 register (two AVX2,
+  four SSE2 registers). The rows are transformed as the columns of the
+  transposed block.
+*/
+
+#define DCT_C1  0.49039264020161522456   /* cos (1 pi / 16) / 2 */
+#define DCT_C2  0.46193976625564337806   /* cos (2 pi / 16) / 2 */
+#define DCT_C3  0.41573480615127261854   /* cos (3 pi / 16) / 2 */
+#define DCT_C4  0.35355339059327376220   /* cos (4 pi / 16) / 2 */
+#define DCT_C5  0.27778511650980111237   /* cos (5 pi / 16) / 2 */
+#define DCT_C6  0.19134171618254488586   /* cos (6 pi / 16) / 2 */
+#define DCT_C7  0.09754516100806413392   /* cos (7 pi / 16) / 2 */
+
+typedef void (*block_kernel)
+     (double *b);
+
+/*--------------------------------------------------------------------------*/
+
+static inline __attribute__((always_inline)) void butterfly_columns
+
+     (double  *b,        /* 8x8 block, row-major, in and out */
+      long    inverse)   /* 0: DCT, 1: inverse DCT */
+
+/*
+  1-D DCT or inverse DCT of all 8 columns of b
+*/
+
+{
+long    i;                            /* column */
+double  e0, e1, e2, e3, o0, o1, o2, o3;   /* even and odd parts */
+double  a, d, p, q;                   /* even stage */
+
+if (inverse == 0)
+   for (i=0; i<8; i++)
+       {
+       e0 = b[i]    + b[56+i];
+       e1 = b[8+i]  + b[48+i];
+       e2 = b[16+i] + b[40+i];
+       e3 = b[24+i] + b[32+i];
+       o0 = b[i]    - b[56+i];
+       o1 = b[8+i]  - b[48+i];
+       o2 = b[16+i] - b[40+i];
+       o3 = b[24+i] - b[32+i];
+
+       a = e0 + e3;
+       d = e1 + e2;
+       p = e0 - e3;
+       q = e1 - e2;
+       b[i]    = DCT_C4 * (a + d);
+       b[32+i] = DCT_C4 * (a - d);
+       b[16+i] = DCT_C2 * p + DCT_C6 * q;
+       b[48+i] = DCT_C6 * p - DCT_C2 * q;
+
+       b[8+i]  = DCT_C1 * o0 + DCT_C3 * o1 + DCT_C5 * o2 + DCT_C7 * o3;
+       b[24+i] = DCT_C3 * o0 - DCT_C7 * o1 - DCT_C1 * o2 - DCT_C5 * o3;
+       b[40+i] = DCT_C5 * o0 - DCT_C1 * o1 + DCT_C7 * o2 + DCT_C3 * o3;
+       b[56+i] = DCT_C7 * o0 - DCT_C5 * o1 + DCT_C3 * o2 - DCT_C1 * o3;
+       }
+else
+   for (i=0; i<8; i++)
+       {
+       a = DCT_C4 * (b[i] + b[32+i]);
+       d = DCT_C4 * (b[i] - b[32+i]);
+       p = DCT_C2 * b[16+i] + DCT_C6 * b[48+i];
+       q = DCT_C6 * b[16+i] - DCT_C2 * b[48+i];
+       e0 = a + p;
+       e3 = a - p;
+       e1 = d + q;
+       e2 = d - q;
+
+       o0 = DCT_C1 * b[8+i] + DCT_C3 * b[24+i]
+          + DCT_C5 * b[40+i] + DCT_C7 * b[56+i];
+       o1 = DCT_C3 * b[8+i] - DCT_C7 * b[24+i]
+          - DCT_C1 * b[40+i] - DCT_C5 * b[56+i];
+       o2 = DCT_C5 * b[8+i] - DCT_C1 * b[24+i]
+          + DCT_C7 * b[40+i] + DCT_C3 * b[56+i];
+       o3 = DCT_C7 * b[8+i] - DCT_C5 * b[24+i]
+          + DCT_C3 * b[40+i] - DCT_C1 * b[56+i];
+
+       b[i]    = e0 + o0;
+       b[56+i] = e0 - o0;
+       b[8+i]  = e1 + o1;
+       b[48+i] = e1 - o1;
+       b[16+i] = e2 + o2;
+       b[40+i] = e2 - o2;
+       b[24+i] = e3 + o3;
+       b[32+i] = e3 - o3;
+       }
+
+return;
+
+}  /* butterfly_columns */
+
+/*--------------------------------------------------------------------------*/
+
+static inline __attribute__((always_inline)) void transpose_block
+
+     (double  *b,        /* 8x8 block, unchanged */
+      double  *t)        /* transposed block, output */
+
+/*
+  t = b^T, one element at a time
+*/
+
+{
+long  i, j;    /* loop variables */
+
+for (j=0; j<8; j++)
+ for (i=0; i<8; i++)
+     t[8*i+j] = b[8*j+i];
+
+return;
+
+}  /* transpose_block */
+
+#if defined(DCT_X86)
+
+/*--------------------------------------------------------------------------*/
+
+__attribute__((target("avx2")))
+static inline void transpose_avx2
+
+     (double  *b,        /* 8x8 block, unchanged */
+      double  *t)        /* transposed block, output */
+
+/*
+  t = b^T as four 4x4 transposes in registers (unpack, then exchange of
+  the 128-bit halves); block (I,J) of b becomes block (J,I) of t
+*/
+
+{
+long     I, J;             /* 4x4 block */
+__m256d  r0, r1, r2, r3;   /* rows of a 4x4 block */
+__m256d  s0, s1, s2, s3;   /* after the unpack */
+
+for (J=0; J<8; J+=4)
+ for (I=0; I<8; I+=4)
+     {
+     r0 = _mm256_loadu_pd (b + 8 * J + I);
+     r1 = _mm256_loadu_pd (b + 8 * (J + 1) + I);
+     r2 = _mm256_loadu_pd (b + 8 * (J + 2) + I);
+     r3 = _mm256_loadu_pd (b + 8 * (J + 3) + I);
+     s0 = _mm256_unpacklo_pd (r0, r1);
+     s1 = _mm256_unpackhi_pd (r0, r1);
+     s2 = _mm256_unpacklo_pd (r2, r3);
+     s3 = _mm256_unpackhi_pd (r2, r3);
+     _mm256_storeu_pd (t + 8 * I + J,
+                       _mm256_permute2f128_pd (s0, s2, 0x20));
+     _mm256_storeu_pd (t + 8 * (I + 1) + J,
+                       _mm256_permute2f128_pd (s1, s3, 0x20));
+     _mm256_storeu_pd (t + 8 * (I + 2) + J,
+                       _mm256_permute2f128_pd (s0, s2, 0x31));
+     _mm256_storeu_pd (t + 8 * (I + 3) + J,
+                       _mm256_permute2f128_pd (s1, s3, 0x31));
+     }
+
+return;
+
+}  /* transpose_avx2 */
+
+/*--------------------------------------------------------------------------*/
+
+__attribute__((target("avx512f")))
+static inline void transpose_avx512
+
+     (double  *b,        /* 8x8 block, unchanged */
+      double  *t)        /* transposed block, output */
+
+/*
+  t = b^T in registers: pairs of rows are interleaved (unpack), then
+  pairs of pairs and finally the two halves (two-source permutes)
+*/
+
+{
+__m512d  r0, r1, r2, r3, r4, r5, r6, r7;   /* rows */
+__m512d  u0, u1, u2, u3, u4, u5, u6, u7;   /* intermediate results */
+__m512i  lo2, hi2;         /* permutes of the second stage */
+__m512i  lo4, hi4;         /* permutes of the third stage */
+
+lo2 = _mm512_set_epi64 (13, 12, 5, 4, 9, 8, 1, 0);
+hi2 = _mm512_set_epi64 (15, 14, 7, 6, 11, 10, 3, 2);
+lo4 = _mm512_set_epi64 (11, 10, 9, 8, 3, 2, 1, 0);
+hi4 = _mm512_set_epi64 (15, 14, 13, 12, 7, 6, 5, 4);
+
+r0 = _mm512_loadu_pd (b);
+r1 = _mm512_loadu_pd (b + 8);
+r2 = _mm512_loadu_pd (b + 16);
+r3 = _mm512_loadu_pd (b + 24);
+r4 = _mm512_loadu_pd (b + 32);
+r5 = _mm512_loadu_pd (b + 40);
+r6 = _mm512_loadu_pd (b + 48);
+r7 = _mm512_loadu_pd (b + 56);
+
+/* even (odd) columns of two neighbouring rows, interleaved */
+u0 = _mm512_unpacklo_pd (r0, r1);
+u1 = _mm512_unpackhi_pd (r0, r1);
+u2 = _mm512_unpacklo_pd (r2, r3);
+u3 = _mm512_unpackhi_pd (r2, r3);
+u4 = _mm512_unpacklo_pd (r4, r5);
+u5 = _mm512_unpackhi_pd (r4, r5);
+u6 = _mm512_unpacklo_pd (r6, r7);
+u7 = _mm512_unpackhi_pd (r6, r7);
+
+/* columns (0,4), (1,5), (2,6), (3,7) of four rows each */
+r0 = _mm512_permutex2var_pd (u0, lo2, u2);
+r1 = _mm512_permutex2var_pd (u1, lo2, u3);
+r2 = _mm512_permutex2var_pd (u0, hi2, u2);
+r3 = _mm512_permutex2var_pd (u1, hi2, u3);
+r4 = _mm512_permutex2var_pd (u4, lo2, u6);
+r5 = _mm512_permutex2var_pd (u5, lo2, u7);
+r6 = _mm512_permutex2var_pd (u4, hi2, u6);
+r7 = _mm512_permutex2var_pd (u5, hi2, u7);
+
+/* whole columns */
+_mm512_storeu_pd (t,      _mm512_permutex2var_pd (r0, lo4, r4));
+_mm512_storeu_pd (t + 8,  _mm512_permutex2var_pd (r1, lo4, r5));
+_mm512_storeu_pd (t + 16, _mm512_permutex2var_pd (r2, lo4, r6));
+_mm512_storeu_pd (t + 24, _mm512_permutex2var_pd (r3, lo4, r7));
+_mm512_storeu_pd (t + 32, _mm512_permutex2var_pd (r0, hi4, r4));
+_mm512_storeu_pd (t + 40, _mm512_permutex2var_pd (r1, hi4, r5));
+_mm512_storeu_pd (t + 48, _mm512_permutex2var_pd (r2, hi4, r6));
+_mm512_storeu_pd (t + 56, _mm512_permutex2var_pd (r3, hi4, r7));
+
+return;
+
+}  /* transpose_avx512 */
+
+#endif
+
+/*--------------------------------------------------------------------------*/
+
+/* one forward and one inverse kernel per instruction set; the bodies are
+   the same, only the vector width chosen by the compiler differs */
+#define BLOCK_KERNEL(name, inverse, transpose)                              \
+static void name (double *b)                                               \
+{                                                                          \
+double  t[64];                                                             \
+butterfly_columns (b, inverse);                                            \
+transpose (b, t);                                                          \
+butterfly_columns (t, inverse);                                            \
+transpose (t, b);                                                          \
+return;                                                                    \
+}
+
+BLOCK_KERNEL (block_dct_generic, 0, transpose_block)
+BLOCK_KERNEL (block_idct_generic, 1, transpose_block)
+
+#if defined(DCT_X86)
+__attribute__((target("avx2"), optimize("fp-contract=off,tree-vectorize")))
+BLOCK_KERNEL (block_dct_avx2, 0, transpose_avx2)
+__attribute__((target("avx2"), optimize("fp-contract=off,tree-vectorize")))
+BLOCK_KERNEL (block_idct_avx2, 1, transpose_avx2)
+__attribute__((target("avx512f"), optimize("fp-contract=off,tree-vectorize")))
+BLOCK_KERNEL (block_dct_avx512, 0, transpose_avx512)
+__attribute__((target("avx512f"), optimize("fp-contract=off,tree-vectorize")))
+BLOCK_KERNEL (block_idct_avx512, 1, transpose_avx512)
+#endif
+
+/*--------------------------------------------------------------------------*/
+
+static block_kernel    kf = NULL;      /* chosen forward kernel */
+static block_kernel    ki = NULL;      /* chosen inverse kernel */
+static pthread_once_t  kernels_once = PTHREAD_ONCE_INIT;
+
+/*--------------------------------------------------------------------------*/
+
+static void choose_block_kernels (void)
+
+/*
+  chooses the kernels for the widest vectors the processor supports;
+  runs exactly once, via pthread_once
+*/
+
+{
+ki = block_idct_generic;
+kf = block_dct_generic;
+#if defined(DCT_X86)
+__builtin_cpu_init ();
+if (__builtin_cpu_supports ("avx2"))
+   {
+   ki = block_idct_avx2;
+   kf = block_dct_avx2;
+   }
+if (__builtin_cpu_supports ("avx512f"))
+   {
+   ki = block_idct_avx512;
+   kf = block_dct_avx512;
+   }
+#endif
+
+return;
+
+}  /* choose_block_kernels */
+
+/*--------------------------------------------------------------------------*/
+
+static void select_block_kernels
+
+     (block_kernel  *fwd,     /* forward kernel, output */
+      block_kernel  *inv)     /* inverse kernel, output */
+
+/*
+  returns the kernels for the widest vectors the processor supports; the
+  first call makes the choice, also if it comes from several threads of
+  parallel_rows at once
+*/
+
+{
+pthread_once (&kernels_once, choose_block_kernels);
+
+*fwd = kf;
+*inv = ki;
+return;
+
+}  /* select_block_kernels */
+
+/*--------------------------------------------------------------------------*/
+
+void dct8x8
+
+     (double  *b)        /* 8x8 block, row-major, in and out */
+
+/*
+  orthonormal 2-D DCT of an 8x8 block in place, same result as dct2d;
+  coefficient (p,q) is stored at b[8q+p]
+*/
+
+{
+block_kernel  fwd, inv;    /* kernels */
+
+select_block_kernels (&fwd, &inv);
+fwd (b);
+
+return;
+
+}  /* dct8x8 */
+
+/*--------------------------------------------------------------------------*/
+
+void idct8x8
+
+     (double  *b)        /* 8x8 block of coefficients, in and out */
+
+/*
+  inverse of dct8x8 in place
+*/
+
+{
+block_kernel  fwd, inv;    /* kernels */
+
+select_block_kernels (&fwd, &inv);
+inv (b);
+
+return;
+
+}  /* idct8x8 */
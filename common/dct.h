@@ -0,0 +1,64 @@
+#ifndef DCT_H
+#define DCT_H
+
+/*--------------------------------------------------------------------------*/
+/*                                                                          */
+/*                        DISCRETE COSINE TRANSFORM                         */
+/*                                                                          */
+/*--------------------------------------------------------------------------*/
+
+/*
+  Orthonormal 2-D DCT-II and its inverse (DCT-III) of images of any size
+  in O(n log n) per row and column:
+
+    c_p = w_p sum_m u_m cos (pi (2m+1) p / 2n),
+    w_0 = sqrt (1/n),  w_p = sqrt (2/n)  for p > 0,
+
+  applied in x and then in y direction.
+  Following Makhoul, a DCT of length n is one complex FFT of length n of
+  the reordered signal (even samples ascending, odd samples descending),
+  followed by a rotation with the cosine / sine table exp (-i pi p / 2n).
+  Two real signals share one complex FFT: two neighbouring rows in x
+  direction, the left and the right half of the image in y direction,
+  where the columns are transformed with the blocked fft_columns.
+  Images with both sides up to 16 (e.g. 8x8 blocks) are transformed by
+  two products with the DCT matrix instead.
+  The cosine tables are computed once per length and cached.
+  dct8x8 and idct8x8 transform one 8x8 block of doubles (row-major, e.g.
+  on the stack) in place with the even/odd butterflies of the 8-point DCT
+  (22 instead of 64 multiplications per row); each butterfly works on a
+  whole block row at once, i.e. one AVX-512 register, and the kernel for
+  the widest vectors of the processor is chosen at run time.
+  Requires image.h and fft.h.
+*/
+
+/*--------------------------------------------------------------------------*/
+
+/* precomputed data for transforms of one length */
+typedef struct
+   {
+   long      n;          /* signal length */
+   fft_plan  *fft;       /* FFT plan of length n */
+   double    *c, *s;     /* cos (pi p / 2n), sin (pi p / 2n) */
+   double    *m;         /* n <= 16: DCT matrix w_p cos (pi (2m+1) p / 2n),
+                            row p, otherwise NULL */
+   } dct_plan;
+
+/*--------------------------------------------------------------------------*/
+
+dct_plan *dct_plan_cached
+     (long n);
+
+void dct2d
+     (image *u, image *c);
+
+void idct2d
+     (image *c, image *u);
+
+void dct8x8
+     (double *b);
+
+void idct8x8
+     (double *b);
+
+#endif
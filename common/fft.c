@@ -0,0 +1,967 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <pthread.h>
+
+#include "image.h"
+#include "parallel.h"
+#include "fft.h"
+
+/*--------------------------------------------------------------------------*/
+/*                                                                          */
+/*                         FAST FOURIER TRANSFORM                           */
+/*                                                                          */
+/*--------------------------------------------------------------------------*/
+
+/*
+  mixed-radix (2, 3, 4, 5, 7) Stockham FFT and Bluestein FFT with
+  reusable plans
+*/
+
+/*--------------------------------------------------------------------------*/
+
+#define FFT_CACHE_SIZE  32    /* number of cached plans */
+#define FFT_BLOCK        8    /* columns per block: one cache line */
+
+#ifndef M_PI
+#define M_PI  3.14159265358979323846
+#endif
+
+/*--------------------------------------------------------------------------*/
+
+static double *alloc_vector
+
+     (long  n)           /* number of entries */
+
+/*
+  allocates a double vector of size n
+*/
+
+{
+double  *v;    /* vector */
+
+v = (double *) malloc ((size_t)(n > 0 ? n : 1) * sizeof(double));
+if (v == NULL)
+   {
+   printf("fft: not enough memory available\n");
+   exit(1);
+   }
+
+return (v);
+
+}  /* alloc_vector */
+
+/*--------------------------------------------------------------------------*/
+
+static long factorise
+
+     (long  n,           /* signal length */
+      long  *factor)     /* radices, output */
+
+/*
+  splits n into the radices 4, 2, 3, 5, 7 (in this order);
+  returns the number of radices, or -1 if n has another prime factor
+*/
+
+{
+static const long  radix[5] = {4, 2, 3, 5, 7};   /* supported radices */
+long               nf = 0;                       /* number of factors */
+long               k;                            /* loop variable */
+
+for (k=0; k<5; k++)
+    while (n % radix[k] == 0)
+       {
+       factor[nf++] = radix[k];
+       n = n / radix[k];
+       }
+
+return ((n == 1) ? nf : -1);
+
+}  /* factorise */
+
+/*--------------------------------------------------------------------------*/
+
+static void twiddles
+
+     (long    n,         /* signal length */
+      double  *twr,      /* real parts of exp(-2 pi i t/n), output */
+      double  *twi)      /* imaginary parts, output */
+
+/*
+  tabulates the n-th roots of unity; every entry is computed directly to
+  avoid the error growth of a recursion
+*/
+
+{
+long    t;       /* loop variable */
+double  help;    /* time saver */
+
+help = -2.0 * M_PI / (double) n;
+for (t=0; t<n; t++)
+    {
+    twr[t] = cos (help * t);
+    twi[t] = sin (help * t);
+    }
+
+return;
+
+}  /* twiddles */
+
+/*--------------------------------------------------------------------------*/
+
+static void stage
+
+     (long          n,      /* length of the current subtransforms */
+      long          s,      /* stride = number of subtransforms */
+      long          p,      /* radix */
+      long          N,      /* full signal length */
+      const double  *twr,   /* roots of unity of order N, real part */
+      const double  *twi,   /* roots of unity of order N, imag. part */
+      const double  *xr,    /* input, real part */
+      const double  *xi,    /* input, imaginary part */
+      double        *yr,    /* output, real part */
+      double        *yi)    /* output, imaginary part */
+
+/*
+  one decimation-in-frequency Stockham step with radix p:
+  y[t+s*(p*q+k)] = W_n^(qk) * sum_r x[t+s*(q+r*m)] W_p^(rk),  m = n/p
+*/
+
+{
+long    m;                      /* n / p */
+long    q, t, r, k;             /* loop variables */
+long    in, out;                /* indices */
+long    step;                   /* N / p, index of W_p in the table */
+double  ar[7], ai[7];           /* inputs of one butterfly */
+double  br, bi;                 /* output of one butterfly */
+double  wr, wi;                 /* twiddle factor */
+double  h1r, h1i, h2r, h2i;     /* for radix 4 */
+double  h3r, h3i, h4r, h4i;     /* for radix 4 */
+
+m    = n / p;
+step = N / p;
+
+for (q=0; q<m; q++)
+ for (t=0; t<s; t++)
+     {
+     /* load */
+     in = t + s * q;
+     for (r=0; r<p; r++)
+         {
+         ar[r] = xr[in + r * s * m];
+         ai[r] = xi[in + r * s * m];
+         }
+     out = t + s * p * q;
+
+     if (p == 2)
+        {
+        yr[out] = ar[0] + ar[1];
+        yi[out] = ai[0] + ai[1];
+        br = ar[0] - ar[1];
+        bi = ai[0] - ai[1];
+        wr = twr[q * s];
+        wi = twi[q * s];
+        yr[out + s] = br * wr - bi * wi;
+        yi[out + s] = br * wi + bi * wr;
+        }
+     else if (p == 4)
+        {
+        h1r = ar[0] + ar[2];   h1i = ai[0] + ai[2];
+        h2r = ar[0] - ar[2];   h2i = ai[0] - ai[2];
+        h3r = ar[1] + ar[3];   h3i = ai[1] + ai[3];
+        h4r = ar[1] - ar[3];   h4i = ai[1] - ai[3];
+
+        yr[out] = h1r + h3r;
+        yi[out] = h1i + h3i;
+        for (k=1; k<4; k++)
+            {
+            if (k == 1)
+               {
+               br = h2r + h4i;   bi = h2i - h4r;    /* h2 - i h4 */
+               }
+            else if (k == 2)
+               {
+               br = h1r - h3r;   bi = h1i - h3i;
+               }
+            else
+               {
+               br = h2r - h4i;   bi = h2i + h4r;    /* h2 + i h4 */
+               }
+            wr = twr[q * k * s];
+            wi = twi[q * k * s];
+            yr[out + k * s] = br * wr - bi * wi;
+            yi[out + k * s] = br * wi + bi * wr;
+            }
+        }
+     else
+        {
+        /* radix 3, 5, 7: direct small DFT */
+        for (k=0; k<p; k++)
+            {
+            br = ar[0];
+            bi = ai[0];
+            for (r=1; r<p; r++)
+                {
+                wr = twr[((r * k) % p) * step];
+                wi = twi[((r * k) % p) * step];
+                br = br + ar[r] * wr - ai[r] * wi;
+                bi = bi + ar[r] * wi + ai[r] * wr;
+                }
+            wr = twr[q * k * s];
+            wi = twi[q * k * s];
+            yr[out + k * s] = br * wr - bi * wi;
+            yi[out + k * s] = br * wi + bi * wr;
+            }
+        }
+     }
+
+return;
+
+}  /* stage */
+
+/*--------------------------------------------------------------------------*/
+
+static void mixed_radix
+
+     (const fft_plan  *p,    /* plan with radices and roots of unity */
+      double          *vr,   /* real part of signal / Fourier coeff. */
+      double          *vi,   /* imaginary part of signal / Fourier coeff. */
+      double          *work) /* scratch vector of size 2n */
+
+/*
+  unnormalised forward FFT (Stockham autosort, no bit reversal)
+*/
+
+{
+long    n = p->n;            /* signal length */
+long    k;                   /* loop variable */
+long    len, s;              /* current length and stride */
+double  *xr, *xi;            /* source of the current stage */
+double  *yr, *yi;            /* destination of the current stage */
+double  *swp;                /* for pointer swapping */
+
+xr = vr;    xi = vi;
+yr = work;  yi = work + n;
+len = n;
+s   = 1;
+for (k=0; k<p->nf; k++)
+    {
+    stage (len, s, p->factor[k], n, p->twr, p->twi, xr, xi, yr, yi);
+    len = len / p->factor[k];
+    s   = s * p->factor[k];
+    swp = xr;  xr = yr;  yr = swp;
+    swp = xi;  xi = yi;  yi = swp;
+    }
+
+/* result in scratch vector? */
+if (xr != vr)
+   for (k=0; k<n; k++)
+       {
+       vr[k] = xr[k];
+       vi[k] = xi[k];
+       }
+
+return;
+
+}  /* mixed_radix */
+
+/*--------------------------------------------------------------------------*/
+
+static void bluestein
+
+     (const fft_plan  *p,    /* plan with chirp and transformed kernel */
+      double          *vr,   /* real part of signal / Fourier coeff. */
+      double          *vi,   /* imaginary part of signal / Fourier coeff. */
+      double          *work) /* scratch vector of size 4m */
+
+/*
+  unnormalised forward DFT of arbitrary length by Bluestein's algorithm:
+  with the chirp w_k = exp(-i pi k^2/n), the transform is w times the
+  cyclic convolution of (f w) and conj(w), evaluated by power-of-2 FFTs;
+  the transformed convolution kernel is part of the plan
+*/
+
+{
+long    n = p->n;                /* signal length */
+long    m = p->m;                /* length of the convolution */
+long    k;                       /* loop variable */
+double  *ar, *ai;                /* modulated signal */
+double  hr, hi;                  /* auxiliary variables */
+
+ar = work;
+ai = work + m;
+
+/* modulated signal, zero-padded to length m */
+for (k=0; k<n; k++)
+    {
+    ar[k] = vr[k] * p->cr[k] - vi[k] * p->ci[k];
+    ai[k] = vr[k] * p->ci[k] + vi[k] * p->cr[k];
+    }
+for (k=n; k<m; k++)
+    ar[k] = ai[k] = 0.0;
+
+/* cyclic convolution: forward transform, product, backtransform */
+mixed_radix (p->sub, ar, ai, work + 2 * m);
+for (k=0; k<m; k++)
+    {
+    hr = ar[k] * p->br[k] - ai[k] * p->bi[k];
+    hi = ar[k] * p->bi[k] + ai[k] * p->br[k];
+    ar[k] =  hr;
+    ai[k] = -hi;                       /* conjugate for backtransform */
+    }
+mixed_radix (p->sub, ar, ai, work + 2 * m);
+
+/* demodulate; the conjugation completes the backtransform */
+for (k=0; k<n; k++)
+    {
+    hr =  ar[k];
+    hi = -ai[k];
+    vr[k] = hr * p->cr[k] - hi * p->ci[k];
+    vi[k] = hr * p->ci[k] + hi * p->cr[k];
+    }
+
+return;
+
+}  /* bluestein */
+
+/*--------------------------------------------------------------------------*/
+
+fft_plan *fft_plan_create
+
+     (long  n)           /* signal length (>0) */
+
+/*
+  prepares the transform of length n: radices and roots of unity, and for
+  lengths with prime factors above 7 the chirp and the transformed kernel
+  of Bluestein's algorithm; allocates memory for the plan
+*/
+
+{
+fft_plan  *p;          /* plan */
+long      m;           /* power of 2 >= 2n-1 */
+long      k;           /* loop variable */
+double    help;        /* auxiliary variable */
+double    *work;       /* scratch vector */
+
+p = (fft_plan *) malloc (sizeof(fft_plan));
+if (p == NULL)
+   {
+   printf("fft_plan_create: not enough memory available\n");
+   exit(1);
+   }
+
+p->n   = n;
+p->m   = 0;
+p->sub = NULL;
+p->twr = p->twi = p->cr = p->ci = p->br = p->bi = NULL;
+p->nf  = factorise (n, p->factor);
+
+if (p->nf >= 0)
+   {
+   /* mixed radix */
+   p->twr     = alloc_vector (n);
+   p->twi     = alloc_vector (n);
+   twiddles (n, p->twr, p->twi);
+   p->scratch = 2 * n;
+   return (p);
+   }
+
+/* Bluestein */
+m = 1;
+while (m < 2 * n - 1)
+   m = 2 * m;
+p->m       = m;
+p->sub     = fft_plan_create (m);
+p->scratch = 4 * m;
+p->cr      = alloc_vector (n);
+p->ci      = alloc_vector (n);
+p->br      = alloc_vector (m);
+p->bi      = alloc_vector (m);
+
+/* chirp; k^2 is reduced mod 2n so that the angle stays small */
+for (k=0; k<n; k++)
+    {
+    help     = -M_PI * (double)((k * k) % (2 * n)) / (double) n;
+    p->cr[k] = cos (help);
+    p->ci[k] = sin (help);
+    }
+
+/* kernel conj(w), cyclically extended to length m, transformed; */
+/* scaled by 1/m for the backtransform */
+for (k=0; k<m; k++)
+    p->br[k] = p->bi[k] = 0.0;
+for (k=0; k<n; k++)
+    {
+    p->br[k] =  p->cr[k] / m;
+    p->bi[k] = -p->ci[k] / m;
+    if (k > 0)
+       {
+       p->br[m-k] = p->br[k];
+       p->bi[m-k] = p->bi[k];
+       }
+    }
+work = alloc_vector (2 * m);
+mixed_radix (p->sub, p->br, p->bi, work);
+free (work);
+
+return (p);
+
+}  /* fft_plan_create */
+
+/*--------------------------------------------------------------------------*/
+
+void fft_plan_free
+
+     (fft_plan  *p)      /* plan */
+
+/*
+  frees the memory of a plan from fft_plan_create
+*/
+
+{
+if (p->sub != NULL)
+   fft_plan_free (p->sub);
+free (p->twr);
+free (p->twi);
+free (p->cr);
+free (p->ci);
+free (p->br);
+free (p->bi);
+free (p);
+
+return;
+
+}  /* fft_plan_free */
+
+/*--------------------------------------------------------------------------*/
+
+fft_plan *fft_plan_cached
+
+     (long  n)           /* signal length (>0) */
+
+/*
+  returns a shared plan for length n; it is created on first request and
+  kept until the program ends, so all images of the same size (e.g. the
+  jobs of a batch run) use the same plan; safe to call from several
+  threads
+*/
+
+{
+static pthread_mutex_t  lock = PTHREAD_MUTEX_INITIALIZER;
+static fft_plan         *cache[FFT_CACHE_SIZE];   /* cached plans */
+static long             n_cached = 0;             /* number of plans */
+fft_plan                *p = NULL;                /* plan */
+long                    k;                        /* loop variable */
+
+pthread_mutex_lock (&lock);
+
+for (k=0; k<n_cached; k++)
+    if (cache[k]->n == n)
+       p = cache[k];
+
+if (p == NULL)
+   {
+   p = fft_plan_create (n);
+   if (n_cached < FFT_CACHE_SIZE)
+      cache[n_cached++] = p;
+   else
+      {
+      /* replace the oldest plan; earlier callers may still use it */
+      /* until they finish, so it is not freed */
+      for (k=1; k<FFT_CACHE_SIZE; k++)
+          cache[k-1] = cache[k];
+      cache[FFT_CACHE_SIZE-1] = p;
+      }
+   }
+
+pthread_mutex_unlock (&lock);
+
+return (p);
+
+}  /* fft_plan_cached */
+
+/*--------------------------------------------------------------------------*/
+
+void fft_execute
+
+     (const fft_plan  *p,    /* plan for the signal length */
+      double          *vr,   /* real part of signal / Fourier coeff. */
+      double          *vi,   /* imaginary part of signal / Fourier coeff. */
+      double          *work) /* scratch vector of size p->scratch, or NULL */
+
+/*
+  unitary discrete Fourier transform of a complex 1-D signal;
+  the plan is not changed, so several threads may use it at the same time
+  as long as each one passes its own scratch vector
+*/
+
+{
+long    n = p->n;    /* signal length */
+long    k;           /* loop variable */
+double  help;        /* normalisation factor */
+double  *own;        /* scratch vector allocated here */
+
+if (n <= 1)
+   return;
+
+own = NULL;
+if (work == NULL)
+   work = own = alloc_vector (p->scratch);
+
+if (p->nf >= 0)
+   mixed_radix (p, vr, vi, work);
+else
+   bluestein (p, vr, vi, work);
+
+help = 1.0 / sqrt ((double) n);
+for (k=0; k<n; k++)
+    {
+    vr[k] = vr[k] * help;
+    vi[k] = vi[k] * help;
+    }
+
+free (own);
+return;
+
+}  /* fft_execute */
+
+/*--------------------------------------------------------------------------*/
+
+void fft
+
+     (double  *vr,       /* real part of signal / Fourier coeff. */
+      double  *vi,       /* imaginary part of signal / Fourier coeff. */
+      long    n)         /* signal length (>0) */
+
+/*
+  unitary discrete Fourier transform of a complex 1-D signal of arbitrary
+  length in O(n log n); convenience wrapper around a cached plan
+*/
+
+{
+fft_execute (fft_plan_cached (n), vr, vi, NULL);
+
+return;
+
+}  /* fft */
+
+/*--------------------------------------------------------------------------*/
+/*                                                                          */
+/*                       TRANSFORMS OF IMAGE ROWS AND COLUMNS               */
+/*                                                                          */
+/*--------------------------------------------------------------------------*/
+
+typedef struct
+   {
+   image     *ur, *ui;     /* real / imaginary image or Fourier data */
+   image     *u;           /* real image (real transforms) */
+   fft_plan  *plan;        /* FFT plan for the current direction */
+   double    sign;         /* factor of the odd rows (real transforms) */
+   } fft_task;
+
+/*--------------------------------------------------------------------------*/
+
+static void rows_kernel
+
+     (long  first,       /* first row */
+      long  last,        /* last row */
+      void  *arg)        /* fft_task */
+
+/*
+  transforms the rows first,...,last; each row is copied into a double
+  vector, so that the FFT is computed in double for any pixel type
+*/
+
+{
+fft_task  *t = (fft_task *) arg;   /* task */
+long      h = t->ur->halo;         /* width of boundary layer */
+long      n = t->ur->nx;           /* row length */
+long      i, j;                    /* loop variables */
+pixel     *pr, *pi;                /* current row */
+double    *vr, *vi;                /* row in double */
+double    *work;                   /* scratch vector of the FFT */
+
+vr   = alloc_vector (n);
+vi   = alloc_vector (n);
+work = alloc_vector (t->plan->scratch);
+
+for (j=first; j<=last; j++)
+    {
+    pr = ROW(t->ur,j) + h;
+    pi = ROW(t->ui,j) + h;
+    for (i=0; i<n; i++)
+        {
+        vr[i] = pr[i];
+        vi[i] = pi[i];
+        }
+    fft_execute (t->plan, vr, vi, work);
+    for (i=0; i<n; i++)
+        {
+        pr[i] = vr[i];
+        pi[i] = vi[i];
+        }
+    }
+
+free (vr);
+free (vi);
+free (work);
+return;
+
+}  /* rows_kernel */
+
+/*--------------------------------------------------------------------------*/
+
+static void columns_kernel
+
+     (long  first,       /* first block of columns */
+      long  last,        /* last block of columns */
+      void  *arg)        /* fft_task */
+
+/*
+  transforms the column blocks first,...,last; the FFT_BLOCK columns of a
+  block are read row by row (one cache line per row) into a tile of
+  contiguous vectors, transformed and written back the same way, so that
+  the image is only accessed with unit stride
+*/
+
+{
+fft_task  *t = (fft_task *) arg;   /* task */
+long      h = t->ur->halo;         /* width of boundary layer */
+long      nx = t->ur->nx;          /* number of columns */
+long      ny = t->ur->ny;          /* column length */
+long      p, j, b;                 /* block, loop variables */
+long      i0, nb;                  /* first column and width of a block */
+pixel     *pr, *pi;                /* pointers into a row */
+double    *tr, *ti;                /* tile, column b at offset b * ny */
+double    *work;                   /* scratch vector of the FFT */
+
+tr   = alloc_vector (FFT_BLOCK * ny);
+ti   = alloc_vector (FFT_BLOCK * ny);
+work = alloc_vector (t->plan->scratch);
+
+for (p=first; p<=last; p++)
+    {
+    i0 = p * FFT_BLOCK;
+    nb = (nx - i0 < FFT_BLOCK) ? nx - i0 : FFT_BLOCK;
+
+    /* gather */
+    for (j=0; j<ny; j++)
+        {
+        pr = ROW(t->ur,j+h) + h + i0;
+        pi = ROW(t->ui,j+h) + h + i0;
+        for (b=0; b<nb; b++)
+            {
+            tr[b*ny+j] = pr[b];
+            ti[b*ny+j] = pi[b];
+            }
+        }
+
+    for (b=0; b<nb; b++)
+        fft_execute (t->plan, tr + b * ny, ti + b * ny, work);
+
+    /* scatter */
+    for (j=0; j<ny; j++)
+        {
+        pr = ROW(t->ur,j+h) + h + i0;
+        pi = ROW(t->ui,j+h) + h + i0;
+        for (b=0; b<nb; b++)
+            {
+            pr[b] = tr[b*ny+j];
+            pi[b] = ti[b*ny+j];
+            }
+        }
+    }
+
+free (tr);
+free (ti);
+free (work);
+return;
+
+}  /* columns_kernel */
+
+/*--------------------------------------------------------------------------*/
+
+void fft_rows
+
+     (image  *ur,        /* real part of image / Fourier coeff. */
+      image  *ui)        /* imaginary part of image / Fourier coeff. */
+
+/*
+  Fourier transform of all rows (x direction) of a complex image
+*/
+
+{
+fft_task  t;    /* rows to be transformed */
+
+t.ur   = ur;
+t.ui   = ui;
+t.plan = fft_plan_cached (ur->nx);
+parallel_rows (ur->halo, ur->halo + ur->ny - 1, rows_kernel, &t);
+
+return;
+
+}  /* fft_rows */
+
+/*--------------------------------------------------------------------------*/
+
+void fft_columns
+
+     (image  *ur,        /* real part of image / Fourier coeff. */
+      image  *ui)        /* imaginary part of image / Fourier coeff. */
+
+/*
+  Fourier transform of all columns (y direction) of a complex image
+*/
+
+{
+fft_task  t;    /* columns to be transformed */
+
+t.ur   = ur;
+t.ui   = ui;
+t.plan = fft_plan_cached (ur->ny);
+parallel_rows (0, (ur->nx - 1) / FFT_BLOCK, columns_kernel, &t);
+
+return;
+
+}  /* fft_columns */
+
+/*--------------------------------------------------------------------------*/
+
+static void real_rows_kernel
+
+     (long  first,       /* first pair of rows */
+      long  last,        /* last pair of rows */
+      void  *arg)        /* fft_task */
+
+/*
+  transforms the real rows 2p and 2p+1 (p = first,...,last, counted from
+  0) with one complex FFT of z = a + i b and separates the two half
+  spectra: A_k = (Z_k + conj Z_(n-k)) / 2, B_k = (Z_k - conj Z_(n-k)) / 2i;
+  the odd rows are multiplied by t->sign
+*/
+
+{
+fft_task  *t = (fft_task *) arg;   /* task */
+image     *u = t->u;               /* real image */
+long      n = u->nx;               /* row length */
+long      nh = n / 2 + 1;          /* length of the half spectrum */
+long      hu = u->halo;            /* boundary layer of u */
+long      hf = t->ur->halo;        /* boundary layer of the spectrum */
+long      p, k, ja, jb;            /* pair, frequency, rows */
+double    *zr, *zi;                /* z = a + i b */
+double    *work;                   /* scratch vector of the FFT */
+pixel     *a, *b;                  /* real rows */
+double    sr, si, dr, di;          /* sum and difference */
+
+zr   = alloc_vector (n);
+zi   = alloc_vector (n);
+work = alloc_vector (t->plan->scratch);
+
+for (p=first; p<=last; p++)
+    {
+    ja = 2 * p;
+    jb = 2 * p + 1;
+    a  = ROW(u,ja+hu) + hu;
+    b  = (jb < u->ny) ? ROW(u,jb+hu) + hu : NULL;
+    for (k=0; k<n; k++)
+        {
+        zr[k] = a[k];
+        zi[k] = (b != NULL) ? t->sign * b[k] : 0.0;
+        }
+
+    fft_execute (t->plan, zr, zi, work);
+
+    for (k=0; k<nh; k++)
+        {
+        sr = zr[k] + zr[(n-k)%n];
+        si = zi[k] - zi[(n-k)%n];
+        dr = zr[k] - zr[(n-k)%n];
+        di = zi[k] + zi[(n-k)%n];
+        PIX(t->ur,k+hf,ja+hf) = 0.5 * sr;
+        PIX(t->ui,k+hf,ja+hf) = 0.5 * si;
+        if (b != NULL)
+           {
+           PIX(t->ur,k+hf,jb+hf) =  0.5 * di;
+           PIX(t->ui,k+hf,jb+hf) = -0.5 * dr;
+           }
+        }
+    }
+
+free (zr);
+free (zi);
+free (work);
+return;
+
+}  /* real_rows_kernel */
+
+/*--------------------------------------------------------------------------*/
+
+static void real_rows_inverse_kernel
+
+     (long  first,       /* first pair of rows */
+      long  last,        /* last pair of rows */
+      void  *arg)        /* fft_task */
+
+/*
+  inverse of real_rows_kernel: combines the Hermitian half spectra A, B of
+  the rows 2p and 2p+1 to Z = A + i B, backtransforms Z and returns
+  a = Re z and b = t->sign * Im z
+*/
+
+{
+fft_task  *t = (fft_task *) arg;   /* task */
+image     *u = t->u;               /* real image */
+long      n = u->nx;               /* row length */
+long      nh = n / 2 + 1;          /* length of the half spectrum */
+long      hu = u->halo;            /* boundary layer of u */
+long      hf = t->ur->halo;        /* boundary layer of the spectrum */
+long      p, k, kk, ja, jb;        /* pair, frequencies, rows */
+double    *zr, *zi;                /* Z = A + i B */
+double    *work;                   /* scratch vector of the FFT */
+double    ar, ai, br, bi;          /* A_k, B_k */
+long      pair;                    /* second row present? */
+
+zr   = alloc_vector (n);
+zi   = alloc_vector (n);
+work = alloc_vector (t->plan->scratch);
+
+for (p=first; p<=last; p++)
+    {
+    ja   = 2 * p;
+    jb   = 2 * p + 1;
+    pair = (jb < u->ny);
+
+    for (k=0; k<n; k++)
+        {
+        /* Hermitian extension: X_k = conj X_(n-k) for k >= nh */
+        kk = (k < nh) ? k : n - k;
+        ar = PIX(t->ur,kk+hf,ja+hf);
+        ai = PIX(t->ui,kk+hf,ja+hf);
+        br = pair ? PIX(t->ur,kk+hf,jb+hf) : 0.0;
+        bi = pair ? PIX(t->ui,kk+hf,jb+hf) : 0.0;
+        if (k >= nh)
+           {
+           ai = -ai;
+           bi = -bi;
+           }
+        /* conjugate of Z for the backtransform */
+        zr[k] =   ar - bi;
+        zi[k] = -(ai + br);
+        }
+
+    fft_execute (t->plan, zr, zi, work);
+
+    for (k=0; k<n; k++)
+        {
+        PIX(u,k+hu,ja+hu) = zr[k];
+        if (pair)
+           PIX(u,k+hu,jb+hu) = - t->sign * zi[k];
+        }
+    }
+
+free (zr);
+free (zi);
+free (work);
+return;
+
+}  /* real_rows_inverse_kernel */
+
+/*--------------------------------------------------------------------------*/
+
+static void conjugate
+
+     (image  *ui)        /* imaginary part, changed */
+
+/*
+  negates the imaginary part of a complex image
+*/
+
+{
+long  i, j;    /* loop variables */
+long  h;       /* width of boundary layer */
+
+h = ui->halo;
+for (j=h; j<h+ui->ny; j++)
+ for (i=h; i<h+ui->nx; i++)
+     PIX(ui,i,j) = - PIX(ui,i,j);
+
+return;
+
+}  /* conjugate */
+
+/*--------------------------------------------------------------------------*/
+
+void fft2d_real
+
+     (image  *u,         /* real image, unchanged */
+      image  *fr,        /* real part of the half spectrum, output */
+      image  *fi,        /* imaginary part of the half spectrum, output */
+      long   centre)     /* 1: frequency 0 in row ny/2 (ny even) */
+
+/*
+  unitary 2-D Fourier transform of a real image of size nx * ny;
+  only the frequencies 0,...,nx/2 in x direction are stored, the others
+  follow from F(-k) = conj F(k); fr and fi must have size (nx/2+1) * ny;
+  centre = 1 shifts the spectrum cyclically by ny/2 in y direction at no
+  cost: the input rows are modulated with (-1)^j while they are packed
+*/
+
+{
+fft_task  t;    /* rows to be transformed */
+
+if (centre && (u->ny % 2 != 0))
+   {
+   printf("fft2d_real: centring requires an even number of rows\n");
+   exit(1);
+   }
+
+t.u    = u;
+t.ur   = fr;
+t.ui   = fi;
+t.plan = fft_plan_cached (u->nx);
+t.sign = centre ? -1.0 : 1.0;
+parallel_rows (0, (u->ny - 1) / 2, real_rows_kernel, &t);
+
+fft_columns (fr, fi);
+
+return;
+
+}  /* fft2d_real */
+
+/*--------------------------------------------------------------------------*/
+
+void ifft2d_real
+
+     (image  *fr,        /* real part of the half spectrum, destroyed */
+      image  *fi,        /* imaginary part of the half spectrum, destroyed */
+      image  *u,         /* real image of size nx * ny, output */
+      long   centre)     /* 1: frequency 0 in row ny/2 (ny even) */
+
+/*
+  inverse of fft2d_real; the size of u determines nx
+*/
+
+{
+fft_task  t;    /* rows to be transformed */
+
+/* backtransform along y: transform of the complex conjugate data */
+conjugate (fi);
+fft_columns (fr, fi);
+conjugate (fi);
+
+if (centre && (u->ny % 2 != 0))
+   {
+   printf("ifft2d_real: centring requires an even number of rows\n");
+   exit(1);
+   }
+
+t.u    = u;
+t.ur   = fr;
+t.ui   = fi;
+t.plan = fft_plan_cached (u->nx);
+t.sign = centre ? -1.0 : 1.0;
+parallel_rows (0, (u->ny - 1) / 2, real_rows_inverse_kernel, &t);
+
+return;
+
+}  /* ifft2d_real */
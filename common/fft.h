@@ -0,0 +1,76 @@
+#ifndef FFT_H
+#define FFT_H
+
+/*--------------------------------------------------------------------------*/
+/*                                                                          */
+/*                         FAST FOURIER TRANSFORM                           */
+/*                                                                          */
+/*--------------------------------------------------------------------------*/
+
+/*
+  Discrete Fourier transform of complex 1-D signals of any length n in
+  O(n log n): a mixed-radix Stockham FFT for lengths of the form
+  2^a 3^b 5^c 7^d and Bluestein's chirp-z algorithm for all others.
+  The transform is unitary, i.e.
+
+    f^_k = 1/sqrt(n) sum_j f_j exp(-2 pi i jk/n),
+
+  so the backtransform is the transform of the complex conjugate data.
+  A plan holds everything that depends only on n (radices, roots of
+  unity, Bluestein chirp); it is created once and may be executed by
+  several threads at the same time, each with its own scratch vector.
+  The image routines transform all rows or columns in parallel; real
+  images are transformed two rows per complex FFT and only the half
+  spectrum with x frequencies 0,...,nx/2 is stored.
+  Requires image.h.
+*/
+
+/*--------------------------------------------------------------------------*/
+
+#define FFT_MAX_FACTORS  64    /* enough for any long */
+
+/* precomputed data for transforms of one length */
+typedef struct fft_plan
+   {
+   long             n;          /* signal length */
+   long             nf;         /* number of radices, -1: Bluestein */
+   long             factor[FFT_MAX_FACTORS];  /* radices */
+   double           *twr;       /* roots of unity of order n, real part */
+   double           *twi;       /* roots of unity of order n, imag. part */
+   long             m;          /* Bluestein: length of the convolution */
+   struct fft_plan  *sub;       /* Bluestein: plan of length m */
+   double           *cr, *ci;   /* Bluestein: chirp */
+   double           *br, *bi;   /* Bluestein: transformed kernel */
+   long             scratch;    /* size of the scratch vector */
+   } fft_plan;
+
+/*--------------------------------------------------------------------------*/
+
+fft_plan *fft_plan_create
+     (long n);
+
+void fft_plan_free
+     (fft_plan *p);
+
+fft_plan *fft_plan_cached
+     (long n);
+
+void fft_execute
+     (const fft_plan *p, double *vr, double *vi, double *work);
+
+void fft
+     (double *vr, double *vi, long n);
+
+void fft_rows
+     (image *ur, image *ui);
+
+void fft_columns
+     (image *ur, image *ui);
+
+void fft2d_real
+     (image *u, image *fr, image *fi, long centre);
+
+void ifft2d_real
+     (image *fr, image *fi, image *u, long centre);
+
+#endif
@@ -0,0 +1,355 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "image.h"
+#include "parallel.h"
+#include "freqfilter.h"
+
+/*--------------------------------------------------------------------------*/
+/*                                                                          */
+/*                      FILTERS IN THE FOURIER DOMAIN                       */
+/*                                                                          */
+/*--------------------------------------------------------------------------*/
+
+/*
+  transfer functions, cached masks for the half spectrum and their
+  application
+*/
+
+/*--------------------------------------------------------------------------*/
+
+#define FILTER_CACHE_SIZE  8    /* number of cached masks */
+
+#ifndef M_PI
+#define M_PI  3.14159265358979323846
+#endif
+
+/* one cached mask */
+typedef struct
+   {
+   freq_filter  f;          /* filter */
+   long         nx, ny;     /* image size */
+   long         centre;     /* ky = 0 in row ny/2? */
+   double       *mask;      /* (nx/2+1) * ny values, row by row */
+   } mask_entry;
+
+/* data of the parallel loops */
+typedef struct
+   {
+   const freq_filter  *f;       /* filter */
+   long               nh, ny;   /* size of the half spectrum */
+   long               centre;   /* ky = 0 in row ny/2? */
+   double             *mask;    /* mask */
+   image              *fr, *fi; /* half spectrum */
+   } filter_task;
+
+static mask_entry  cache[FILTER_CACHE_SIZE];   /* cached masks */
+static long        n_cached = 0;               /* number of masks */
+static long        cache_next = 0;             /* next entry to replace */
+
+/*--------------------------------------------------------------------------*/
+
+long filter_type
+
+     (const char  *name)    /* name of the filter type */
+
+/*
+  returns the filter type with the given name, -1 if there is none
+*/
+
+{
+if (strcmp (name, "none") == 0)      return (FILTER_NONE);
+if (strcmp (name, "lowpass") == 0)   return (FILTER_LOWPASS);
+if (strcmp (name, "highpass") == 0)  return (FILTER_HIGHPASS);
+if (strcmp (name, "bandpass") == 0)  return (FILTER_BANDPASS);
+if (strcmp (name, "bandstop") == 0)  return (FILTER_BANDSTOP);
+if (strcmp (name, "notch") == 0)     return (FILTER_NOTCH);
+if (strcmp (name, "stripe") == 0)    return (FILTER_STRIPE);
+
+return (-1);
+
+}  /* filter_type */
+
+/*--------------------------------------------------------------------------*/
+
+long filter_shape
+
+     (const char  *name)    /* name of the filter shape */
+
+/*
+  returns the filter shape with the given name, -1 if there is none
+*/
+
+{
+if (strcmp (name, "ideal") == 0)        return (FILTER_IDEAL);
+if (strcmp (name, "butterworth") == 0)  return (FILTER_BUTTERWORTH);
+if (strcmp (name, "gauss") == 0)        return (FILTER_GAUSS);
+
+return (-1);
+
+}  /* filter_shape */
+
+/*--------------------------------------------------------------------------*/
+
+static double reject
+
+     (const freq_filter  *f,    /* filter */
+      double             d)     /* distance from the rejected set */
+
+/*
+  profile that is 0 at distance 0 and tends to 1 beyond the width
+  f->width: ideal step, Butterworth or Gaussian
+*/
+
+{
+double  w = f->width;    /* width */
+
+switch (f->shape)
+   {
+   case FILTER_BUTTERWORTH:
+      if (d == 0.0)
+         return (0.0);
+      return (1.0 / (1.0 + pow (w / d, 2.0 * f->order)));
+   case FILTER_GAUSS:
+      if (w == 0.0)
+         return ((d == 0.0) ? 0.0 : 1.0);
+      return (1.0 - exp (- d * d / (2.0 * w * w)));
+   default:
+      return ((d <= w) ? 0.0 : 1.0);
+   }
+
+}  /* reject */
+
+/*--------------------------------------------------------------------------*/
+
+double filter_response
+
+     (const freq_filter  *f,    /* filter */
+      double             kx,    /* frequency in x direction */
+      double             ky)    /* frequency in y direction */
+
+/*
+  transfer function H(kx,ky) in [0,1]; H(-kx,-ky) = H(kx,ky)
+*/
+
+{
+double  rho;        /* distance from the origin */
+double  r, w, n;    /* radius, width, order */
+double  h;          /* response */
+double  c, s;       /* direction of the stripe */
+double  along;      /* frequency along the stripe */
+
+rho = sqrt (kx * kx + ky * ky);
+r   = f->radius;
+w   = f->width;
+n   = f->order;
+
+switch (f->type)
+   {
+   case FILTER_LOWPASS:
+   case FILTER_HIGHPASS:
+      if (f->shape == FILTER_BUTTERWORTH)
+         h = (r > 0.0) ? 1.0 / (1.0 + pow (rho / r, 2.0 * n))
+                       : ((rho == 0.0) ? 1.0 : 0.0);
+      else if (f->shape == FILTER_GAUSS)
+         h = (r > 0.0) ? exp (- rho * rho / (2.0 * r * r))
+                       : ((rho == 0.0) ? 1.0 : 0.0);
+      else
+         h = (rho <= r) ? 1.0 : 0.0;
+      return ((f->type == FILTER_LOWPASS) ? h : 1.0 - h);
+
+   case FILTER_BANDPASS:
+   case FILTER_BANDSTOP:
+      /* band-stop around rho = r */
+      if (f->shape == FILTER_BUTTERWORTH)
+         h = (rho * rho == r * r) ? 0.0
+             : 1.0 / (1.0 + pow (rho * w / (rho * rho - r * r), 2.0 * n));
+      else if (f->shape == FILTER_GAUSS)
+         h = (rho * w == 0.0) ? ((rho == r) ? 0.0 : 1.0)
+             : 1.0 - exp (- pow ((rho * rho - r * r) / (rho * w), 2.0));
+      else
+         h = (fabs (rho - r) <= 0.5 * w) ? 0.0 : 1.0;
+      return ((f->type == FILTER_BANDSTOP) ? h : 1.0 - h);
+
+   case FILTER_NOTCH:
+      return (reject (f, hypot (kx - f->u0, ky - f->v0))
+              * reject (f, hypot (kx + f->u0, ky + f->v0)));
+
+   case FILTER_STRIPE:
+      c = cos (f->angle * M_PI / 180.0);
+      s = sin (f->angle * M_PI / 180.0);
+      along = kx * c + ky * s;
+      if (fabs (along) < r)
+         return (1.0);
+      return (reject (f, fabs (ky * c - kx * s)));
+
+   default:
+      return (1.0);
+   }
+
+}  /* filter_response */
+
+/*--------------------------------------------------------------------------*/
+
+static void mask_rows
+
+     (long  first,       /* first row */
+      long  last,        /* last row */
+      void  *arg)        /* filter_task */
+
+/*
+  evaluates the transfer function for the rows first,...,last (counted
+  from 0) of the half spectrum
+*/
+
+{
+filter_task  *t = (filter_task *) arg;   /* task */
+long         i, j;                       /* loop variables */
+long         ky;                         /* frequency in y direction */
+
+for (j=first; j<=last; j++)
+    {
+    if (t->centre)
+       ky = j - t->ny / 2;
+    else
+       ky = (j <= t->ny - 1 - t->ny / 2) ? j : j - t->ny;
+    for (i=0; i<t->nh; i++)
+        t->mask[j * t->nh + i] = filter_response (t->f, (double) i,
+                                                  (double) ky);
+    }
+
+return;
+
+}  /* mask_rows */
+
+/*--------------------------------------------------------------------------*/
+
+const double *filter_mask
+
+     (const freq_filter  *f,      /* filter */
+      long               nx,      /* image size in x direction */
+      long               ny,      /* image size in y direction */
+      long               centre)  /* 1: ky = 0 in row ny/2 */
+
+/*
+  returns the values of the transfer function for the half spectrum of an
+  nx * ny image, (nx/2+1) values per row; the mask is computed on first
+  request and cached, the oldest mask is replaced when the cache is full.
+  Not safe to call from several threads; the result is valid until
+  FILTER_CACHE_SIZE further masks have been requested.
+*/
+
+{
+filter_task  t;    /* rows to be evaluated */
+mask_entry   *e;   /* cache entry */
+long         k;    /* loop variable */
+
+for (k=0; k<n_cached; k++)
+    {
+    e = &cache[k];
+    if ((e->nx == nx) && (e->ny == ny) && (e->centre == centre) &&
+        (memcmp (&e->f, f, sizeof(freq_filter)) == 0))
+       return (e->mask);
+    }
+
+/* new entry: free slot or oldest mask */
+if (n_cached < FILTER_CACHE_SIZE)
+   e = &cache[n_cached++];
+else
+   {
+   e = &cache[cache_next];
+   cache_next = (cache_next + 1) % FILTER_CACHE_SIZE;
+   free (e->mask);
+   }
+
+e->f      = *f;
+e->nx     = nx;
+e->ny     = ny;
+e->centre = centre;
+e->mask   = (double *) malloc ((nx / 2 + 1) * ny * sizeof(double));
+if (e->mask == NULL)
+   {
+   printf("filter_mask: not enough memory available\n");
+   exit(1);
+   }
+
+t.f      = f;
+t.nh     = nx / 2 + 1;
+t.ny     = ny;
+t.centre = centre;
+t.mask   = e->mask;
+parallel_rows (0, ny - 1, mask_rows, &t);
+
+return (e->mask);
+
+}  /* filter_mask */
+
+/*--------------------------------------------------------------------------*/
+
+static void multiply_rows
+
+     (long  first,       /* first row */
+      long  last,        /* last row */
+      void  *arg)        /* filter_task */
+
+/*
+  multiplies the rows first,...,last (counted from 0) of the half
+  spectrum by the mask
+*/
+
+{
+filter_task  *t = (filter_task *) arg;   /* task */
+long         h = t->fr->halo;            /* width of boundary layer */
+long         i, j;                       /* loop variables */
+pixel        *pr, *pi;                   /* rows of the half spectrum */
+const double *m;                         /* row of the mask */
+
+for (j=first; j<=last; j++)
+    {
+    pr = ROW(t->fr,j+h) + h;
+    pi = ROW(t->fi,j+h) + h;
+    m  = t->mask + j * t->nh;
+    for (i=0; i<t->nh; i++)
+        {
+        pr[i] = m[i] * pr[i];
+        pi[i] = m[i] * pi[i];
+        }
+    }
+
+return;
+
+}  /* multiply_rows */
+
+/*--------------------------------------------------------------------------*/
+
+void apply_filter
+
+     (const freq_filter  *f,      /* filter */
+      image              *fr,     /* real part of the half spectrum */
+      image              *fi,     /* imaginary part of the half spectrum */
+      long               nx,      /* image size in x direction */
+      long               centre)  /* 1: ky = 0 in row ny/2 */
+
+/*
+  multiplies the half spectrum of an nx * fr->ny image by the transfer
+  function of f
+*/
+
+{
+filter_task  t;    /* rows to be filtered */
+
+if (f->type == FILTER_NONE)
+   return;
+
+t.nh   = nx / 2 + 1;
+t.ny   = fr->ny;
+t.fr   = fr;
+t.fi   = fi;
+t.mask = (double *) filter_mask (f, nx, fr->ny, centre);
+parallel_rows (0, fr->ny - 1, multiply_rows, &t);
+
+return;
+
+}  /* apply_filter */
@@ -0,0 +1,69 @@
+#ifndef FREQFILTER_H
+#define FREQFILTER_H
+
+/*--------------------------------------------------------------------------*/
+/*                                                                          */
+/*                      FILTERS IN THE FOURIER DOMAIN                       */
+/*                                                                          */
+/*--------------------------------------------------------------------------*/
+
+/*
+  Real, point symmetric transfer functions H(kx,ky) for the half spectrum
+  of fft2d_real (x frequencies 0,...,nx/2; with centre = 1 the frequency
+  ky = 0 lies in row ny/2). Frequencies are measured in pixels of the
+  centred spectrum, rho = sqrt(kx^2 + ky^2).
+  types:   low-, high-, band-pass, band-stop (radius r, band width w),
+           notch (rejects the pair +-(u0,v0) within radius w),
+           stripe (rejects a band of half-width w through the origin at
+           the given angle, except for |frequency along the band| < r)
+  shapes:  ideal (0 or 1), Butterworth of order n, Gaussian
+  A mask depends only on the filter and the image size; it is computed
+  once and kept in a small cache, so that filtering many frames of the
+  same size only costs one multiplication per coefficient.
+  Requires image.h.
+*/
+
+/*--------------------------------------------------------------------------*/
+
+#define FILTER_NONE        0
+#define FILTER_LOWPASS     1
+#define FILTER_HIGHPASS    2
+#define FILTER_BANDPASS    3
+#define FILTER_BANDSTOP    4
+#define FILTER_NOTCH       5
+#define FILTER_STRIPE      6
+
+#define FILTER_IDEAL        0
+#define FILTER_BUTTERWORTH  1
+#define FILTER_GAUSS        2
+
+/* description of a filter */
+typedef struct
+   {
+   long    type;       /* FILTER_NONE, FILTER_LOWPASS, ... */
+   long    shape;      /* FILTER_IDEAL, FILTER_BUTTERWORTH, FILTER_GAUSS */
+   double  radius;     /* cut-off or centre frequency r */
+   double  width;      /* band width, notch radius, stripe half-width w */
+   double  order;      /* order n of the Butterworth filter */
+   double  angle;      /* stripe: angle to the kx axis in degrees */
+   double  u0, v0;     /* notch: frequency */
+   } freq_filter;
+
+/*--------------------------------------------------------------------------*/
+
+long filter_type
+     (const char *name);
+
+long filter_shape
+     (const char *name);
+
+double filter_response
+     (const freq_filter *f, double kx, double ky);
+
+const double *filter_mask
+     (const freq_filter *f, long nx, long ny, long centre);
+
+void apply_filter
+     (const freq_filter *f, image *fr, image *fi, long nx, long centre);
+
+#endif
@@ -0,0 +1,1629 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <pthread.h>
+
+#include "image.h"
+#include "parallel.h"
+#include "fft.h"
+#include "gauss.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GAUSS_X86
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/*--------------------------------------------------------------------------*/
+/*                                                                          */
+/*                          GAUSSIAN CONVOLUTION                            */
+/*                                                                          */
+/*--------------------------------------------------------------------------*/
+
+/*
+  separable Gaussian convolution with reflecting or Dirichlet boundary
+  conditions: direct convolution with a truncated and resampled Gaussian
+  for short kernels, multiplication with the Gaussian transfer function in
+  the Fourier domain for long ones
+*/
+
+/*--------------------------------------------------------------------------*/
+
+#define GAUSS_STRIP  16    /* columns per strip in the y convolution */
+
+#ifndef M_PI
+#define M_PI  3.14159265358979323846
+#endif
+
+/*--------------------------------------------------------------------------*/
+
+static void alloc_double_vector
+
+     (double **vector,   /* vector */
+      long   n1)         /* size */
+
+/*
+  allocates memory for a double format vector of size n1
+*/
+
+{
+*vector = (double *) malloc (n1 * sizeof(double));
+
+if (*vector == NULL)
+   {
+   printf("alloc_double_vector: not enough memory available\n");
+   exit(1);
+   }
+
+return;
+
+}  /* alloc_double_vector */
+
+/*--------------------------------------------------------------------------*/
+
+static void free_double_vector
+
+     (double  *vector,    /* vector */
+      long    n1)         /* size */
+
+/*
+  frees memory for a double format vector of size n1
+*/
+
+{
+free(vector);
+return;
+
+}  /* free_double_vector */
+
+/*--------------------------------------------------------------------------*/
+/*                                                                          */
+/*                   CONVOLUTION KERNELS (SIMD DISPATCH)                    */
+/*                                                                          */
+/*--------------------------------------------------------------------------*/
+
+/*
+  All kernels compute m adjacent outputs
+
+    out[b] = conv[0] in[b] + sum_(p=1..length) conv[p] (in[b+p*s] + in[b-p*s])
+
+  with s = 1 for the x direction and s = GAUSS_STRIP for the columns of a
+  strip. The vector versions work on 4, 8 or 16 outputs at once, but add up
+  each output in the same order as the scalar version and do not fuse
+  multiplications and additions (fp-contract=off on every kernel, the
+  scalar and SSE2 ones included: with -march=native or for AVX-512 the
+  compiler would otherwise form FMAs), so all of them give identical
+  results whatever the compiler flags.
+*/
+
+typedef void (*conv_kernel)
+     (const double *conv, long length, const double *in, long s,
+      pixel *out, long m);
+
+/* stores 2, 4 or 8 sums to consecutive pixels; narrowed for float */
+#if defined(IMAGE_FLOAT)
+#define STORE_128(p,a)  _mm_storel_pi ((__m64 *)(p), _mm_cvtpd_ps (a))
+#define STORE_256(p,a)  _mm_storeu_ps (p, _mm256_cvtpd_ps (a))
+#define STORE_512(p,a)  _mm256_storeu_ps (p, _mm512_cvtpd_ps (a))
+#else
+#define STORE_128(p,a)  _mm_storeu_pd (p, a)
+#define STORE_256(p,a)  _mm256_storeu_pd (p, a)
+#define STORE_512(p,a)  _mm512_storeu_pd (p, a)
+#endif
+
+/*--------------------------------------------------------------------------*/
+
+__attribute__((optimize("fp-contract=off")))
+static void conv_scalar
+
+     (const double  *conv,     /* convolution vector 0..length */
+      long          length,    /* half length */
+      const double  *in,       /* first input sample */
+      long          s,         /* distance of neighbouring taps */
+      pixel         *out,      /* outputs */
+      long          m)         /* number of outputs */
+
+/*
+  one output at a time
+*/
+
+{
+long    b, p;     /* loop variables */
+double  sum;      /* for summing up */
+
+for (b=0; b<m; b++)
+    {
+    sum = conv[0] * in[b];
+    for (p=1; p<=length; p++)
+        sum = sum + conv[p] * (in[b+p*s] + in[b-p*s]);
+    out[b] = sum;
+    }
+
+return;
+
+}  /* conv_scalar */
+
+/*--------------------------------------------------------------------------*/
+
+#if defined(__SSE2__)
+
+__attribute__((optimize("fp-contract=off")))
+static void conv_sse2
+
+     (const double  *conv,     /* convolution vector 0..length */
+      long          length,    /* half length */
+      const double  *in,       /* first input sample */
+      long          s,         /* distance of neighbouring taps */
+      pixel         *out,      /* outputs */
+      long          m)         /* number of outputs */
+
+/*
+  four outputs at a time, SSE2; two independent sums per step hide
+  the latency of the additions
+*/
+
+{
+long          b, p;            /* loop variables */
+const double  *q, *r;          /* taps b+p*s and b-p*s */
+__m128d       sum0, sum1, c;   /* sums, coefficient */
+__m128d       x0, x1;          /* sums of opposite taps */
+
+for (b=0; b+4<=m; b+=4)
+    {
+    c    = _mm_set1_pd (conv[0]);
+    sum0 = _mm_mul_pd (c, _mm_loadu_pd (in + b));
+    sum1 = _mm_mul_pd (c, _mm_loadu_pd (in + b + 2));
+    for (p=1; p<=length; p++)
+        {
+        q    = in + b + p * s;
+        r    = in + b - p * s;
+        c    = _mm_set1_pd (conv[p]);
+        x0   = _mm_add_pd (_mm_loadu_pd (q), _mm_loadu_pd (r));
+        sum0 = _mm_add_pd (sum0, _mm_mul_pd (c, x0));
+        x1   = _mm_add_pd (_mm_loadu_pd (q + 2), _mm_loadu_pd (r + 2));
+        sum1 = _mm_add_pd (sum1, _mm_mul_pd (c, x1));
+        }
+    STORE_128 (out + b, sum0);
+    STORE_128 (out + b + 2, sum1);
+    }
+
+conv_scalar (conv, length, in + b, s, out + b, m - b);
+return;
+
+}  /* conv_sse2 */
+
+#endif
+
+/*--------------------------------------------------------------------------*/
+
+#if defined(GAUSS_X86)
+
+__attribute__((target("avx2"), optimize("fp-contract=off")))
+static void conv_avx2
+
+     (const double  *conv,     /* convolution vector 0..length */
+      long          length,    /* half length */
+      const double  *in,       /* first input sample */
+      long          s,         /* distance of neighbouring taps */
+      pixel         *out,      /* outputs */
+      long          m)         /* number of outputs */
+
+/*
+  eight outputs at a time, AVX2; two independent sums per step hide
+  the latency of the additions
+*/
+
+{
+long          b, p;            /* loop variables */
+const double  *q, *r;          /* taps b+p*s and b-p*s */
+__m256d       sum0, sum1, c;   /* sums, coefficient */
+__m256d       x0, x1;          /* sums of opposite taps */
+
+for (b=0; b+8<=m; b+=8)
+    {
+    c    = _mm256_set1_pd (conv[0]);
+    sum0 = _mm256_mul_pd (c, _mm256_loadu_pd (in + b));
+    sum1 = _mm256_mul_pd (c, _mm256_loadu_pd (in + b + 4));
+    for (p=1; p<=length; p++)
+        {
+        q    = in + b + p * s;
+        r    = in + b - p * s;
+        c    = _mm256_set1_pd (conv[p]);
+        x0   = _mm256_add_pd (_mm256_loadu_pd (q), _mm256_loadu_pd (r));
+        sum0 = _mm256_add_pd (sum0, _mm256_mul_pd (c, x0));
+        x1   = _mm256_add_pd (_mm256_loadu_pd (q + 4), _mm256_loadu_pd (r + 4));
+        sum1 = _mm256_add_pd (sum1, _mm256_mul_pd (c, x1));
+        }
+    STORE_256 (out + b, sum0);
+    STORE_256 (out + b + 4, sum1);
+    }
+
+_mm256_zeroupper ();
+conv_scalar (conv, length, in + b, s, out + b, m - b);
+return;
+
+}  /* conv_avx2 */
+
+/*--------------------------------------------------------------------------*/
+
+__attribute__((target("avx512f"), optimize("fp-contract=off")))
+static void conv_avx512
+
+     (const double  *conv,     /* convolution vector 0..length */
+      long          length,    /* half length */
+      const double  *in,       /* first input sample */
+      long          s,         /* distance of neighbouring taps */
+      pixel         *out,      /* outputs */
+      long          m)         /* number of outputs */
+
+/*
+  sixteen outputs at a time, AVX-512; two independent sums per step hide
+  the latency of the additions
+*/
+
+{
+long          b, p;            /* loop variables */
+const double  *q, *r;          /* taps b+p*s and b-p*s */
+__m512d       sum0, sum1, c;   /* sums, coefficient */
+__m512d       x0, x1;          /* sums of opposite taps */
+
+for (b=0; b+16<=m; b+=16)
+    {
+    c    = _mm512_set1_pd (conv[0]);
+    sum0 = _mm512_mul_pd (c, _mm512_loadu_pd (in + b));
+    sum1 = _mm512_mul_pd (c, _mm512_loadu_pd (in + b + 8));
+    for (p=1; p<=length; p++)
+        {
+        q    = in + b + p * s;
+        r    = in + b - p * s;
+        c    = _mm512_set1_pd (conv[p]);
+        x0   = _mm512_add_pd (_mm512_loadu_pd (q), _mm512_loadu_pd (r));
+        sum0 = _mm512_add_pd (sum0, _mm512_mul_pd (c, x0));
+        x1   = _mm512_add_pd (_mm512_loadu_pd (q + 8), _mm512_loadu_pd (r + 8));
+        sum1 = _mm512_add_pd (sum1, _mm512_mul_pd (c, x1));
+        }
+    STORE_512 (out + b, sum0);
+    STORE_512 (out + b + 8, sum1);
+    }
+
+_mm256_zeroupper ();
+conv_scalar (conv, length, in + b, s, out + b, m - b);
+return;
+
+}  /* conv_avx512 */
+
+#endif
+
+/*--------------------------------------------------------------------------*/
+
+static conv_kernel     chosen_kernel = NULL;   /* chosen kernel */
+static pthread_once_t  kernel_once   = PTHREAD_ONCE_INIT;
+
+/*--------------------------------------------------------------------------*/
+
+static void choose_kernel (void)
+
+/*
+  chooses the widest convolution kernel the processor supports; runs
+  exactly once, via pthread_once
+*/
+
+{
+conv_kernel  k;    /* candidate */
+
+k = conv_scalar;
+#if defined(__SSE2__)
+k = conv_sse2;
+#endif
+#if defined(GAUSS_X86)
+__builtin_cpu_init ();
+if (__builtin_cpu_supports ("avx2"))
+   k = conv_avx2;
+if (__builtin_cpu_supports ("avx512f"))
+   k = conv_avx512;
+#endif
+chosen_kernel = k;
+
+return;
+
+}  /* choose_kernel */
+
+/*--------------------------------------------------------------------------*/
+
+static conv_kernel select_kernel (void)
+
+/*
+  returns the widest convolution kernel the processor supports; the
+  first call makes the choice, also if it comes from several row workers
+  at once
+*/
+
+{
+pthread_once (&kernel_once, choose_kernel);
+
+return (chosen_kernel);
+
+}  /* select_kernel */
+
+/*--------------------------------------------------------------------------*/
+
+static double *conv_vector
+
+    (double   sigma,     /* standard deviation of the Gaussian */
+     double   prec,      /* cutoff at precision * sigma */
+     double   h,         /* pixel size */
+     long     *length)   /* half length of the vector, output */
+
+/*
+  allocates and computes the truncated, resampled and normalised Gaussian
+  conv[0..length]
+*/
+
+{
+long    i;                    /* loop variable */
+double  aux1, aux2;           /* time savers */
+double  sum;                  /* for summing up */
+double  *conv;                /* convolution vector */
+
+/* compute length of convolution vector */
+*length = (long)(prec * sigma / h) + 1;
+
+/* allocate memory for convolution vector */
+alloc_double_vector (&conv, *length + 1);
+
+/* compute entries of convolution vector */
+aux1 = 1.0 / (sigma * sqrt(2.0 * 3.1415927));
+aux2 = (h * h) / (2.0 * sigma * sigma);
+for (i=0; i<=*length; i++)
+    conv[i] = aux1 * exp (- i * i * aux2);
+
+/* normalisation */
+sum = conv[0];
+for (i=1; i<=*length; i++)
+    sum = sum + 2.0 * conv[i];
+for (i=0; i<=*length; i++)
+    conv[i] = conv[i] / sum;
+
+return (conv);
+
+}  /* conv_vector */
+
+/*--------------------------------------------------------------------------*/
+
+static void conv_x_direct
+
+    (double   sigma,     /* standard deviation of the Gaussian */
+     long     btype,     /* type of boundary condition */
+     double   prec,      /* cutoff at precision * sigma */
+     long     nx,        /* image dimension in x direction */
+     long     ny,        /* image dimension in y direction */
+     double   hx,        /* pixel size in x direction */
+     image    *u)        /* input: original image ;  output: smoothed */
+
+/*
+  convolution in x direction with a truncated and resampled Gaussian
+*/
+
+{
+long    i, j, k, l, p;        /* loop variables */
+long    length;               /* convolution vector: 0..length */
+long    pmax;                 /* upper bound for p */
+double  *conv;                /* convolution vector */
+double  *help;                /* row with dummy boundaries */
+long    h = u->halo;          /* width of boundary layer */
+conv_kernel  kernel = select_kernel ();   /* convolution step */
+
+/* convolution vector */
+conv = conv_vector (sigma, prec, hx, &length);
+
+/* allocate memory for a row */
+alloc_double_vector (&help, nx+length+length);
+
+for (j=h; j<ny+h; j++)
+    {
+    /* copy u in row vector */
+    for (i=1; i<=nx; i++)
+        help[i+length-1] = PIX(u,i+h-1,j);
+
+    /* extend signal according to the boundary conditions */
+    k = length;
+    l = length + nx - 1;
+    while (k > 0)
+          {
+          /* pmax = min (k, nx) */
+          if (k < nx)
+             pmax = k;
+          else
+             pmax = nx;
+ 
+          /* extension on both sides */
+          if (btype == 0) 
+             /* reflecting b.c.: symmetric extension */
+             for (p=1; p<=pmax; p++)
+                 {
+                 help[k-p] = help[k+p-1];
+                 help[l+p] = help[l-p+1];
+                 }
+          else
+             /* Dirichlet b.c.: antisymmetric extension */
+             for (p=1; p<=pmax; p++)
+                 {
+                 help[k-p] = - help[k+p-1];
+                 help[l+p] = - help[l-p+1];
+                 }
+
+          /* update k and l */
+          k = k - nx;
+          l = l + nx;
+          }
+
+    /* convolution step, written back to u */
+    kernel (conv, length, help + length, 1, &PIX(u,h,j), nx);
+    } /* for j */
+
+/* free memory */
+free_double_vector (help, nx+length+length);
+free_double_vector (conv, length + 1);
+
+return;
+
+} /* conv_x_direct */
+
+/*--------------------------------------------------------------------------*/
+
+static void conv_y_direct
+
+    (double   sigma,     /* standard deviation of the Gaussian */
+     long     btype,     /* type of boundary condition */
+     double   prec,      /* cutoff at precision * sigma */
+     long     nx,        /* image dimension in x direction */
+     long     ny,        /* image dimension in y direction */
+     double   hy,        /* pixel size in y direction */
+     image    *u)        /* input: original image ;  output: smoothed */
+
+/*
+  convolution in y direction with a truncated and resampled Gaussian;
+  GAUSS_STRIP columns at a time
+*/
+
+{
+long    i0, j, k, l, p, b;    /* loop variables */
+long    nb;                   /* number of columns in the current strip */
+long    length;               /* convolution vector: 0..length */
+long    pmax;                 /* upper bound for p */
+double  *conv;                /* convolution vector */
+double  *help;                /* strip with dummy boundaries */
+long    h = u->halo;          /* width of boundary layer */
+conv_kernel  kernel = select_kernel ();   /* convolution step */
+
+/* convolution vector */
+conv = conv_vector (sigma, prec, hy, &length);
+
+/* allocate memory for a strip of GAUSS_STRIP columns; the strip is stored
+   row by row, so that reading u and convolving both run along x */
+alloc_double_vector (&help, (ny+length+length) * GAUSS_STRIP);
+
+for (i0=1; i0<=nx; i0+=GAUSS_STRIP)
+    {
+    /* width of the current strip */
+    if (nx - i0 + 1 < GAUSS_STRIP)
+       nb = nx - i0 + 1;
+    else
+       nb = GAUSS_STRIP;
+
+    /* copy columns i0,...,i0+nb-1 of u in strip */
+    for (j=1; j<=ny; j++)
+     for (b=0; b<nb; b++)
+         help[(j+length-1)*GAUSS_STRIP+b] = PIX(u,i0+b+h-1,j+h-1);
+
+    /* extend signal according to the boundary conditions */
+    k = length;
+    l = length + ny - 1;
+    while (k > 0)
+          {
+          /* pmax = min (k, ny) */
+          if (k < ny)
+             pmax = k;
+          else
+             pmax = ny;
+
+          /* extension on both sides */
+          if (btype == 0)
+             /* reflecting b.c.: symmetric extension */
+             for (p=1; p<=pmax; p++)
+              for (b=0; b<nb; b++)
+                  {
+                  help[(k-p)*GAUSS_STRIP+b] = help[(k+p-1)*GAUSS_STRIP+b];
+                  help[(l+p)*GAUSS_STRIP+b] = help[(l-p+1)*GAUSS_STRIP+b];
+                  }
+          else
+             /* Dirichlet b.c.: antisymmetric extension */
+             for (p=1; p<=pmax; p++)
+              for (b=0; b<nb; b++)
+                  {
+                  help[(k-p)*GAUSS_STRIP+b] = - help[(k+p-1)*GAUSS_STRIP+b];
+                  help[(l+p)*GAUSS_STRIP+b] = - help[(l-p+1)*GAUSS_STRIP+b];
+                  }
+
+          /* update k and l */
+          k = k - ny;
+          l = l + ny;
+          }
+
+    /* convolution step, all columns of the strip at once, written back */
+    for (j=length; j<=ny+length-1; j++)
+        kernel (conv, length, help + j * GAUSS_STRIP, GAUSS_STRIP,
+                &PIX(u,i0+h-1,j-length+h), nb);
+    } /* for i0 */
+
+/* free memory */
+free_double_vector (help, (ny+length+length) * GAUSS_STRIP);
+free_double_vector (conv, length+1);
+
+return;
+
+} /* conv_y_direct */
+
+/*--------------------------------------------------------------------------*/
+
+typedef struct
+   {
+   image     *u;           /* image, changed */
+   long      n;            /* signal length: nx or ny */
+   double    sign;         /* 1: reflecting, -1: Dirichlet b.c. */
+   double    *transfer;    /* Gaussian transfer function, length 2n */
+   fft_plan  *plan;        /* FFT plan for length 2n */
+   } gauss_task;
+
+/*--------------------------------------------------------------------------*/
+
+static double *gauss_transfer
+
+     (double   sigma,     /* standard deviation of the Gaussian */
+      double   h,         /* pixel size */
+      long     n)         /* signal length */
+
+/*
+  samples the Fourier transform exp (-2 pi^2 sigma^2 f^2) of the
+  normalised Gaussian at the frequencies f = k / (2 n h) of a signal of
+  length 2 n
+*/
+
+{
+long    k, kk;     /* frequency, its distance from 0 */
+double  aux;       /* time saver */
+double  *t;        /* transfer function */
+
+alloc_double_vector (&t, 2 * n);
+aux = 2.0 * M_PI * M_PI * sigma * sigma / (4.0 * n * n * h * h);
+for (k=0; k<2*n; k++)
+    {
+    kk   = (k <= n) ? k : 2 * n - k;
+    t[k] = exp (- aux * kk * kk);
+    }
+
+return (t);
+
+}  /* gauss_transfer */
+
+/*--------------------------------------------------------------------------*/
+
+static void convolve_pair
+
+     (gauss_task  *t,      /* task */
+      double      *a,      /* first signal, changed */
+      double      *b,      /* second signal or NULL, changed */
+      double      *zr,     /* scratch vector, length 2n */
+      double      *zi,     /* scratch vector, length 2n */
+      double      *work)   /* scratch vector of the FFT */
+
+/*
+  convolves two real signals with one complex FFT of length 2n: a and b
+  are extended (anti)symmetrically to the period 2n, as the direct
+  convolution does, packed into z = a + i b, multiplied with the real and
+  even transfer function and transformed back; Re z and Im z stay apart
+*/
+
+{
+long    i;           /* loop variable */
+long    n = t->n;    /* signal length */
+
+/* symmetric (reflecting) or antisymmetric (Dirichlet) extension */
+for (i=0; i<n; i++)
+    {
+    zr[i]         = a[i];
+    zr[2*n-1-i]   = t->sign * a[i];
+    zi[i]         = (b != NULL) ? b[i] : 0.0;
+    zi[2*n-1-i]   = t->sign * zi[i];
+    }
+
+fft_execute (t->plan, zr, zi, work);
+
+/* multiply with the transfer function; conjugate for the backtransform */
+for (i=0; i<2*n; i++)
+    {
+    zr[i] =   t->transfer[i] * zr[i];
+    zi[i] = - t->transfer[i] * zi[i];
+    }
+
+fft_execute (t->plan, zr, zi, work);
+
+for (i=0; i<n; i++)
+    {
+    a[i] = zr[i];
+    if (b != NULL)
+       b[i] = - zi[i];
+    }
+
+return;
+
+}  /* convolve_pair */
+
+/*--------------------------------------------------------------------------*/
+
+static void fft_rows_kernel
+
+     (long  first,       /* first pair of rows */
+      long  last,        /* last pair of rows */
+      void  *arg)        /* gauss_task */
+
+/*
+  convolution in x direction of the rows 2p, 2p+1 (counted from 0) for
+  p = first,...,last
+*/
+
+{
+gauss_task  *t = (gauss_task *) arg;   /* task */
+image       *u = t->u;                 /* image */
+long        h = u->halo;               /* width of boundary layer */
+long        n = t->n;                  /* row length */
+long        p, i;                      /* loop variables */
+pixel       *pa, *pb;                  /* rows 2p and 2p+1 */
+double      *a, *b;                    /* the rows in double */
+double      *zr, *zi, *work;           /* scratch vectors */
+
+alloc_double_vector (&a, n);
+alloc_double_vector (&b, n);
+alloc_double_vector (&zr, 2 * n);
+alloc_double_vector (&zi, 2 * n);
+alloc_double_vector (&work, t->plan->scratch);
+
+for (p=first; p<=last; p++)
+    {
+    pa = ROW(u,2*p+h) + h;
+    pb = (2*p+1 < u->ny) ? ROW(u,2*p+1+h) + h : NULL;
+    for (i=0; i<n; i++)
+        a[i] = pa[i];
+    if (pb != NULL)
+       for (i=0; i<n; i++)
+           b[i] = pb[i];
+
+    convolve_pair (t, a, (pb != NULL) ? b : NULL, zr, zi, work);
+
+    for (i=0; i<n; i++)
+        pa[i] = a[i];
+    if (pb != NULL)
+       for (i=0; i<n; i++)
+           pb[i] = b[i];
+    }
+
+free_double_vector (a, n);
+free_double_vector (b, n);
+free_double_vector (zr, 2 * t->n);
+free_double_vector (zi, 2 * t->n);
+free_double_vector (work, t->plan->scratch);
+return;
+
+}  /* fft_rows_kernel */
+
+/*--------------------------------------------------------------------------*/
+
+static void fft_columns_kernel
+
+     (long  first,       /* first strip */
+      long  last,        /* last strip */
+      void  *arg)        /* gauss_task */
+
+/*
+  convolution in y direction of the strips first,...,last of GAUSS_STRIP
+  columns each; a strip is copied row by row into contiguous columns
+*/
+
+{
+gauss_task  *t = (gauss_task *) arg;   /* task */
+image       *u = t->u;                 /* image */
+long        h = u->halo;               /* width of boundary layer */
+long        ny = t->n;                 /* column length */
+long        s, i0, nb, j, b;           /* strip, its columns, loop vars. */
+double      *tile;                     /* columns of a strip */
+double      *zr, *zi, *work;           /* scratch vectors */
+
+alloc_double_vector (&tile, GAUSS_STRIP * ny);
+alloc_double_vector (&zr, 2 * ny);
+alloc_double_vector (&zi, 2 * ny);
+alloc_double_vector (&work, t->plan->scratch);
+
+for (s=first; s<=last; s++)
+    {
+    i0 = s * GAUSS_STRIP;
+    nb = (u->nx - i0 < GAUSS_STRIP) ? u->nx - i0 : GAUSS_STRIP;
+
+    for (j=0; j<ny; j++)
+     for (b=0; b<nb; b++)
+         tile[b*ny+j] = PIX(u,i0+b+h,j+h);
+
+    for (b=0; b<nb; b+=2)
+        convolve_pair (t, tile + b * ny,
+                       (b + 1 < nb) ? tile + (b + 1) * ny : NULL,
+                       zr, zi, work);
+
+    for (j=0; j<ny; j++)
+     for (b=0; b<nb; b++)
+         PIX(u,i0+b+h,j+h) = tile[b*ny+j];
+    }
+
+free_double_vector (tile, GAUSS_STRIP * ny);
+free_double_vector (zr, 2 * ny);
+free_double_vector (zi, 2 * ny);
+free_double_vector (work, t->plan->scratch);
+return;
+
+}  /* fft_columns_kernel */
+
+/*--------------------------------------------------------------------------*/
+
+static void conv_x_fft
+
+    (double   sigma,     /* standard deviation of the Gaussian */
+     long     btype,     /* type of boundary condition */
+     long     nx,        /* image dimension in x direction */
+     long     ny,        /* image dimension in y direction */
+     double   hx,        /* pixel size in x direction */
+     image    *u)        /* input: original image ;  output: smoothed */
+
+/*
+  convolution in x direction in the Fourier domain
+*/
+
+{
+gauss_task  t;    /* rows to be convolved */
+
+t.u        = u;
+t.n        = nx;
+t.sign     = (btype == 0) ? 1.0 : -1.0;
+t.transfer = gauss_transfer (sigma, hx, nx);
+t.plan     = fft_plan_cached (2 * nx);
+parallel_rows (0, (ny - 1) / 2, fft_rows_kernel, &t);
+
+free_double_vector (t.transfer, 2 * nx);
+return;
+
+}  /* conv_x_fft */
+
+/*--------------------------------------------------------------------------*/
+
+static void conv_y_fft
+
+    (double   sigma,     /* standard deviation of the Gaussian */
+     long     btype,     /* type of boundary condition */
+     long     nx,        /* image dimension in x direction */
+     long     ny,        /* image dimension in y direction */
+     double   hy,        /* pixel size in y direction */
+     image    *u)        /* input: original image ;  output: smoothed */
+
+/*
+  convolution in y direction in the Fourier domain
+*/
+
+{
+gauss_task  t;    /* columns to be convolved */
+
+t.u        = u;
+t.n        = ny;
+t.sign     = (btype == 0) ? 1.0 : -1.0;
+t.transfer = gauss_transfer (sigma, hy, ny);
+t.plan     = fft_plan_cached (2 * ny);
+parallel_rows (0, (nx - 1) / GAUSS_STRIP, fft_columns_kernel, &t);
+
+free_double_vector (t.transfer, 2 * ny);
+return;
+
+}  /* conv_y_fft */
+
+/*--------------------------------------------------------------------------*/
+
+typedef struct
+   {
+   image   *u;           /* image, changed */
+   long    n;            /* signal length: nx or ny */
+   double  sign;         /* 1: reflecting, -1: Dirichlet b.c. */
+   double  c[4];         /* recursive filter: gain B, feedback a1,a2,a3 */
+   double  m[3][3];      /* (I - A^(2n))^(-1), periodic initial state */
+   } iir_task;
+
+/*--------------------------------------------------------------------------*/
+
+static void iir_coefficients
+
+     (double   s,         /* standard deviation in pixels (>= 0.5) */
+      double   *c)        /* gain and feedback coefficients, output */
+
+/*
+  coefficients of the third order recursive Gaussian of Young and
+  van Vliet (1995): w_k = B x_k + a1 w_(k-1) + a2 w_(k-2) + a3 w_(k-3);
+  a causal and an anticausal pass together approximate the Gaussian
+*/
+
+{
+double  q;                /* filter parameter */
+double  b0, b1, b2, b3;   /* coefficients of the paper */
+
+if (s >= 2.5)
+   q = 0.98711 * s - 0.96330;
+else
+   q = 3.97156 - 4.14554 * sqrt (1.0 - 0.26891 * s);
+
+b0 = 1.57825 + 2.44413 * q + 1.4281 * q * q + 0.422205 * q * q * q;
+b1 = 2.44413 * q + 2.85619 * q * q + 1.26661 * q * q * q;
+b2 = - (1.4281 * q * q + 1.26661 * q * q * q);
+b3 = 0.422205 * q * q * q;
+
+c[1] = b1 / b0;
+c[2] = b2 / b0;
+c[3] = b3 / b0;
+c[0] = 1.0 - (c[1] + c[2] + c[3]);
+
+return;
+
+}  /* iir_coefficients */
+
+/*--------------------------------------------------------------------------*/
+
+static void iir_periodic
+
+     (const double  *c,        /* feedback coefficients c[1..3] */
+      long          period,    /* period of the signal */
+      double        m[3][3])   /* (I - A^period)^(-1), output */
+
+/*
+  The state (w_(k-1), w_(k-2), w_(k-3)) of the recursion evolves with the
+  companion matrix A. For a periodic input the state before the first
+  sample equals the state after the last one: s = A^period s + r, where r
+  is the final state when starting from zero; so s = m r.
+*/
+
+{
+double  a[3][3], p[3][3], h[3][3];   /* A, A^period, product */
+double  det;                         /* determinant */
+long    e, i, j, k;                  /* exponent, loop variables */
+
+/* A and p = identity */
+for (i=0; i<3; i++)
+ for (j=0; j<3; j++)
+     {
+     a[i][j] = 0.0;
+     p[i][j] = (i == j) ? 1.0 : 0.0;
+     }
+a[0][0] = c[1];
+a[0][1] = c[2];
+a[0][2] = c[3];
+a[1][0] = 1.0;
+a[2][1] = 1.0;
+
+/* p = A^period by repeated squaring */
+for (e=period; e>0; e=e/2)
+    {
+    if (e % 2 == 1)
+       {
+       for (i=0; i<3; i++)
+        for (j=0; j<3; j++)
+            for (h[i][j]=0.0, k=0; k<3; k++)
+                h[i][j] = h[i][j] + p[i][k] * a[k][j];
+       for (i=0; i<3; i++)
+        for (j=0; j<3; j++)
+            p[i][j] = h[i][j];
+       }
+    for (i=0; i<3; i++)
+     for (j=0; j<3; j++)
+         for (h[i][j]=0.0, k=0; k<3; k++)
+             h[i][j] = h[i][j] + a[i][k] * a[k][j];
+    for (i=0; i<3; i++)
+     for (j=0; j<3; j++)
+         a[i][j] = h[i][j];
+    }
+
+/* h = I - A^period */
+for (i=0; i<3; i++)
+ for (j=0; j<3; j++)
+     h[i][j] = ((i == j) ? 1.0 : 0.0) - p[i][j];
+
+/* m = h^(-1) by cofactors */
+det = h[0][0] * (h[1][1] * h[2][2] - h[1][2] * h[2][1])
+    - h[0][1] * (h[1][0] * h[2][2] - h[1][2] * h[2][0])
+    + h[0][2] * (h[1][0] * h[2][1] - h[1][1] * h[2][0]);
+for (i=0; i<3; i++)
+ for (j=0; j<3; j++)
+     m[j][i] = ( h[(i+1)%3][(j+1)%3] * h[(i+2)%3][(j+2)%3]
+               - h[(i+1)%3][(j+2)%3] * h[(i+2)%3][(j+1)%3] ) / det;
+
+return;
+
+}  /* iir_periodic */
+
+/*--------------------------------------------------------------------------*/
+
+static void iir_pass
+
+     (iir_task  *t,       /* task */
+      double    *e,       /* periodic signal, changed */
+      long      step)     /* 1: causal, -1: anticausal pass */
+
+/*
+  recursive filtering of one period of length 2n in place; the zero state
+  response is corrected by the free response of the periodic initial state
+*/
+
+{
+long    P = 2 * t->n;              /* period */
+long    k, kk;                     /* sample, its position */
+double  w1, w2, w3;                /* last three outputs */
+double  s1, s2, s3;                /* periodic initial state */
+double  small;                     /* negligible size of the state */
+double  a1 = t->c[1], a2 = t->c[2], a3 = t->c[3];   /* feedback */
+
+/* zero state response */
+w1 = w2 = w3 = 0.0;
+for (k=0; k<P; k++)
+    {
+    kk    = (step > 0) ? k : P - 1 - k;
+    e[kk] = t->c[0] * e[kk] + a1 * w1 + a2 * w2 + a3 * w3;
+    w3 = w2;
+    w2 = w1;
+    w1 = e[kk];
+    }
+
+/* state before the first sample of the periodic response */
+s1 = t->m[0][0] * w1 + t->m[0][1] * w2 + t->m[0][2] * w3;
+s2 = t->m[1][0] * w1 + t->m[1][1] * w2 + t->m[1][2] * w3;
+s3 = t->m[2][0] * w1 + t->m[2][1] * w2 + t->m[2][2] * w3;
+
+/* add the free response; stop once it has decayed below rounding */
+/* errors, which also avoids slow denormal arithmetic               */
+small = 1.0e-17 * (fabs (s1) + fabs (s2) + fabs (s3));
+for (k=0; k<P; k++)
+    {
+    kk    = (step > 0) ? k : P - 1 - k;
+    w1    = a1 * s1 + a2 * s2 + a3 * s3;
+    e[kk] = e[kk] + w1;
+    s3 = s2;
+    s2 = s1;
+    s1 = w1;
+    if (fabs (s1) + fabs (s2) + fabs (s3) <= small)
+       break;
+    }
+
+return;
+
+}  /* iir_pass */
+
+/*--------------------------------------------------------------------------*/
+
+static void iir_signal
+
+     (iir_task  *t,       /* task */
+      double    *x,       /* signal of length n, changed */
+      double    *e)       /* scratch vector of length 2n */
+
+/*
+  recursive Gaussian smoothing of one signal: (anti)symmetric extension
+  to the period 2n as for the direct convolution, causal and anticausal
+  pass with periodic initial states
+*/
+
+{
+long  i;           /* loop variable */
+long  n = t->n;    /* signal length */
+
+for (i=0; i<n; i++)
+    {
+    e[i]       = x[i];
+    e[2*n-1-i] = t->sign * x[i];
+    }
+
+iir_pass (t, e, 1);
+iir_pass (t, e, -1);
+
+for (i=0; i<n; i++)
+    x[i] = e[i];
+
+return;
+
+}  /* iir_signal */
+
+/*--------------------------------------------------------------------------*/
+
+static void iir_rows_kernel
+
+     (long  first,       /* first row */
+      long  last,        /* last row */
+      void  *arg)        /* iir_task */
+
+/*
+  recursive smoothing in x direction of the rows first,...,last (counted
+  from 0)
+*/
+
+{
+iir_task  *t = (iir_task *) arg;   /* task */
+long      h = t->u->halo;          /* width of boundary layer */
+long      n = t->n;                /* row length */
+long      i, j;                    /* loop variables */
+pixel     *p;                      /* current row */
+double    *x;                      /* the row in double */
+double    *e;                      /* periodic signal */
+
+alloc_double_vector (&x, n);
+alloc_double_vector (&e, 2 * n);
+
+for (j=first; j<=last; j++)
+    {
+    p = ROW(t->u,j+h) + h;
+    for (i=0; i<n; i++)
+        x[i] = p[i];
+    iir_signal (t, x, e);
+    for (i=0; i<n; i++)
+        p[i] = x[i];
+    }
+
+free_double_vector (x, n);
+free_double_vector (e, 2 * n);
+return;
+
+}  /* iir_rows_kernel */
+
+/*--------------------------------------------------------------------------*/
+
+static void iir_columns_kernel
+
+     (long  first,       /* first strip */
+      long  last,        /* last strip */
+      void  *arg)        /* iir_task */
+
+/*
+  recursive smoothing in y direction of the strips first,...,last of
+  GAUSS_STRIP columns each
+*/
+
+{
+iir_task  *t = (iir_task *) arg;   /* task */
+image     *u = t->u;               /* image */
+long      h = u->halo;             /* width of boundary layer */
+long      ny = t->n;               /* column length */
+long      s, i0, nb, j, b;         /* strip, its columns, loop variables */
+double    *tile;                   /* columns of a strip */
+double    *e;                      /* periodic signal */
+
+alloc_double_vector (&tile, GAUSS_STRIP * ny);
+alloc_double_vector (&e, 2 * ny);
+
+for (s=first; s<=last; s++)
+    {
+    i0 = s * GAUSS_STRIP;
+    nb = (u->nx - i0 < GAUSS_STRIP) ? u->nx - i0 : GAUSS_STRIP;
+
+    for (j=0; j<ny; j++)
+     for (b=0; b<nb; b++)
+         tile[b*ny+j] = PIX(u,i0+b+h,j+h);
+
+    for (b=0; b<nb; b++)
+        iir_signal (t, tile + b * ny, e);
+
+    for (j=0; j<ny; j++)
+     for (b=0; b<nb; b++)
+         PIX(u,i0+b+h,j+h) = tile[b*ny+j];
+    }
+
+free_double_vector (tile, GAUSS_STRIP * ny);
+free_double_vector (e, 2 * ny);
+return;
+
+}  /* iir_columns_kernel */
+
+/*--------------------------------------------------------------------------*/
+
+typedef struct
+   {
+   long    n;            /* number of scales */
+   long    *length;      /* half lengths of the convolution vectors */
+   double  **conv;       /* convolution vectors of the scales */
+   long    lmax;         /* largest half length */
+   double  sign;         /* 1: reflecting, -1: Dirichlet b.c. */
+   image   *u;           /* original image, unchanged */
+   image   **band;       /* n+1 bands, output */
+   } bank_task;
+
+/*--------------------------------------------------------------------------*/
+
+static void extend
+
+     (double  *v,        /* signal with lmax dummy samples on each side */
+      long    n,         /* signal length */
+      long    lmax,      /* number of dummy samples on each side */
+      long    s,         /* distance of neighbouring samples */
+      long    nb,        /* number of interleaved signals */
+      double  sign)      /* 1: symmetric, -1: antisymmetric extension */
+
+/*
+  fills the dummy samples of nb interleaved signals v[k*s+b] (samples
+  lmax,...,lmax+n-1) according to the boundary conditions, as
+  conv_x_direct and conv_y_direct do
+*/
+
+{
+long  k, l, p, b;    /* loop variables */
+long  pmax;          /* upper bound for p */
+
+k = lmax;
+l = lmax + n - 1;
+while (k > 0)
+      {
+      pmax = (k < n) ? k : n;
+      for (p=1; p<=pmax; p++)
+       for (b=0; b<nb; b++)
+           {
+           v[(k-p)*s+b] = sign * v[(k+p-1)*s+b];
+           v[(l+p)*s+b] = sign * v[(l-p+1)*s+b];
+           }
+      k = k - n;
+      l = l + n;
+      }
+
+return;
+
+}  /* extend */
+
+/*--------------------------------------------------------------------------*/
+
+static void bank_rows_kernel
+
+     (long  first,       /* first row */
+      long  last,        /* last row */
+      void  *arg)        /* bank_task */
+
+/*
+  convolution in x direction of the rows first,...,last (counted from 0)
+  with all scales: each row of u is read and extended once, the result
+  of scale k goes to band k+1
+*/
+
+{
+bank_task    *t = (bank_task *) arg;    /* task */
+long         nx = t->u->nx;             /* row length */
+long         hu = t->u->halo;           /* boundary layer of u */
+long         hb = t->band[0]->halo;     /* boundary layer of the bands */
+long         i, j, k;                   /* loop variables */
+pixel        *p;                        /* row of u */
+double       *help;                     /* row with dummy boundaries */
+conv_kernel  kernel = select_kernel (); /* convolution step */
+
+alloc_double_vector (&help, nx + 2 * t->lmax);
+
+for (j=first; j<=last; j++)
+    {
+    p = ROW(t->u,j+hu) + hu;
+    for (i=0; i<nx; i++)
+        help[i+t->lmax] = p[i];
+    extend (help, nx, t->lmax, 1, 1, t->sign);
+
+    for (k=0; k<t->n; k++)
+        kernel (t->conv[k], t->length[k], help + t->lmax, 1,
+                ROW(t->band[k+1],j+hb) + hb, nx);
+    }
+
+free_double_vector (help, nx + 2 * t->lmax);
+return;
+
+}  /* bank_rows_kernel */
+
+/*--------------------------------------------------------------------------*/
+
+static void bank_columns_kernel
+
+     (long  first,       /* first strip */
+      long  last,        /* last strip */
+      void  *arg)        /* bank_task */
+
+/*
+  convolution in y direction of the strips first,...,last of GAUSS_STRIP
+  columns each, scale by scale; the x result of scale k is read from
+  band k+1 and the result G_k is written back there
+*/
+
+{
+bank_task    *t = (bank_task *) arg;    /* task */
+long         nx = t->u->nx;             /* number of columns */
+long         ny = t->u->ny;             /* column length */
+long         hb = t->band[0]->halo;     /* boundary layer of the bands */
+long         lmax = t->lmax;            /* dummy rows on each side */
+long         s, i0, nb, j, k, b;        /* strip, its columns, loop vars. */
+double       *help;                     /* strip with dummy boundaries */
+pixel        *q;                        /* row of band k+1 */
+conv_kernel  kernel = select_kernel (); /* convolution step */
+
+alloc_double_vector (&help, (ny + 2 * lmax) * GAUSS_STRIP);
+
+for (s=first; s<=last; s++)
+    {
+    i0 = s * GAUSS_STRIP;
+    nb = (nx - i0 < GAUSS_STRIP) ? nx - i0 : GAUSS_STRIP;
+
+    for (k=0; k<t->n; k++)
+        {
+        /* gather and extend the x result of scale k */
+        for (j=0; j<ny; j++)
+            {
+            q = ROW(t->band[k+1],j+hb) + hb + i0;
+            for (b=0; b<nb; b++)
+                help[(j+lmax)*GAUSS_STRIP+b] = q[b];
+            }
+        extend (help, ny, lmax, GAUSS_STRIP, nb, t->sign);
+
+        /* convolution step, all columns of the strip at once */
+        for (j=0; j<ny; j++)
+            kernel (t->conv[k], t->length[k],
+                    help + (j + lmax) * GAUSS_STRIP, GAUSS_STRIP,
+                    ROW(t->band[k+1],j+hb) + hb + i0, nb);
+        }
+    }
+
+free_double_vector (help, (ny + 2 * lmax) * GAUSS_STRIP);
+return;
+
+}  /* bank_columns_kernel */
+
+/*--------------------------------------------------------------------------*/
+
+static void bank_differences_kernel
+
+     (long  first,       /* first row */
+      long  last,        /* last row */
+      void  *arg)        /* bank_task */
+
+/*
+  forms the bands from the smoothed images G_k in the bands k+1 for the
+  rows first,...,last (counted from 0): band k becomes G_(k-1) - G_k
+  (u - G_0 for k = 0)
+*/
+
+{
+bank_task  *t = (bank_task *) arg;    /* task */
+long       nx = t->u->nx;             /* row length */
+long       hu = t->u->halo;           /* boundary layer of u */
+long       hb = t->band[0]->halo;     /* boundary layer of the bands */
+long       i, j, k;                   /* loop variables */
+double     prev, next;                /* smoothed values of two scales */
+
+for (j=first; j<=last; j++)
+ for (i=0; i<nx; i++)
+     {
+     prev = PIX(t->u,i+hu,j+hu);
+     for (k=0; k<t->n; k++)
+         {
+         next = PIX(t->band[k+1],i+hb,j+hb);
+         PIX(t->band[k],i+hb,j+hb) = prev - next;
+         prev = next;
+         }
+     }
+
+return;
+
+}  /* bank_differences_kernel */
+
+/*--------------------------------------------------------------------------*/
+
+static long use_fft
+
+     (double   sigma,     /* standard deviation of the Gaussian */
+      double   prec,      /* cutoff at precision * sigma */
+      double   h,         /* pixel size */
+      long     n)         /* signal length */
+
+/*
+  decides whether the Fourier domain is faster: the direct convolution
+  costs about length operations per pixel, the FFT about log2 (2n);
+  the factor GAUSS_FFT_RATIO is measured with bench/gauss
+*/
+
+{
+long  length;    /* half length of the convolution vector */
+
+length = (long)(prec * sigma / h) + 1;
+
+return (length > GAUSS_FFT_RATIO * log2 (2.0 * n));
+
+}  /* use_fft */
+
+/*--------------------------------------------------------------------------*/
+
+void gauss_conv_direct
+
+    (double   sigma,     /* standard deviation of the Gaussian */
+     long     btype,     /* type of boundary condition */
+     double   prec,      /* cutoff at precision * sigma */
+     long     nx,        /* image dimension in x direction */
+     long     ny,        /* image dimension in y direction */
+     double   hx,        /* pixel size in x direction */
+     double   hy,        /* pixel size in y direction */
+     image    *u)        /* input: original image ;  output: smoothed */
+
+/*
+  Gaussian convolution with a truncated and resampled Gaussian
+*/
+
+{
+conv_x_direct (sigma, btype, prec, nx, ny, hx, u);
+conv_y_direct (sigma, btype, prec, nx, ny, hy, u);
+
+return;
+
+}  /* gauss_conv_direct */
+
+/*--------------------------------------------------------------------------*/
+
+void gauss_conv_fft
+
+    (double   sigma,     /* standard deviation of the Gaussian */
+     long     btype,     /* type of boundary condition */
+     long     nx,        /* image dimension in x direction */
+     long     ny,        /* image dimension in y direction */
+     double   hx,        /* pixel size in x direction */
+     double   hy,        /* pixel size in y direction */
+     image    *u)        /* input: original image ;  output: smoothed */
+
+/*
+  Gaussian convolution in the Fourier domain; the Gaussian is not
+  truncated
+*/
+
+{
+conv_x_fft (sigma, btype, nx, ny, hx, u);
+conv_y_fft (sigma, btype, nx, ny, hy, u);
+
+return;
+
+}  /* gauss_conv_fft */
+
+/*--------------------------------------------------------------------------*/
+
+void gauss_conv
+
+    (double   sigma,     /* standard deviation of the Gaussian */
+     long     btype,     /* type of boundary condition */
+     double   prec,      /* cutoff at precision * sigma */
+     long     nx,        /* image dimension in x direction */
+     long     ny,        /* image dimension in y direction */
+     double   hx,        /* pixel size in x direction */
+     double   hy,        /* pixel size in y direction */
+     image    *u)        /* input: original image ;  output: smoothed */
+
+/*
+  Gaussian convolution; in each direction the faster of the direct and
+  the Fourier domain convolution is chosen
+*/
+
+{
+if (use_fft (sigma, prec, hx, nx))
+   conv_x_fft (sigma, btype, nx, ny, hx, u);
+else
+   conv_x_direct (sigma, btype, prec, nx, ny, hx, u);
+
+if (use_fft (sigma, prec, hy, ny))
+   conv_y_fft (sigma, btype, nx, ny, hy, u);
+else
+   conv_y_direct (sigma, btype, prec, nx, ny, hy, u);
+
+return;
+
+}  /* gauss_conv */
+
+/*--------------------------------------------------------------------------*/
+
+void gauss_conv_recursive
+
+    (double   sigma,     /* standard deviation of the Gaussian */
+     long     btype,     /* type of boundary condition */
+     long     nx,        /* image dimension in x direction */
+     long     ny,        /* image dimension in y direction */
+     double   hx,        /* pixel size in x direction */
+     double   hy,        /* pixel size in y direction */
+     image    *u)        /* input: original image ;  output: smoothed */
+
+/*
+  Gaussian convolution with the recursive filter of Young and van Vliet;
+  the cost does not depend on sigma; for sigma < 0.5 pixels, where the
+  recursive filter is not defined, the direct convolution is used
+*/
+
+{
+iir_task  t;    /* rows or columns to be smoothed */
+
+t.u    = u;
+t.sign = (btype == 0) ? 1.0 : -1.0;
+
+/* x direction */
+if (sigma / hx < 0.5)
+   conv_x_direct (sigma, btype, 3.0, nx, ny, hx, u);
+else
+   {
+   t.n = nx;
+   iir_coefficients (sigma / hx, t.c);
+   iir_periodic (t.c, 2 * nx, t.m);
+   parallel_rows (0, ny - 1, iir_rows_kernel, &t);
+   }
+
+/* y direction */
+if (sigma / hy < 0.5)
+   conv_y_direct (sigma, btype, 3.0, nx, ny, hy, u);
+else
+   {
+   t.n = ny;
+   iir_coefficients (sigma / hy, t.c);
+   iir_periodic (t.c, 2 * ny, t.m);
+   parallel_rows (0, (nx - 1) / GAUSS_STRIP, iir_columns_kernel, &t);
+   }
+
+return;
+
+}  /* gauss_conv_recursive */
+
+/*--------------------------------------------------------------------------*/
+
+void gauss_conv_backend
+
+    (long     backend,   /* GAUSS_AUTO, GAUSS_FFT or GAUSS_RECURSIVE */
+     double   sigma,     /* standard deviation of the Gaussian */
+     long     btype,     /* type of boundary condition */
+     double   prec,      /* cutoff at precision * sigma */
+     long     nx,        /* image dimension in x direction */
+     long     ny,        /* image dimension in y direction */
+     double   hx,        /* pixel size in x direction */
+     double   hy,        /* pixel size in y direction */
+     image    *u)        /* input: original image ;  output: smoothed */
+
+/*
+  Gaussian convolution with the chosen backend; GAUSS_AUTO is gauss_conv
+*/
+
+{
+switch (backend)
+   {
+   case GAUSS_AUTO:
+      gauss_conv (sigma, btype, prec, nx, ny, hx, hy, u);
+      break;
+   case GAUSS_FFT:
+      gauss_conv_fft (sigma, btype, nx, ny, hx, hy, u);
+      break;
+   case GAUSS_RECURSIVE:
+      gauss_conv_recursive (sigma, btype, nx, ny, hx, hy, u);
+      break;
+   default:
+      printf("gauss_conv_backend: unknown backend %ld\n", backend);
+      exit(1);
+   }
+
+return;
+
+}  /* gauss_conv_backend */
+
+/*--------------------------------------------------------------------------*/
+
+void gauss_bank
+
+    (long     n,         /* number of scales */
+     double   *sigma,    /* standard deviations, increasing */
+     long     btype,     /* type of boundary condition */
+     double   prec,      /* cutoff at precision * sigma */
+     long     backend,   /* GAUSS_AUTO, GAUSS_FFT or GAUSS_RECURSIVE */
+     long     nx,        /* image dimension in x direction */
+     long     ny,        /* image dimension in y direction */
+     double   hx,        /* pixel size in x direction */
+     double   hy,        /* pixel size in y direction */
+     image    *u,        /* original image, unchanged */
+     image    **band)    /* n+1 images of size nx * ny, output */
+
+/*
+  filter bank of Gaussians with sigma[0] < ... < sigma[n-1]:
+  band[0] = u - G_0 * u (highpass), band[k] = (G_(k-1) - G_k) * u
+  (difference of Gaussians, k = 1,...,n-1), band[n] = G_(n-1) * u
+  (lowpass); the bands add up to u. band[0] may be u itself.
+  All scales are convolved directly: in x direction from one read of u
+  into one extended row, in y direction scale by scale through one
+  extended strip buffer; all bands are then formed in a single write loop
+  over the rows (forming them in the column strips was slower: the strided
+  accesses to u and to a second band cost more than one sequential pass).
+  If the largest scale is long enough for gauss_conv to use the Fourier
+  domain, or if the backend is not GAUSS_AUTO, each scale is smoothed by
+  gauss_conv_backend instead.
+*/
+
+{
+bank_task  t;                  /* task */
+long       k;                  /* loop variable */
+long       i, j;               /* loop variables */
+long       hu = u->halo;       /* boundary layer of u */
+long       hb = band[0]->halo; /* boundary layer of the bands */
+
+if (n < 1)
+   {
+   printf("gauss_bank: at least one scale required\n");
+   exit(1);
+   }
+for (k=0; k<n; k++)
+    if ((sigma[k] <= 0.0) || ((k > 0) && (sigma[k] <= sigma[k-1])))
+       {
+       printf("gauss_bank: standard deviations must increase\n");
+       exit(1);
+       }
+
+t.n    = n;
+t.sign = (btype == 0) ? 1.0 : -1.0;
+t.u    = u;
+t.band = band;
+
+/* long kernels or other backends: one convolution per scale */
+if ((backend != GAUSS_AUTO)
+    || use_fft (sigma[n-1], prec, hx, nx) || use_fft (sigma[n-1], prec, hy, ny))
+   {
+   for (k=0; k<n; k++)
+       {
+       for (j=0; j<ny; j++)
+        for (i=0; i<nx; i++)
+            PIX(band[k+1],i+hb,j+hb) = PIX(u,i+hu,j+hu);
+       gauss_conv_backend (backend, sigma[k], btype, prec, nx, ny, hx, hy,
+                           band[k+1]);
+       }
+   parallel_rows (0, ny - 1, bank_differences_kernel, &t);
+   return;
+   }
+
+t.length = (long *) malloc (n * sizeof(long));
+t.conv   = (double **) malloc (n * sizeof(double *));
+if ((t.length == NULL) || (t.conv == NULL))
+   {
+   printf("gauss_bank: not enough memory available\n");
+   exit(1);
+   }
+
+/* x direction */
+t.lmax = 0;
+for (k=0; k<n; k++)
+    {
+    t.conv[k] = conv_vector (sigma[k], prec, hx, &t.length[k]);
+    if (t.length[k] > t.lmax)
+       t.lmax = t.length[k];
+    }
+parallel_rows (0, ny - 1, bank_rows_kernel, &t);
+for (k=0; k<n; k++)
+    free_double_vector (t.conv[k], t.length[k] + 1);
+
+/* y direction */
+t.lmax = 0;
+for (k=0; k<n; k++)
+    {
+    t.conv[k] = conv_vector (sigma[k], prec, hy, &t.length[k]);
+    if (t.length[k] > t.lmax)
+       t.lmax = t.length[k];
+    }
+parallel_rows (0, (nx - 1) / GAUSS_STRIP, bank_columns_kernel, &t);
+for (k=0; k<n; k++)
+    free_double_vector (t.conv[k], t.length[k] + 1);
+
+/* bands */
+parallel_rows (0, ny - 1, bank_differences_kernel, &t);
+
+free (t.length);
+free (t.conv);
+return;
+
+}  /* gauss_bank */
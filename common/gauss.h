@@ -0,0 +1,73 @@
+#ifndef GAUSS_H
+#define GAUSS_H
+
+/*--------------------------------------------------------------------------*/
+/*                                                                          */
+/*                          GAUSSIAN CONVOLUTION                            */
+/*                                                                          */
+/*--------------------------------------------------------------------------*/
+
+/*
+  Separable convolution of an image with a Gaussian of standard deviation
+  sigma; btype = 0: reflecting, otherwise Dirichlet boundary conditions
+  (symmetric / antisymmetric extension of the image).
+  gauss_conv_direct convolves with the Gaussian truncated at prec * sigma;
+  its cost grows linearly with sigma. gauss_conv_fft multiplies with the
+  transfer function of the Gaussian in the Fourier domain of the extended
+  image; its cost does not depend on sigma. gauss_conv picks the faster
+  one per direction: the Fourier domain once the half kernel length
+  prec * sigma / h exceeds GAUSS_FFT_RATIO * log2 (2n).
+  gauss_conv_recursive runs the third order recursive filter of Young and
+  van Vliet forwards and backwards over the extended image, with exact
+  periodic initial states; it is an approximation of the Gaussian whose
+  cost does not depend on sigma either (accuracy: bench/gauss). It is
+  inaccurate for small sigma: on noise with grey values 0,...,255 it is
+  up to 16 grey values off at sigma = 1 and 4 at sigma = 2 with
+  reflecting boundaries, 20 and 10 with Dirichlet boundaries (still 4 at
+  sigma = 8), where the Fourier domain is within 0.4.
+  gauss_conv_backend runs one of them: GAUSS_AUTO (gauss_conv),
+  GAUSS_FFT or GAUSS_RECURSIVE.
+  gauss_bank splits an image into a highpass, differences of Gaussians
+  for increasing sigmas and a lowpass; with GAUSS_AUTO in one sweep over
+  the image, otherwise with one convolution per sigma by the backend.
+  All functions smooth the nx * ny interior of u behind a boundary layer
+  of any width u->halo and leave the boundary layer alone; the bands of
+  gauss_bank share one width, which may differ from that of u.
+  Requires image.h.
+*/
+
+/*--------------------------------------------------------------------------*/
+
+#define GAUSS_FFT_RATIO  27.0   /* crossover, measured with bench/gauss */
+
+#define GAUSS_AUTO       0      /* direct or Fourier domain by the crossover */
+#define GAUSS_FFT        1      /* Fourier domain */
+#define GAUSS_RECURSIVE  2      /* recursive filter of Young and van Vliet */
+
+/*--------------------------------------------------------------------------*/
+
+void gauss_conv
+     (double sigma, long btype, double prec, long nx, long ny,
+      double hx, double hy, image *u);
+
+void gauss_conv_direct
+     (double sigma, long btype, double prec, long nx, long ny,
+      double hx, double hy, image *u);
+
+void gauss_conv_fft
+     (double sigma, long btype, long nx, long ny,
+      double hx, double hy, image *u);
+
+void gauss_conv_recursive
+     (double sigma, long btype, long nx, long ny,
+      double hx, double hy, image *u);
+
+void gauss_conv_backend
+     (long backend, double sigma, long btype, double prec, long nx, long ny,
+      double hx, double hy, image *u);
+
+void gauss_bank
+     (long n, double *sigma, long btype, double prec, long backend,
+      long nx, long ny, double hx, double hy, image *u, image **band);
+
+#endif
@@ -0,0 +1,1312 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "image.h"
+#include "parallel.h"
+
+/*--------------------------------------------------------------------------*/
+/*                                                                          */
+/*                      SHARED IMAGE CONTAINER AND I/O                      */
+/*                                                                          */
+/*--------------------------------------------------------------------------*/
+
+/*
+  contiguous image container, pgm/ppm input and output, image statistics
+*/
+
+/*--------------------------------------------------------------------------*/
+
+#define IMAGE_CACHE_MAX  16    /* maximum number of cached input files */
+
+/* two consecutive pixels to and from the two lanes of an SSE2 double
+   register; float pixels are widened and narrowed on the way */
+#if defined(__SSE2__) && defined(IMAGE_FLOAT)
+#define LOAD_PD(p)     _mm_cvtps_pd (_mm_loadl_pi (_mm_setzero_ps (), \
+                                                   (const __m64 *)(p)))
+#define STORE_PD(p,a)  _mm_storel_pi ((__m64 *)(p), _mm_cvtpd_ps (a))
+#elif defined(__SSE2__)
+#define LOAD_PD(p)     _mm_loadu_pd (p)
+#define STORE_PD(p,a)  _mm_storeu_pd (p, a)
+#endif
+
+/*--------------------------------------------------------------------------*/
+
+long image_pixels
+
+     (long   nc,         /* number of channels */
+      long   nx,         /* size in x direction */
+      long   ny,         /* size in y direction */
+      long   halo)       /* width of boundary layer */
+
+/*
+  returns the number of pixels that the buffer of an image with this
+  geometry occupies, rounded up to a multiple of the alignment so that
+  buffers placed one after another in an arena all stay aligned
+*/
+
+{
+long  pad;      /* pixels per alignment unit */
+long  stride;   /* distance between neighbouring rows */
+
+pad    = IMAGE_ALIGN / sizeof(pixel);
+stride = ((nx + 2 * halo + pad - 1) / pad) * pad;
+
+return (((nc * stride * (ny + 2 * halo) + pad - 1) / pad) * pad);
+
+}  /* image_pixels */
+
+/*--------------------------------------------------------------------------*/
+
+void image_view
+
+     (image  *v,         /* image, output */
+      pixel  *data,      /* 64-byte aligned buffer of image_pixels pixels */
+      long   nc,         /* number of channels */
+      long   nx,         /* size in x direction */
+      long   ny,         /* size in y direction */
+      long   halo)       /* width of boundary layer */
+
+/*
+  sets up an image with the geometry of alloc_image on a buffer owned by
+  the caller, e.g. one level of an arena; the buffer is not initialised
+  and must not be freed with free_image
+*/
+
+{
+long  pad;      /* pixels per alignment unit */
+
+pad = IMAGE_ALIGN / sizeof(pixel);
+
+v->data   = data;
+v->nc     = nc;
+v->nx     = nx;
+v->ny     = ny;
+v->halo   = halo;
+v->stride = ((nx + 2 * halo + pad - 1) / pad) * pad;
+v->plane  = v->stride * (ny + 2 * halo);
+
+return;
+
+}  /* image_view */
+
+/*--------------------------------------------------------------------------*/
+
+void alloc_image
+
+     (image  **u,        /* image, output */
+      long   nc,         /* number of channels */
+      long   nx,         /* size in x direction */
+      long   ny,         /* size in y direction */
+      long   halo)       /* width of boundary layer */
+
+/*
+  allocates one contiguous, zero-initialised buffer for an image with nc
+  channels of size nx * ny plus a boundary layer of width halo;
+  rows and channels start at 64-byte boundaries
+*/
+
+{
+size_t  size;     /* buffer size in bytes */
+image   *v;       /* allocated image */
+pixel   *data;    /* pixel buffer */
+
+v = (image *) malloc (sizeof(image));
+if (v == NULL)
+   {
+   printf("alloc_image: not enough memory available\n");
+   exit(1);
+   }
+
+/* aligned_alloc requires a multiple of the alignment */
+size = (size_t) image_pixels (nc, nx, ny, halo) * sizeof(pixel);
+if (size == 0)
+   size = IMAGE_ALIGN;
+
+data = (pixel *) aligned_alloc (IMAGE_ALIGN, size);
+if (data == NULL)
+   {
+   printf("alloc_image: not enough memory available\n");
+   exit(1);
+   }
+memset (data, 0, size);
+image_view (v, data, nc, nx, ny, halo);
+
+*u = v;
+return;
+
+}  /* alloc_image */
+
+/*--------------------------------------------------------------------------*/
+
+void free_image
+
+     (image  *u)         /* image */
+
+/*
+  frees an image allocated with alloc_image;
+  must not be called for channel views
+*/
+
+{
+free (u->data);
+free (u);
+
+return;
+
+}  /* free_image */
+
+/*--------------------------------------------------------------------------*/
+
+void image_channel
+
+     (image  *u,         /* multichannel image */
+      long   m,          /* channel index */
+      image  *c)         /* single channel view, output */
+
+/*
+  creates a single channel view on channel m of u without copying;
+  the view shares the buffer of u
+*/
+
+{
+*c      = *u;
+c->nc   = 1;
+c->data = u->data + m * u->plane;
+
+return;
+
+}  /* image_channel */
+
+/*--------------------------------------------------------------------------*/
+
+void copy_image
+
+     (image  *u,         /* source image, unchanged */
+      image  *v)         /* target image with the same geometry, output */
+
+/*
+  copies all pixels (including the boundary layer) of u into v
+*/
+
+{
+memcpy (v->data, u->data, (size_t)(u->nc * u->plane) * sizeof(pixel));
+
+return;
+
+}  /* copy_image */
+
+/*--------------------------------------------------------------------------*/
+
+static void skip_white_space_and_comments
+
+     (FILE *inimage)  /* input file */
+
+/*
+  skips over white space and comments while reading the file
+*/
+
+{
+
+int   ch = 0;   /* holds a character */
+char  row[80];  /* for reading data */
+
+/* skip spaces */
+while (((ch = fgetc(inimage)) != EOF) && isspace(ch));
+
+/* skip comments */
+if (ch == '#')
+   {
+   if (fgets(row, sizeof(row), inimage))
+      skip_white_space_and_comments (inimage);
+   else
+      {
+      printf("skip_white_space_and_comments: cannot read file\n");
+      exit(1);
+      }
+   }
+else
+   fseek (inimage, -1, SEEK_CUR);
+
+return;
+
+} /* skip_white_space_and_comments */
+
+/*--------------------------------------------------------------------------*/
+
+static FILE *read_header
+
+     (const char  *caller,       /* name of calling routine for messages */
+      const char  *file_name,    /* name of image file */
+      long        *nc,           /* number of colour channels, output */
+      long        *nx,           /* image size in x direction, output */
+      long        *ny,           /* image size in y direction, output */
+      long        *max_value)    /* maximum grey value, output */
+
+/*
+  opens a pgm (P5) or ppm (P6) file and reads its header;
+  returns the file positioned at the first pixel
+*/
+
+{
+char  row[80];      /* for reading data */
+FILE  *inimage;     /* input file */
+
+/* open file */
+inimage = fopen (file_name, "rb");
+if (inimage == NULL)
+   {
+   printf ("%s: cannot open file '%s'\n", caller, file_name);
+   exit(1);
+   }
+
+/* read header */
+if (fgets (row, 80, inimage) == NULL)
+   {
+   printf ("%s: cannot read file\n", caller);
+   exit(1);
+   }
+
+/* image type: P5 or P6 */
+if ((row[0] == 'P') && (row[1] == '5'))
+   {
+   /* P5: grey scale image */
+   *nc = 1;
+   }
+else if ((row[0] == 'P') && (row[1] == '6'))
+   {
+   /* P6: colour image */
+   *nc = 3;
+   }
+else
+   {
+   printf ("%s: unknown image format\n", caller);
+   exit(1);
+   }
+
+/* read image size in x direction */
+skip_white_space_and_comments (inimage);
+if (!fscanf (inimage, "%ld", nx))
+   {
+   printf ("%s: cannot read image size nx\n", caller);
+   exit(1);
+   }
+
+/* read image size in y direction */
+skip_white_space_and_comments (inimage);
+if (!fscanf (inimage, "%ld", ny))
+   {
+   printf ("%s: cannot read image size ny\n", caller);
+   exit(1);
+   }
+
+/* read maximum grey value */
+skip_white_space_and_comments (inimage);
+if (!fscanf (inimage, "%ld", max_value))
+   {
+   printf ("%s: cannot read maximal value\n", caller);
+   exit(1);
+   }
+fgetc(inimage);
+
+return (inimage);
+
+}  /* read_header */
+
+/*--------------------------------------------------------------------------*/
+
+static void bytes_to_pixels
+
+     (const unsigned char  *src,   /* 8-bit samples */
+      pixel                *dst,   /* converted samples, output */
+      long                 n)      /* number of samples */
+
+/*
+  widens n unsigned bytes to pixels; uses SSE2 for 16 samples at a time
+  where available
+*/
+
+{
+long  k = 0;   /* sample index */
+
+#if defined(__SSE2__)
+__m128i  zero = _mm_setzero_si128 ();   /* for unpacking */
+__m128i  b, w, d;                       /* bytes, words, doublewords */
+
+for (; k+16<=n; k+=16)
+    {
+    b = _mm_loadu_si128 ((const __m128i *)(src + k));
+
+    w = _mm_unpacklo_epi8 (b, zero);
+    d = _mm_unpacklo_epi16 (w, zero);
+    STORE_PD (dst + k,      _mm_cvtepi32_pd (d));
+    STORE_PD (dst + k + 2,  _mm_cvtepi32_pd (_mm_srli_si128 (d, 8)));
+    d = _mm_unpackhi_epi16 (w, zero);
+    STORE_PD (dst + k + 4,  _mm_cvtepi32_pd (d));
+    STORE_PD (dst + k + 6,  _mm_cvtepi32_pd (_mm_srli_si128 (d, 8)));
+
+    w = _mm_unpackhi_epi8 (b, zero);
+    d = _mm_unpacklo_epi16 (w, zero);
+    STORE_PD (dst + k + 8,  _mm_cvtepi32_pd (d));
+    STORE_PD (dst + k + 10, _mm_cvtepi32_pd (_mm_srli_si128 (d, 8)));
+    d = _mm_unpackhi_epi16 (w, zero);
+    STORE_PD (dst + k + 12, _mm_cvtepi32_pd (d));
+    STORE_PD (dst + k + 14, _mm_cvtepi32_pd (_mm_srli_si128 (d, 8)));
+    }
+#endif
+
+/* remaining samples */
+for (; k<n; k++)
+    dst[k] = (pixel) src[k];
+
+return;
+
+}  /* bytes_to_pixels */
+
+/*--------------------------------------------------------------------------*/
+
+static void read_raster
+
+     (const char  *caller,       /* name of calling routine for messages */
+      FILE        *inimage,      /* file positioned at the first pixel */
+      long        max_value,     /* maximum grey value from the header */
+      image       *u)            /* allocated image, output */
+
+/*
+  reads the complete raster of a P5/P6 file with a single fread and
+  converts it to pixels;
+  samples of 16-bit files (max_value > 255) are big-endian and are
+  rescaled to [0,255] so that all programs can keep their 8-bit range
+*/
+
+{
+long           i, j, m;     /* loop variables */
+long           h;           /* width of boundary layer */
+long           nc, nx, ny;  /* image size */
+long           bps;         /* bytes per sample */
+long           n;           /* samples per row */
+size_t         size;        /* raster size in bytes */
+unsigned char  *raster;     /* raw file data */
+unsigned char  *src;        /* current row of raw data */
+pixel          *line;       /* current row converted to pixels */
+pixel          *dst;        /* current row of channel m */
+double         scale;       /* rescaling factor for 16-bit data */
+
+h  = u->halo;
+nc = u->nc;
+nx = u->nx;
+ny = u->ny;
+n  = nc * nx;
+if ((max_value < 1) || (max_value > 65535))
+   {
+   printf ("%s: unsupported maximal value %ld\n", caller, max_value);
+   exit(1);
+   }
+bps = (max_value > 255) ? 2 : 1;
+
+/* read raster in one call */
+size = (size_t)(n * ny * bps);
+raster = (unsigned char *) malloc (size);
+line   = (pixel *) malloc (n * sizeof(pixel));
+if ((raster == NULL) || (line == NULL))
+   {
+   printf ("%s: not enough memory available\n", caller);
+   exit(1);
+   }
+if (fread (raster, 1, size, inimage) != size)
+   {
+   printf ("%s: cannot read image data\n", caller);
+   exit(1);
+   }
+
+/* convert row by row */
+scale = 255.0 / (double) max_value;
+for (j=0; j<ny; j++)
+    {
+    src = raster + j * n * bps;
+
+    if (bps == 1)
+       {
+       if (nc == 1)
+          {
+          /* greyscale: widen directly into the image row */
+          bytes_to_pixels (src, ROW(u,j+h) + h, nx);
+          continue;
+          }
+       bytes_to_pixels (src, line, n);
+       }
+    else
+       for (i=0; i<n; i++)
+           line[i] = scale * (double)((src[2*i] << 8) | src[2*i+1]);
+
+    /* distribute interleaved samples to the channels */
+    for (m=0; m<nc; m++)
+        {
+        dst = CROW(u,m,j+h) + h;
+        for (i=0; i<nx; i++)
+            dst[i] = line[i*nc+m];
+        }
+    }
+
+free (line);
+free (raster);
+
+return;
+
+}  /* read_raster */
+
+/*--------------------------------------------------------------------------*/
+
+static long   cache_size = 0;                 /* number of cache slots */
+static long   cache_next = 0;                 /* next slot to be replaced */
+static char   *cache_name[IMAGE_CACHE_MAX];   /* file names of cached images */
+static image  *cache_image[IMAGE_CACHE_MAX];  /* decoded images, halo 0 */
+static struct stat  cache_stat[IMAGE_CACHE_MAX];
+                                 /* device, inode, size and modification
+                                    time of the files when decoded */
+
+/*--------------------------------------------------------------------------*/
+
+static void cache_release
+
+     (long  k)     /* cache slot */
+
+/*
+  frees the cached image of slot k, if any
+*/
+
+{
+if (cache_image[k] != NULL)
+   {
+   free_image (cache_image[k]);
+   free (cache_name[k]);
+   cache_image[k] = NULL;
+   cache_name[k]  = NULL;
+   }
+
+return;
+
+}  /* cache_release */
+
+/*--------------------------------------------------------------------------*/
+
+void set_image_cache
+
+     (long  size)        /* number of decoded files to keep, 0 disables */
+
+/*
+  keeps up to size decoded input files resident so that batch runs which
+  read the same file several times decode it only once;
+  size = 0 releases all cached images and disables the cache
+*/
+
+{
+long  k;    /* loop variable */
+
+for (k=0; k<cache_size; k++)
+    cache_release (k);
+
+if (size < 0)
+   size = 0;
+if (size > IMAGE_CACHE_MAX)
+   size = IMAGE_CACHE_MAX;
+
+cache_size = size;
+cache_next = 0;
+for (k=0; k<cache_size; k++)
+    {
+    cache_image[k] = NULL;
+    cache_name[k]  = NULL;
+    }
+
+return;
+
+}  /* set_image_cache */
+
+/*--------------------------------------------------------------------------*/
+
+static void copy_interior
+
+     (image  *u,         /* source image, unchanged */
+      image  *v)         /* target image of the same size, output */
+
+/*
+  copies the relevant pixels of u into v; the images may have boundary
+  layers of different width
+*/
+
+{
+long  j, m;    /* loop variables */
+
+for (m=0; m<u->nc; m++)
+ for (j=0; j<u->ny; j++)
+     memcpy (CROW(v,m,j+v->halo) + v->halo, CROW(u,m,j+u->halo) + u->halo,
+             (size_t)(u->nx) * sizeof(pixel));
+
+return;
+
+}  /* copy_interior */
+
+/*--------------------------------------------------------------------------*/
+
+static long cache_fetch
+
+     (const char  *file_name,    /* name of image file */
+      long        halo,          /* width of boundary layer */
+      image       **u)           /* image, output */
+
+/*
+  if file_name has been decoded before and the file has not changed since
+  (same device, inode, size and modification time), allocates u and fills
+  it from the cache; returns 1 on success and 0 otherwise
+*/
+
+{
+long         k;    /* loop variable */
+struct stat  st;   /* current state of the file */
+
+for (k=0; k<cache_size; k++)
+    if ((cache_name[k] != NULL) && (strcmp (cache_name[k], file_name) == 0))
+       {
+       if ((stat (file_name, &st) != 0)
+           || (st.st_dev   != cache_stat[k].st_dev)
+           || (st.st_ino   != cache_stat[k].st_ino)
+           || (st.st_size  != cache_stat[k].st_size)
+           || (st.st_mtime != cache_stat[k].st_mtime))
+          {
+          /* stale entry */
+          cache_release (k);
+          return (0);
+          }
+       alloc_image (u, cache_image[k]->nc, cache_image[k]->nx,
+                    cache_image[k]->ny, halo);
+       copy_interior (cache_image[k], *u);
+       return (1);
+       }
+
+return (0);
+
+}  /* cache_fetch */
+
+/*--------------------------------------------------------------------------*/
+
+static void cache_store
+
+     (const char  *file_name,    /* name of image file */
+      image       *u)            /* decoded image, unchanged */
+
+/*
+  keeps a copy of the decoded image u; replaces the oldest entry if all
+  slots are in use
+*/
+
+{
+long         k;    /* slot */
+struct stat  st;   /* state of the file */
+
+if ((cache_size == 0) || (stat (file_name, &st) != 0))
+   return;
+
+k = cache_next;
+cache_next = (cache_next + 1) % cache_size;
+
+cache_release (k);
+cache_stat[k] = st;
+alloc_image (&cache_image[k], u->nc, u->nx, u->ny, 0);
+copy_interior (u, cache_image[k]);
+cache_name[k] = (char *) malloc (strlen (file_name) + 1);
+if (cache_name[k] == NULL)
+   {
+   printf("cache_store: not enough memory available\n");
+   exit(1);
+   }
+strcpy (cache_name[k], file_name);
+
+return;
+
+}  /* cache_store */
+
+/*--------------------------------------------------------------------------*/
+
+static void cache_drop
+
+     (const char  *file_name)    /* name of a file that has been written */
+
+/*
+  removes all cached images of file_name, also under other names of the
+  same file, so that later reads see the new contents
+*/
+
+{
+long         k;    /* loop variable */
+struct stat  st;   /* state of the file */
+long         ok;   /* 1 if st is valid */
+
+ok = (stat (file_name, &st) == 0);
+for (k=0; k<cache_size; k++)
+    if ((cache_name[k] != NULL)
+        && ((strcmp (cache_name[k], file_name) == 0)
+            || (ok && (st.st_dev == cache_stat[k].st_dev)
+                   && (st.st_ino == cache_stat[k].st_ino))))
+       cache_release (k);
+
+return;
+
+}  /* cache_drop */
+
+/*--------------------------------------------------------------------------*/
+
+void read_pgm_to_double
+
+     (const char  *file_name,    /* name of pgm file */
+      long        halo,          /* width of boundary layer */
+      image       **u)           /* image, output */
+
+/*
+  reads a greyscale image that has been encoded in pgm format P5 to
+  an image u in double format;
+  allocates memory for the image u;
+  adds boundary layers of size halo;
+  served from the cache of decoded files if enabled (set_image_cache)
+*/
+
+{
+long  nc;           /* number of channels */
+long  nx, ny;       /* image size */
+long  max_value;    /* maximum color value */
+FILE  *inimage;     /* input file */
+
+/* decoded before? */
+if (cache_fetch (file_name, halo, u))
+   {
+   if ((*u)->nc != 1)
+      {
+      printf ("read_pgm_to_double: unknown image format\n");
+      exit(1);
+      }
+   return;
+   }
+
+inimage = read_header ("read_pgm_to_double", file_name,
+                       &nc, &nx, &ny, &max_value);
+if (nc != 1)
+   {
+   printf ("read_pgm_to_double: unknown image format\n");
+   exit(1);
+   }
+
+/* allocate memory */
+alloc_image (u, 1, nx, ny, halo);
+
+/* read image data */
+read_raster ("read_pgm_to_double", inimage, max_value, *u);
+
+/* close file */
+fclose (inimage);
+cache_store (file_name, *u);
+
+return;
+
+}  /* read_pgm_to_double */
+
+/*--------------------------------------------------------------------------*/
+
+void read_pgm_or_ppm_to_double
+
+     (const char  *file_name,    /* name of image file */
+      long        halo,          /* width of boundary layer */
+      image       **u)           /* image, output */
+
+/*
+  reads a greyscale image (pgm format P5) or a colour image (ppm format P6);
+  allocates memory for the double format image u with 1 or 3 channels;
+  adds boundary layers of size halo;
+  served from the cache of decoded files if enabled (set_image_cache)
+*/
+
+{
+long  nc;           /* number of channels */
+long  nx, ny;       /* image size */
+long  max_value;    /* maximum color value */
+FILE  *inimage;     /* input file */
+
+/* decoded before? */
+if (cache_fetch (file_name, halo, u))
+   return;
+
+inimage = read_header ("read_pgm_or_ppm_to_double", file_name,
+                       &nc, &nx, &ny, &max_value);
+
+/* allocate memory */
+alloc_image (u, nc, nx, ny, halo);
+
+/* read image data */
+read_raster ("read_pgm_or_ppm_to_double", inimage, max_value, *u);
+
+/* close file */
+fclose(inimage);
+cache_store (file_name, *u);
+
+return;
+
+}  /* read_pgm_or_ppm_to_double */
+
+/*--------------------------------------------------------------------------*/
+
+static void pixels_to_bytes
+
+     (const pixel    *src,   /* samples */
+      unsigned char  *dst,   /* rounded and clamped bytes, output */
+      long           n)      /* number of samples */
+
+/*
+  rounds n pixels to the nearest integer and saturates them to [0,255];
+  uses SSE2 for 8 samples at a time where available
+*/
+
+{
+long    k = 0;   /* sample index */
+double  aux;     /* auxiliary variable */
+
+#if defined(__SSE2__)
+__m128d  half = _mm_set1_pd (0.499999);   /* for correct rounding */
+__m128d  lo   = _mm_setzero_pd ();        /* lower bound */
+__m128d  hi   = _mm_set1_pd (255.0);      /* upper bound */
+__m128i  d0, d1, d2, d3;                  /* truncated samples */
+
+for (; k+8<=n; k+=8)
+    {
+    d0 = _mm_cvttpd_epi32 (_mm_min_pd (_mm_max_pd (_mm_add_pd
+            (LOAD_PD (src + k), half), lo), hi));
+    d1 = _mm_cvttpd_epi32 (_mm_min_pd (_mm_max_pd (_mm_add_pd
+            (LOAD_PD (src + k + 2), half), lo), hi));
+    d2 = _mm_cvttpd_epi32 (_mm_min_pd (_mm_max_pd (_mm_add_pd
+            (LOAD_PD (src + k + 4), half), lo), hi));
+    d3 = _mm_cvttpd_epi32 (_mm_min_pd (_mm_max_pd (_mm_add_pd
+            (LOAD_PD (src + k + 6), half), lo), hi));
+    d0 = _mm_unpacklo_epi64 (d0, d1);
+    d2 = _mm_unpacklo_epi64 (d2, d3);
+    d0 = _mm_packs_epi32 (d0, d2);
+    _mm_storel_epi64 ((__m128i *)(dst + k), _mm_packus_epi16 (d0, d0));
+    }
+#endif
+
+/* remaining samples */
+for (; k<n; k++)
+    {
+    aux = src[k] + 0.499999;    /* for correct rounding */
+    if (aux < 0.0)
+       dst[k] = (unsigned char)(0.0);
+    else if (aux > 255.0)
+       dst[k] = (unsigned char)(255.0);
+    else
+       dst[k] = (unsigned char)(aux);
+    }
+
+return;
+
+}  /* pixels_to_bytes */
+
+/*--------------------------------------------------------------------------*/
+
+void write_double_to_pgm_or_ppm_fd
+
+     (image   *u,           /* image with 1 or 3 channels, unchanged */
+      int     fd,           /* open file descriptor, e.g. end of a pipe */
+      char    *comments)    /* comment string (set 0 for no comments) */
+
+/*
+  writes a double format image as pgm P5 (greyscale) or ppm P6 (colour)
+  to the file descriptor fd, which is left open;
+  header and raster are assembled in one buffer and handed to write(2)
+  in a single call (repeated only for partial writes on pipes)
+*/
+
+{
+long           i, j, m;     /* loop variables */
+long           h;           /* width of boundary layer */
+long           nc, nx, ny;  /* image size */
+size_t         head;        /* header size in bytes */
+size_t         size;        /* total size in bytes */
+size_t         done;        /* bytes written so far */
+ssize_t        count;       /* result of write */
+unsigned char  *buffer;     /* header and raster */
+unsigned char  *dst;        /* current row of the raster */
+pixel          *line;       /* current row, channels interleaved */
+pixel          *src;        /* current row of channel m */
+
+nc = u->nc;
+nx = u->nx;
+ny = u->ny;
+h  = u->halo;
+
+if ((nc != 1) && (nc != 3))
+   {
+   printf ("write_double_to_pgm_or_ppm_fd: unsupported number of "
+           "channels\n");
+   exit(1);
+   }
+
+/* ---- header ---- */
+
+head = strlen ("P5\n") + 2 * 24 + strlen (" \n255\n");
+if (comments != 0)
+   head = head + strlen (comments);
+
+buffer = (unsigned char *) malloc (head + (size_t)(nc * nx * ny));
+line   = (pixel *) malloc ((size_t)(nc * nx) * sizeof (pixel));
+if ((buffer == NULL) || (line == NULL))
+   {
+   printf("write_double_to_pgm_or_ppm_fd: not enough memory available\n");
+   exit(1);
+   }
+
+head = (size_t) sprintf ((char *) buffer, "%s%s%ld %ld\n255\n",
+                         (nc == 1) ? "P5\n" : "P6\n",
+                         (comments != 0) ? comments : "", nx, ny);
+
+/* ---- raster ---- */
+
+dst = buffer + head;
+for (j=h; j<h+ny; j++)
+    {
+    if (nc == 1)
+       pixels_to_bytes (ROW(u,j) + h, dst, nx);
+    else
+       {
+       /* interleave channels as stored in the file */
+       for (m=0; m<nc; m++)
+           {
+           src = CROW(u,m,j) + h;
+           for (i=0; i<nx; i++)
+               line[i*nc+m] = src[i];
+           }
+       pixels_to_bytes (line, dst, nc * nx);
+       }
+    dst = dst + nc * nx;
+    }
+size = (size_t)(dst - buffer);
+
+/* ---- write ---- */
+
+for (done=0; done<size; done+=(size_t)count)
+    {
+    count = write (fd, buffer + done, size - done);
+    if (count < 0)
+       {
+       if (errno == EINTR)
+          {
+          count = 0;
+          continue;
+          }
+       printf("write_double_to_pgm_or_ppm_fd: write error, aborting\n");
+       exit(1);
+       }
+    }
+
+free (line);
+free (buffer);
+return;
+
+}  /* write_double_to_pgm_or_ppm_fd */
+
+/*--------------------------------------------------------------------------*/
+
+void write_double_to_pgm_or_ppm
+
+     (image   *u,           /* image with 1 or 3 channels, unchanged */
+      char    *file_name,   /* name of pgm/ppm file */
+      char    *comments)    /* comment string (set 0 for no comments) */
+
+/*
+  writes a double format image into a pgm P5 (greyscale) or
+  ppm P6 (colour) file
+*/
+
+{
+int  fd;    /* output file descriptor */
+
+/* open file */
+fd = open (file_name, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+if (fd < 0)
+   {
+   printf("could not open file '%s' for writing, aborting\n", file_name);
+   exit(1);
+   }
+
+write_double_to_pgm_or_ppm_fd (u, fd, comments);
+
+/* close file */
+if (close (fd) != 0)
+   {
+   printf("could not close file '%s', aborting\n", file_name);
+   exit(1);
+   }
+
+/* later reads of this file must not see a cached older version */
+cache_drop (file_name);
+
+return;
+
+}  /* write_double_to_pgm_or_ppm */
+
+/*--------------------------------------------------------------------------*/
+
+void write_double_to_pgm
+
+     (image   *u,           /* image, unchanged */
+      char    *file_name,   /* name of pgm file */
+      char    *comments)    /* comment string (set 0 for no comments) */
+
+/*
+  writes a greyscale image in double format into a pgm P5 file
+*/
+
+{
+image  c;    /* view on the first channel */
+
+image_channel (u, 0, &c);
+write_double_to_pgm_or_ppm (&c, file_name, comments);
+
+return;
+
+}  /* write_double_to_pgm */
+
+/*--------------------------------------------------------------------------*/
+
+void stats_init
+
+     (image_stats  *s)   /* statistics, output */
+
+/*
+  sets s to the statistics of an empty sample
+*/
+
+{
+s->n    = 0.0;
+s->min  = 0.0;
+s->max  = 0.0;
+s->mean = 0.0;
+s->m2   = 0.0;
+
+return;
+
+}  /* stats_init */
+
+/*--------------------------------------------------------------------------*/
+
+void stats_merge
+
+     (image_stats        *s,   /* statistics, changed */
+      const image_stats  *t)   /* statistics to be added, unchanged */
+
+/*
+  combines the statistics of two disjoint samples (Chan et al.);
+  numerically safe since only means and centred sums are combined
+*/
+
+{
+double  n;        /* joint number of samples */
+double  delta;    /* difference of the means */
+
+if (t->n == 0.0)
+   return;
+if (s->n == 0.0)
+   {
+   *s = *t;
+   return;
+   }
+
+n     = s->n + t->n;
+delta = t->mean - s->mean;
+
+if (t->min < s->min) s->min = t->min;
+if (t->max > s->max) s->max = t->max;
+s->mean = s->mean + delta * (t->n / n);
+s->m2   = s->m2 + t->m2 + delta * delta * (s->n * t->n / n);
+s->n    = n;
+
+return;
+
+}  /* stats_merge */
+
+/*--------------------------------------------------------------------------*/
+
+void stats_add_row
+
+     (image_stats   *s,     /* statistics, changed */
+      const pixel   *row,   /* samples, unchanged */
+      long          n)      /* number of samples */
+
+/*
+  adds n samples to s; the row is swept once for extrema and sum and, while
+  it is still in cache, once more for the centred sum of squares;
+  filters can call this on every finished row of their last pass
+*/
+
+{
+long         i = 0;    /* loop variable */
+double       min;      /* row minimum */
+double       max;      /* row maximum */
+double       sum;      /* row sum */
+double       mean;     /* row mean */
+double       m2;       /* centred sum of squares */
+double       help;     /* auxiliary variable */
+image_stats  r;        /* statistics of the row */
+
+if (n <= 0)
+   return;
+
+min = max = row[0];
+sum = m2 = 0.0;
+
+#if defined(__SSE2__)
+{
+__m128d  vmin = _mm_set1_pd (row[0]);   /* extrema, 2 lanes */
+__m128d  vmax = vmin;
+__m128d  vs0  = _mm_setzero_pd ();      /* partial sums, 4 lanes */
+__m128d  vs1  = _mm_setzero_pd ();
+__m128d  vm, a, b;                      /* mean, samples */
+double   lane[2];                       /* for horizontal reduction */
+
+for (; i+4<=n; i+=4)
+    {
+    a = LOAD_PD (row + i);
+    b = LOAD_PD (row + i + 2);
+    vmin = _mm_min_pd (vmin, _mm_min_pd (a, b));
+    vmax = _mm_max_pd (vmax, _mm_max_pd (a, b));
+    vs0  = _mm_add_pd (vs0, a);
+    vs1  = _mm_add_pd (vs1, b);
+    }
+_mm_storeu_pd (lane, vmin);
+min = (lane[0] < lane[1]) ? lane[0] : lane[1];
+_mm_storeu_pd (lane, vmax);
+max = (lane[0] > lane[1]) ? lane[0] : lane[1];
+_mm_storeu_pd (lane, _mm_add_pd (vs0, vs1));
+sum = lane[0] + lane[1];
+for (; i<n; i++)
+    {
+    if (row[i] < min) min = row[i];
+    if (row[i] > max) max = row[i];
+    sum = sum + row[i];
+    }
+mean = sum / n;
+
+vm  = _mm_set1_pd (mean);
+vs0 = _mm_setzero_pd ();
+vs1 = _mm_setzero_pd ();
+for (i=0; i+4<=n; i+=4)
+    {
+    a = _mm_sub_pd (LOAD_PD (row + i), vm);
+    b = _mm_sub_pd (LOAD_PD (row + i + 2), vm);
+    vs0 = _mm_add_pd (vs0, _mm_mul_pd (a, a));
+    vs1 = _mm_add_pd (vs1, _mm_mul_pd (b, b));
+    }
+_mm_storeu_pd (lane, _mm_add_pd (vs0, vs1));
+m2 = lane[0] + lane[1];
+}
+#else
+for (; i<n; i++)
+    {
+    if (row[i] < min) min = row[i];
+    if (row[i] > max) max = row[i];
+    sum = sum + row[i];
+    }
+mean = sum / n;
+i = 0;
+#endif
+
+/* remaining samples */
+for (; i<n; i++)
+    {
+    help = row[i] - mean;
+    m2   = m2 + help * help;
+    }
+
+r.n    = (double) n;
+r.min  = min;
+r.max  = max;
+r.mean = mean;
+r.m2   = m2;
+stats_merge (s, &r);
+
+return;
+
+}  /* stats_add_row */
+
+/*--------------------------------------------------------------------------*/
+
+void stats_result
+
+     (const image_stats  *s,      /* statistics, unchanged */
+      double             *min,    /* minimum, output */
+      double             *max,    /* maximum, output */
+      double             *mean,   /* mean, output */
+      double             *std)    /* standard deviation, output */
+
+/*
+  returns minimum, maximum, mean, and standard deviation of the sample
+*/
+
+{
+*min  = s->min;
+*max  = s->max;
+*mean = s->mean;
+*std  = (s->n > 0.0) ? sqrt (s->m2 / s->n) : 0.0;
+
+return;
+
+}  /* stats_result */
+
+/*--------------------------------------------------------------------------*/
+
+typedef struct
+   {
+   image        *u;      /* image */
+   long         m;       /* channel */
+   image_stats  *row;    /* statistics of each row, output */
+   } stats_task;
+
+/*--------------------------------------------------------------------------*/
+
+static void stats_rows
+
+     (long  first,       /* first storage row */
+      long  last,        /* last storage row */
+      void  *arg)        /* stats_task */
+
+/*
+  statistics of the rows first,...,last of one channel
+*/
+
+{
+stats_task  *t = (stats_task *) arg;   /* task */
+long        h = t->u->halo;            /* width of boundary layer */
+long        j;                         /* loop variable */
+
+for (j=first; j<=last; j++)
+    {
+    stats_init (&t->row[j-h]);
+    stats_add_row (&t->row[j-h], CROW(t->u,t->m,j) + h, t->u->nx);
+    }
+
+return;
+
+}  /* stats_rows */
+
+/*--------------------------------------------------------------------------*/
+
+static void stats_channel
+
+     (image        *u,   /* image, unchanged */
+      long         m,    /* channel */
+      image_stats  *s)   /* statistics of channel m, output */
+
+/*
+  computes the statistics of channel m in one sweep; the rows are
+  processed in parallel and their statistics are merged in row order, so
+  the result does not depend on the number of threads
+*/
+
+{
+stats_task  task;    /* rows to be processed */
+long        j;       /* loop variable */
+
+task.u   = u;
+task.m   = m;
+task.row = (image_stats *) malloc ((size_t) u->ny * sizeof(image_stats));
+if (task.row == NULL)
+   {
+   printf("stats_channel: not enough memory available\n");
+   exit(1);
+   }
+
+parallel_rows (u->halo, u->halo + u->ny - 1, stats_rows, &task);
+
+stats_init (s);
+for (j=0; j<u->ny; j++)
+    stats_merge (s, &task.row[j]);
+
+free (task.row);
+return;
+
+}  /* stats_channel */
+
+/*--------------------------------------------------------------------------*/
+
+void analyse_grey_double
+
+     (image   *u,          /* image, unchanged */
+      double  *min,        /* minimum, output */
+      double  *max,        /* maximum, output */
+      double  *mean,       /* mean, output */
+      double  *std)        /* standard deviation, output */
+
+/*
+  computes minimum, maximum, mean, and standard deviation of a greyscale
+  image u in double format
+*/
+
+{
+image_stats  s;    /* statistics */
+
+stats_channel (u, 0, &s);
+stats_result (&s, min, max, mean, std);
+
+return;
+
+}  /* analyse_grey_double */
+
+/*--------------------------------------------------------------------------*/
+
+void analyse_colour_double
+
+     (image   *u,          /* image, unchanged */
+      double  *min,        /* minimum, output */
+      double  *max,        /* maximum, output */
+      double  *mean,       /* mean, output */
+      double  *std)        /* standard deviation, output */
+
+/*
+  computes minimum, maximum, mean and standard deviation of a
+  vector-valued double format image u;
+  the standard deviation measures the deviation of each channel from its
+  own mean
+*/
+
+{
+long         m;     /* loop variable */
+double       m2;    /* sum of the centred sums of squares */
+double       n;     /* total number of samples */
+image_stats  s;     /* statistics of one channel */
+
+*mean = 0.0;
+m2    = 0.0;
+n     = 0.0;
+
+for (m=0; m<u->nc; m++)
+    {
+    stats_channel (u, m, &s);
+    if ((m == 0) || (s.min < *min)) *min = s.min;
+    if ((m == 0) || (s.max > *max)) *max = s.max;
+    *mean = *mean + s.mean;
+    m2    = m2 + s.m2;
+    n     = n + s.n;
+    }
+
+*mean = *mean / u->nc;
+*std  = sqrt (m2 / n);
+
+return;
+
+}  /* analyse_colour_double */
@@ -0,0 +1,127 @@
+#ifndef IMAGE_H
+#define IMAGE_H
+
+/*--------------------------------------------------------------------------*/
+/*                                                                          */
+/*                      SHARED IMAGE CONTAINER AND I/O                      */
+/*                                                                          */
+/*--------------------------------------------------------------------------*/
+
+/*
+  All programs store their images in one contiguous, 64-byte aligned
+  buffer per image instead of one allocation per column.
+  Pixels are addressed with storage indices (i,j) where
+  - the relevant image pixels in x direction use halo,...,halo+nx-1
+  - the relevant image pixels in y direction use halo,...,halo+ny-1
+  With halo = 1 this is the familiar 1,...,nx / 1,...,ny convention with
+  a boundary layer of size 1 around the image.
+  The storage is row-major like the pgm/ppm scanline order: pixels that
+  are neighbours in x direction are neighbours in memory. Kernels should
+  therefore loop over j outside and over i inside.
+  Pixels are of type pixel: double by default, float when compiled with
+  -DIMAGE_FLOAT, which halves the memory traffic of every pass. Sums,
+  statistics and the arithmetic inside the transforms and filters stay
+  in double; only the stored values are rounded to float.
+*/
+
+/*--------------------------------------------------------------------------*/
+
+#define IMAGE_ALIGN  64    /* alignment of pixel buffers in bytes */
+
+#if defined(IMAGE_FLOAT)
+typedef float   pixel;
+#else
+typedef double  pixel;
+#endif
+
+typedef struct
+   {
+   pixel   *data;      /* pixel buffer including halo, 64-byte aligned */
+   long    nc;         /* number of channels */
+   long    nx;         /* image size in x direction (without halo) */
+   long    ny;         /* image size in y direction (without halo) */
+   long    halo;       /* width of boundary layer on each side */
+   long    stride;     /* distance between neighbouring rows */
+   long    plane;      /* distance between neighbouring channels */
+   } image;
+
+/* pixel (i,j) of a single channel image */
+#define PIX(u,i,j)      ((u)->data[(j) * (u)->stride + (i)])
+
+/* pixel (i,j) of channel m */
+#define CPIX(u,m,i,j)   ((u)->data[(m) * (u)->plane + (j) * (u)->stride + (i)])
+
+/* pointer to row j (storage index i = 0) of a single channel image */
+#define ROW(u,j)        ((u)->data + (j) * (u)->stride)
+
+/* pointer to row j of channel m */
+#define CROW(u,m,j)     ((u)->data + (m) * (u)->plane + (j) * (u)->stride)
+
+/* running statistics of a sample, see stats_add_row */
+typedef struct
+   {
+   double  n;          /* number of samples */
+   double  min;        /* minimum */
+   double  max;        /* maximum */
+   double  mean;       /* mean */
+   double  m2;         /* sum of squared deviations from the mean */
+   } image_stats;
+
+/*--------------------------------------------------------------------------*/
+
+long image_pixels
+     (long nc, long nx, long ny, long halo);
+
+void image_view
+     (image *v, pixel *data, long nc, long nx, long ny, long halo);
+
+void alloc_image
+     (image **u, long nc, long nx, long ny, long halo);
+
+void free_image
+     (image *u);
+
+void image_channel
+     (image *u, long m, image *c);
+
+void copy_image
+     (image *u, image *v);
+
+void set_image_cache
+     (long size);
+
+void read_pgm_to_double
+     (const char *file_name, long halo, image **u);
+
+void read_pgm_or_ppm_to_double
+     (const char *file_name, long halo, image **u);
+
+void write_double_to_pgm
+     (image *u, char *file_name, char *comments);
+
+void write_double_to_pgm_or_ppm
+     (image *u, char *file_name, char *comments);
+
+void write_double_to_pgm_or_ppm_fd
+     (image *u, int fd, char *comments);
+
+void stats_init
+     (image_stats *s);
+
+void stats_add_row
+     (image_stats *s, const pixel *row, long n);
+
+void stats_merge
+     (image_stats *s, const image_stats *t);
+
+void stats_result
+     (const image_stats *s, double *min, double *max, double *mean,
+      double *std);
+
+void analyse_grey_double
+     (image *u, double *min, double *max, double *mean, double *std);
+
+void analyse_colour_double
+     (image *u, double *min, double *max, double *mean, double *std);
+
+#endif
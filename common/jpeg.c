@@ -0,0 +1,1054 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdint.h>
+
+#include "image.h"
+#include "parallel.h"
+#include "fft.h"
+#include "dct.h"
+#include "quant.h"
+#include "jpeg.h"
+
+/*--------------------------------------------------------------------------*/
+/*                                                                          */
+/*                  BASELINE JPEG ENCODING AND DECODING                     */
+/*                                                                          */
+/*--------------------------------------------------------------------------*/
+
+/*
+  sequential Huffman coded JPEG of greyscale images, JFIF files
+*/
+
+/*--------------------------------------------------------------------------*/
+
+#define JPEG_LOOKAHEAD    9     /* bits of the Huffman lookup table */
+#define JPEG_BLOCK_BYTES  512   /* upper bound of one coded block, with
+                                   byte stuffing */
+
+/* example luminance table of Annex K, entry 8l+k */
+const double jpeg_luminance[QUANT_TABLE_SIZE] =
+   { 16,  11,  10,  16,  24,  40,  51,  61,
+     12,  12,  14,  19,  26,  58,  60,  55,
+     14,  13,  16,  24,  40,  57,  69,  56,
+     14,  17,  22,  29,  51,  87,  80,  62,
+     18,  22,  37,  56,  68, 109, 103,  77,
+     24,  35,  55,  64,  81, 104, 113,  92,
+     49,  64,  78,  87, 103, 121, 120, 101,
+     72,  92,  95,  98, 112, 100, 103,  99 };
+
+/* position 8l+k of the zig-zag index */
+static const int zigzag[64] =
+   {  0,  1,  8, 16,  9,  2,  3, 10,
+     17, 24, 32, 25, 18, 11,  4,  5,
+     12, 19, 26, 33, 40, 48, 41, 34,
+     27, 20, 13,  6,  7, 14, 21, 28,
+     35, 42, 49, 56, 57, 50, 43, 36,
+     29, 22, 15, 23, 30, 37, 44, 51,
+     58, 59, 52, 45, 38, 31, 39, 46,
+     53, 60, 61, 54, 47, 55, 62, 63 };
+
+/* Huffman tables of Annex K: number of codes of length 1,...,16, symbols */
+static const unsigned char dc_bits[16] =
+   { 0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0 };
+static const unsigned char dc_symbols[12] =
+   { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 };
+static const unsigned char ac_bits[16] =
+   { 0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7d };
+static const unsigned char ac_symbols[162] =
+   { 0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12,
+     0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07,
+     0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xa1, 0x08,
+     0x23, 0x42, 0xb1, 0xc1, 0x15, 0x52, 0xd1, 0xf0,
+     0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0a, 0x16,
+     0x17, 0x18, 0x19, 0x1a, 0x25, 0x26, 0x27, 0x28,
+     0x29, 0x2a, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39,
+     0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+     0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59,
+     0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+     0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79,
+     0x7a, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+     0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98,
+     0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7,
+     0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6,
+     0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3, 0xc4, 0xc5,
+     0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4,
+     0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xe1, 0xe2,
+     0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea,
+     0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+     0xf9, 0xfa };
+
+/* Huffman code of each symbol, for the encoder */
+typedef struct
+   {
+   unsigned int   code[256];   /* code, right aligned */
+   unsigned char  size[256];   /* code length, 0 if not used */
+   } huff_code;
+
+/* Huffman table of the decoder */
+typedef struct
+   {
+   unsigned short  fast[1 << JPEG_LOOKAHEAD];
+                                /* (length << 8) | symbol for the codes
+                                   of up to JPEG_LOOKAHEAD bits, indexed
+                                   by the next bits; 0: longer code */
+   long            maxcode[17]; /* largest code of each length, -1: none */
+   long            offset[17];  /* symbol index minus code, per length */
+   unsigned char   symbol[256]; /* symbols in code order */
+   long            defined;     /* table has been read */
+   } huff_table;
+
+/* output buffer with 64-bit bit accumulator */
+typedef struct
+   {
+   unsigned char  *data;       /* bytes written so far */
+   long           size;        /* allocated bytes */
+   long           pos;         /* number of bytes written */
+   uint64_t       acc;         /* pending bits, right aligned */
+   long           bits;        /* number of pending bits */
+   } bit_writer;
+
+/* input of the entropy coded segment with 64-bit bit accumulator */
+typedef struct
+   {
+   const unsigned char  *data;   /* file contents */
+   long                 size;    /* file size */
+   long                 pos;     /* next byte */
+   uint64_t             acc;     /* bits read ahead, right aligned */
+   long                 bits;    /* number of bits in acc */
+   long                 marker;  /* 1: a marker ends the segment */
+   } bit_reader;
+
+/* data of the parallel loops */
+typedef struct
+   {
+   image              *u;       /* image */
+   short              *level;   /* levels of all blocks, zig-zag order */
+   const double       *step;    /* quantisation steps (decoder) */
+   const quant_table  *q;       /* quantisation table (encoder) */
+   long               bw;       /* number of blocks in x direction */
+   } block_task;
+
+/*--------------------------------------------------------------------------*/
+
+static void *alloc_buffer
+
+     (long  size)          /* size in bytes */
+
+/*
+  allocates memory or stops with an error message
+*/
+
+{
+void  *p;    /* buffer */
+
+p = malloc (size);
+if (p == NULL)
+   {
+   printf ("jpeg: not enough memory available\n");
+   exit(1);
+   }
+
+return (p);
+
+}  /* alloc_buffer */
+
+/*--------------------------------------------------------------------------*/
+/*                                                                          */
+/*                                 ENCODER                                  */
+/*                                                                          */
+/*--------------------------------------------------------------------------*/
+
+static void make_huff_code
+
+     (const unsigned char  *bits,      /* number of codes per length */
+      const unsigned char  *symbols,   /* symbols in code order */
+      huff_code            *h)         /* codes, output */
+
+/*
+  canonical Huffman codes of Annex C
+*/
+
+{
+long          len, i, k;    /* loop variables */
+unsigned int  code;         /* next code */
+
+memset (h, 0, sizeof (huff_code));
+code = 0;
+k    = 0;
+for (len=1; len<=16; len++)
+    {
+    for (i=0; i<bits[len-1]; i++)
+        {
+        h->code[symbols[k]] = code;
+        h->size[symbols[k]] = (unsigned char) len;
+        code++;
+        k++;
+        }
+    code = code << 1;
+    }
+
+return;
+
+}  /* make_huff_code */
+
+/*--------------------------------------------------------------------------*/
+
+static void reserve
+
+     (bit_writer  *w,      /* output buffer */
+      long        n)       /* number of bytes to come */
+
+/*
+  makes room for n more bytes
+*/
+
+{
+if (w->pos + n > w->size)
+   {
+   while (w->pos + n > w->size)
+      w->size = 2 * w->size;
+   w->data = (unsigned char *) realloc (w->data, w->size);
+   if (w->data == NULL)
+      {
+      printf ("jpeg_encode: not enough memory available\n");
+      exit(1);
+      }
+   }
+
+return;
+
+}  /* reserve */
+
+/*--------------------------------------------------------------------------*/
+
+static void put_word
+
+     (bit_writer  *w,      /* output buffer */
+      long        v)       /* 16-bit value */
+
+/*
+  appends a big-endian 16-bit value of a marker segment
+*/
+
+{
+reserve (w, 2);
+w->data[w->pos++] = (unsigned char) ((v >> 8) & 0xFF);
+w->data[w->pos++] = (unsigned char) (v & 0xFF);
+
+return;
+
+}  /* put_word */
+
+/*--------------------------------------------------------------------------*/
+
+static void put_table
+
+     (bit_writer           *w,         /* output buffer */
+      long                 id,         /* class and identifier */
+      const unsigned char  *bits,      /* number of codes per length */
+      const unsigned char  *symbols)   /* symbols in code order */
+
+/*
+  appends a DHT marker segment with one Huffman table
+*/
+
+{
+long  n, k;    /* number of symbols, loop variable */
+
+n = 0;
+for (k=0; k<16; k++)
+    n = n + bits[k];
+
+put_word (w, 0xFFC4);
+put_word (w, 2 + 1 + 16 + n);
+reserve (w, 1 + 16 + n);
+w->data[w->pos++] = (unsigned char) id;
+memcpy (w->data + w->pos, bits, 16);
+memcpy (w->data + w->pos + 16, symbols, n);
+w->pos = w->pos + 16 + n;
+
+return;
+
+}  /* put_table */
+
+/*--------------------------------------------------------------------------*/
+
+static inline void put_bits
+
+     (bit_writer    *w,      /* output buffer, room for 8 bytes */
+      unsigned int  code,    /* bits, right aligned */
+      long          len)     /* number of bits, at most 32 */
+
+/*
+  appends len bits; whenever 32 bits are complete they are written,
+  each 0xFF byte followed by a stuffed 0x00
+*/
+
+{
+unsigned int   word;    /* 32 complete bits */
+unsigned char  byte;    /* one byte of word */
+long           k;       /* loop variable */
+
+w->acc  = (w->acc << len) | code;
+w->bits = w->bits + len;
+
+if (w->bits >= 32)
+   {
+   w->bits = w->bits - 32;
+   word    = (unsigned int) (w->acc >> w->bits);
+   for (k=24; k>=0; k-=8)
+       {
+       byte = (unsigned char) (word >> k);
+       w->data[w->pos++] = byte;
+       if (byte == 0xFF)
+          w->data[w->pos++] = 0x00;
+       }
+   }
+
+return;
+
+}  /* put_bits */
+
+/*--------------------------------------------------------------------------*/
+
+static void flush_bits
+
+     (bit_writer  *w)      /* output buffer */
+
+/*
+  pads the pending bits with ones to a whole byte and writes them
+*/
+
+{
+unsigned char  byte;    /* next byte */
+
+reserve (w, 16);
+put_bits (w, (1u << ((8 - w->bits % 8) % 8)) - 1, (8 - w->bits % 8) % 8);
+while (w->bits > 0)
+   {
+   w->bits = w->bits - 8;
+   byte    = (unsigned char) (w->acc >> w->bits);
+   w->data[w->pos++] = byte;
+   if (byte == 0xFF)
+      w->data[w->pos++] = 0x00;
+   }
+
+return;
+
+}  /* flush_bits */
+
+/*--------------------------------------------------------------------------*/
+
+static void encode_rows
+
+     (long  first,       /* first row of blocks */
+      long  last,        /* last row of blocks */
+      void  *arg)        /* block_task */
+
+/*
+  shift, DCT and quantisation of the blocks in the block rows
+  first,...,last; the levels are stored in zig-zag order
+*/
+
+{
+block_task         *t = (block_task *) arg;   /* task */
+const quant_table  *q = t->q;                 /* quantisation table */
+long               nx = t->u->nx;             /* image size */
+long               ny = t->u->ny;             /* image size */
+long               h  = t->u->halo;           /* boundary layer */
+long               b, bx, k, l;               /* loop variables */
+long               i, j;                      /* pixel indices */
+long               v;                         /* level */
+short              *level;                    /* levels of the block */
+pixel              *row;                      /* current image row */
+double             block[64];                 /* 8x8 block */
+
+for (b=first; b<=last; b++)
+ for (bx=0; bx<t->bw; bx++)
+     {
+     /* copy and shift 8x8 block, repeat last row / column */
+     for (l=0; l<=7; l++)
+         {
+         j   = (8 * b + l < ny) ? 8 * b + l : ny - 1;
+         row = ROW(t->u,h+j) + h;
+         for (k=0; k<=7; k++)
+             {
+             i = (8 * bx + k < nx) ? 8 * bx + k : nx - 1;
+             block[8*l+k] = row[i] - 128.0;
+             }
+         }
+
+     /* DCT of 8x8 block, levels */
+     dct8x8 (block);
+     quant_levels8x8 (q, block);
+
+     /* zig-zag order; clip to the range of baseline JPEG */
+     level = t->level + 64 * (b * t->bw + bx);
+     for (k=0; k<64; k++)
+         {
+         v = (long) block[zigzag[k]];
+         if (v > 1023)
+            v = 1023;
+         if (v < -1023)
+            v = -1023;
+         level[k] = (short) v;
+         }
+     }
+
+return;
+
+}  /* encode_rows */
+
+/*--------------------------------------------------------------------------*/
+
+long jpeg_encode
+
+     (image              *u,           /* greyscale image, unchanged */
+      const quant_table  *q,           /* quantisation table */
+      char               *file_name)   /* JFIF file, output */
+
+/*
+  writes u as baseline JPEG file; returns the file size in bytes
+*/
+
+{
+block_task      t;                /* task */
+bit_writer      w;                /* output buffer */
+huff_code       dc, ac;           /* Huffman codes */
+unsigned char   category[2048];   /* number of bits of a magnitude */
+short           *level;           /* levels of the current block */
+long            bw, bh;           /* number of blocks */
+long            n, k;             /* loop variables */
+long            pred;             /* DC level of the previous block */
+long            v, a, s;          /* value, magnitude, category */
+long            run;              /* zeros before the current level */
+long            sym;              /* run / category symbol */
+FILE            *f;               /* output file */
+
+if ((u->nx > 65535) || (u->ny > 65535))
+   {
+   printf ("jpeg_encode: image too large for JPEG\n");
+   exit(1);
+   }
+
+/* ---- transform and quantise all blocks, in parallel ---- */
+
+bw      = (u->nx + 7) / 8;
+bh      = (u->ny + 7) / 8;
+t.u     = u;
+t.q     = q;
+t.bw    = bw;
+t.step  = NULL;
+t.level = (short *) alloc_buffer (64 * bw * bh * sizeof (short));
+parallel_rows (0, bh - 1, encode_rows, &t);
+
+/* ---- lookup tables ---- */
+
+make_huff_code (dc_bits, dc_symbols, &dc);
+make_huff_code (ac_bits, ac_symbols, &ac);
+category[0] = 0;
+for (a=1; a<2048; a++)
+    category[a] = (unsigned char) (category[a/2] + 1);
+
+/* ---- headers ---- */
+
+w.size = 4096 + bw * bh * 64;
+w.data = (unsigned char *) alloc_buffer (w.size);
+w.pos  = 0;
+w.acc  = 0;
+w.bits = 0;
+
+put_word (&w, 0xFFD8);                         /* SOI */
+put_word (&w, 0xFFE0);                         /* APP0: JFIF 1.01 */
+put_word (&w, 16);
+reserve (&w, 14);
+memcpy (w.data + w.pos, "JFIF\0\1\1\0\0\1\0\1\0\0", 14);
+w.pos = w.pos + 14;
+
+put_word (&w, 0xFFDB);                         /* DQT: table 0, 8 bit */
+put_word (&w, 2 + 1 + 64);
+reserve (&w, 65);
+w.data[w.pos++] = 0;
+for (k=0; k<64; k++)
+    w.data[w.pos++] = (unsigned char) q->step[zigzag[k]];
+
+put_word (&w, 0xFFC0);                         /* SOF0: one component */
+put_word (&w, 11);
+reserve (&w, 9);
+w.data[w.pos++] = 8;
+put_word (&w, u->ny);
+put_word (&w, u->nx);
+w.data[w.pos++] = 1;
+w.data[w.pos++] = 1;
+w.data[w.pos++] = 0x11;
+w.data[w.pos++] = 0;
+
+put_table (&w, 0x00, dc_bits, dc_symbols);     /* DHT */
+put_table (&w, 0x10, ac_bits, ac_symbols);
+
+put_word (&w, 0xFFDA);                         /* SOS */
+put_word (&w, 8);
+reserve (&w, 6);
+memcpy (w.data + w.pos, "\1\1\0\0\77\0", 6);
+w.pos = w.pos + 6;
+
+/* ---- entropy coding ---- */
+
+pred = 0;
+for (n=0; n<bw*bh; n++)
+    {
+    reserve (&w, JPEG_BLOCK_BYTES);
+    level = t.level + 64 * n;
+
+    /* DC: category of the difference, then its bits */
+    v    = level[0] - pred;
+    pred = level[0];
+    a    = (v < 0) ? -v : v;
+    s    = category[a];
+    if (v < 0)
+       v = v - 1;
+    put_bits (&w, (dc.code[s] << s) | (v & ((1 << s) - 1)), dc.size[s] + s);
+
+    /* AC: runs of zeros and categories */
+    run = 0;
+    for (k=1; k<64; k++)
+        {
+        v = level[k];
+        if (v == 0)
+           {
+           run++;
+           continue;
+           }
+        while (run > 15)
+           {
+           put_bits (&w, ac.code[0xF0], ac.size[0xF0]);
+           run = run - 16;
+           }
+        a   = (v < 0) ? -v : v;
+        s   = category[a];
+        sym = (run << 4) | s;
+        if (v < 0)
+           v = v - 1;
+        put_bits (&w, (ac.code[sym] << s) | (v & ((1 << s) - 1)),
+                  ac.size[sym] + s);
+        run = 0;
+        }
+    if (run > 0)
+       put_bits (&w, ac.code[0x00], ac.size[0x00]);
+    }
+
+flush_bits (&w);
+put_word (&w, 0xFFD9);                         /* EOI */
+
+/* ---- write file ---- */
+
+f = fopen (file_name, "wb");
+if (f == NULL)
+   {
+   printf ("jpeg_encode: cannot open file '%s'\n", file_name);
+   exit(1);
+   }
+if (fwrite (w.data, 1, w.pos, f) != (size_t) w.pos)
+   {
+   printf ("jpeg_encode: cannot write file '%s'\n", file_name);
+   exit(1);
+   }
+fclose (f);
+
+n = w.pos;
+free (w.data);
+free (t.level);
+return (n);
+
+}  /* jpeg_encode */
+
+/*--------------------------------------------------------------------------*/
+/*                                                                          */
+/*                                 DECODER                                  */
+/*                                                                          */
+/*--------------------------------------------------------------------------*/
+
+static void corrupt
+
+     (const char  *what)    /* description */
+
+/*
+  stops at an invalid or unsupported file
+*/
+
+{
+printf ("jpeg_decode: %s\n", what);
+exit(1);
+
+}  /* corrupt */
+
+/*--------------------------------------------------------------------------*/
+
+static void make_huff_table
+
+     (const unsigned char  *bits,      /* number of codes per length */
+      const unsigned char  *symbols,   /* symbols in code order */
+      huff_table           *h)         /* decoder table, output */
+
+/*
+  lookup table and code ranges of a canonical Huffman code
+*/
+
+{
+long  len, i, k, x;     /* loop variables */
+long  code;             /* next code */
+long  fill;             /* number of lookup entries of a code */
+
+memset (h->fast, 0, sizeof (h->fast));
+code = 0;
+k    = 0;
+for (len=1; len<=16; len++)
+    {
+    h->offset[len] = k - code;
+    for (i=0; i<bits[len-1]; i++)
+        {
+        h->symbol[k] = symbols[k];
+        if (len <= JPEG_LOOKAHEAD)
+           {
+           /* all continuations of the code point to its symbol */
+           fill = 1L << (JPEG_LOOKAHEAD - len);
+           for (x=0; x<fill; x++)
+               h->fast[(code << (JPEG_LOOKAHEAD - len)) + x] =
+                  (unsigned short) ((len << 8) | symbols[k]);
+           }
+        code++;
+        k++;
+        }
+    h->maxcode[len] = (bits[len-1] > 0) ? code - 1 : -1;
+    if (code > (1L << len))
+       corrupt ("invalid Huffman table");
+    code = code << 1;
+    }
+h->defined = 1;
+
+return;
+
+}  /* make_huff_table */
+
+/*--------------------------------------------------------------------------*/
+
+static inline void fill_bits
+
+     (bit_reader  *r)      /* input */
+
+/*
+  reads bytes into the accumulator until it holds more than 56 bits;
+  stuffed zero bytes are skipped, and at a marker zeros are fed in
+*/
+
+{
+unsigned int  c;    /* next byte */
+
+while (r->bits <= 56)
+   {
+   c = 0;
+   if ((!r->marker) && (r->pos < r->size))
+      {
+      c = r->data[r->pos];
+      if (c != 0xFF)
+         r->pos++;
+      else if ((r->pos + 1 < r->size) && (r->data[r->pos+1] == 0x00))
+         r->pos = r->pos + 2;
+      else
+         {
+         r->marker = 1;
+         c = 0;
+         }
+      }
+   r->acc  = (r->acc << 8) | c;
+   r->bits = r->bits + 8;
+   }
+
+return;
+
+}  /* fill_bits */
+
+/*--------------------------------------------------------------------------*/
+
+static inline long get_bits
+
+     (bit_reader  *r,      /* input, at least n bits read ahead */
+      long        n)       /* number of bits, at most 16 */
+
+/*
+  removes the next n bits and returns them
+*/
+
+{
+r->bits = r->bits - n;
+return ((long) ((r->acc >> r->bits) & ((1u << n) - 1)));
+
+}  /* get_bits */
+
+/*--------------------------------------------------------------------------*/
+
+static inline long decode_symbol
+
+     (bit_reader        *r,    /* input, at least 16 bits read ahead */
+      const huff_table  *h)    /* Huffman table */
+
+/*
+  decodes one Huffman coded symbol
+*/
+
+{
+long  e;       /* lookup entry */
+long  len;     /* code length */
+long  code;    /* code of length len */
+
+e = h->fast[(r->acc >> (r->bits - JPEG_LOOKAHEAD))
+            & ((1 << JPEG_LOOKAHEAD) - 1)];
+if (e != 0)
+   {
+   r->bits = r->bits - (e >> 8);
+   return (e & 0xFF);
+   }
+
+/* longer codes */
+for (len=JPEG_LOOKAHEAD+1; len<=16; len++)
+    {
+    code = (long) ((r->acc >> (r->bits - len)) & ((1u << len) - 1));
+    if (code <= h->maxcode[len])
+       {
+       r->bits = r->bits - len;
+       return (h->symbol[code + h->offset[len]]);
+       }
+    }
+
+corrupt ("invalid Huffman code");
+return (0);
+
+}  /* decode_symbol */
+
+/*--------------------------------------------------------------------------*/
+
+static inline long extend
+
+     (long  v,      /* s bits */
+      long  s)      /* category */
+
+/*
+  signed value of the s bits of a category s difference or level
+*/
+
+{
+return ((v < (1L << (s - 1))) ? v - (1L << s) + 1 : v);
+
+}  /* extend */
+
+/*--------------------------------------------------------------------------*/
+
+static void decode_rows
+
+     (long  first,       /* first row of blocks */
+      long  last,        /* last row of blocks */
+      void  *arg)        /* block_task */
+
+/*
+  dequantisation, inverse DCT, shift, rounding and clipping of the
+  blocks in the block rows first,...,last
+*/
+
+{
+block_task  *t = (block_task *) arg;   /* task */
+long        nx = t->u->nx;             /* image size */
+long        ny = t->u->ny;             /* image size */
+long        h  = t->u->halo;           /* boundary layer */
+long        b, bx, k, l;               /* loop variables */
+long        n;                         /* pixels of a block row in u */
+short       *level;                    /* levels of the block */
+pixel       *row;                      /* current image row */
+double      v;                         /* grey value */
+double      block[64];                 /* 8x8 block */
+
+for (b=first; b<=last; b++)
+ for (bx=0; bx<t->bw; bx++)
+     {
+     level = t->level + 64 * (b * t->bw + bx);
+     for (k=0; k<64; k++)
+         block[zigzag[k]] = level[k] * t->step[zigzag[k]];
+
+     /* inverse DCT of 8x8 block */
+     idct8x8 (block);
+
+     /* shift back, clip, round down (v >= 0), crop at the boundary */
+     n = (8 * bx + 8 <= nx) ? 8 : nx - 8 * bx;
+     for (l=0; (l<=7) && (8*b+l<ny); l++)
+         {
+         row = ROW(t->u,h+8*b+l) + h + 8 * bx;
+         for (k=0; k<n; k++)
+             {
+             v = block[8*l+k] + 128.5;
+             v = (v < 0.0) ? 0.0 : ((v > 255.0) ? 255.0 : v);
+             row[k] = (pixel) (long) v;
+             }
+         }
+     }
+
+return;
+
+}  /* decode_rows */
+
+/*--------------------------------------------------------------------------*/
+
+static void decode_scan
+
+     (bit_reader        *r,          /* input at the entropy coded data */
+      const huff_table  *dc,         /* DC table */
+      const huff_table  *ac,         /* AC table */
+      long              restart,     /* restart interval, 0: none */
+      long              blocks,      /* number of blocks */
+      short             *levels)     /* levels in zig-zag order, output */
+
+/*
+  Huffman decoding of all blocks of a single component scan
+*/
+
+{
+short  *level;      /* levels of the current block */
+long   n, k;        /* loop variables */
+long   pred;        /* DC level of the previous block */
+long   rs;          /* run / category symbol */
+long   s;           /* category */
+
+memset (levels, 0, 64 * blocks * sizeof (short));
+pred = 0;
+for (n=0; n<blocks; n++)
+    {
+    if ((restart > 0) && (n > 0) && (n % restart == 0))
+       {
+       /* skip the padding, expect RSTm */
+       while ((r->pos + 1 < r->size)
+              && ((r->data[r->pos] != 0xFF)
+                  || ((r->data[r->pos+1] & 0xF8) != 0xD0)))
+          r->pos++;
+       r->pos    = r->pos + 2;
+       r->marker = 0;
+       r->acc    = 0;
+       r->bits   = 0;
+       pred      = 0;
+       }
+
+    level = levels + 64 * n;
+
+    /* DC difference */
+    fill_bits (r);
+    s = decode_symbol (r, dc);
+    if (s > 11)
+       corrupt ("invalid DC difference");
+    if (s > 0)
+       pred = pred + extend (get_bits (r, s), s);
+    level[0] = (short) pred;
+
+    /* AC levels */
+    for (k=1; k<64; k++)
+        {
+        if (r->bits < 32)
+           fill_bits (r);
+        rs = decode_symbol (r, ac);
+        s  = rs & 15;
+        if (s == 0)
+           {
+           if (rs != 0xF0)
+              break;          /* end of block */
+           k = k + 15;        /* 16 zeros */
+           continue;
+           }
+        k = k + (rs >> 4);
+        if (k > 63)
+           corrupt ("invalid run length");
+        level[k] = (short) extend (get_bits (r, s), s);
+        }
+    }
+
+return;
+
+}  /* decode_scan */
+
+/*--------------------------------------------------------------------------*/
+
+long jpeg_decode
+
+     (char   *file_name,     /* JPEG file */
+      long   halo,           /* width of boundary layer */
+      image  **u)            /* greyscale image, allocated here */
+
+/*
+  reads a sequential greyscale JPEG file; returns its size in bytes
+*/
+
+{
+FILE           *f;                /* input file */
+unsigned char  *d;                /* file contents */
+long           size;              /* file size */
+long           pos, seg, next;    /* marker, segment data, next marker */
+long           m;                 /* marker code */
+long           k, n, id;          /* loop variables, table identifier */
+long           nx, ny;            /* image size */
+long           tq, td, ta;        /* table selectors */
+long           restart;           /* restart interval */
+long           bw, bh;            /* number of blocks */
+double         step[4][64];       /* quantisation tables, entry 8l+k */
+long           defined[4];        /* quantisation table has been read */
+huff_table     *dc, *ac;          /* Huffman tables 0,...,3 */
+bit_reader     r;                 /* input of the scan */
+block_task     t;                 /* task */
+
+/* ---- read file ---- */
+
+f = fopen (file_name, "rb");
+if (f == NULL)
+   {
+   printf ("jpeg_decode: cannot open file '%s'\n", file_name);
+   exit(1);
+   }
+fseek (f, 0, SEEK_END);
+size = ftell (f);
+fseek (f, 0, SEEK_SET);
+d = (unsigned char *) alloc_buffer (size + 1);
+if ((long) fread (d, 1, size, f) != size)
+   {
+   printf ("jpeg_decode: cannot read file '%s'\n", file_name);
+   exit(1);
+   }
+fclose (f);
+
+if ((size < 4) || (d[0] != 0xFF) || (d[1] != 0xD8))
+   corrupt ("not a JPEG file");
+
+/* ---- marker segments up to the scan ---- */
+
+dc = (huff_table *) alloc_buffer (4 * sizeof (huff_table));
+ac = (huff_table *) alloc_buffer (4 * sizeof (huff_table));
+for (k=0; k<4; k++)
+    defined[k] = dc[k].defined = ac[k].defined = 0;
+nx = ny = tq = restart = 0;
+pos = 2;
+
+for (;;)
+    {
+    if (pos + 4 > size)
+       corrupt ("unexpected end of file");
+    if (d[pos] != 0xFF)
+       corrupt ("marker expected");
+    m = d[pos+1];
+    if (m == 0xFF)
+       {
+       /* fill byte */
+       pos++;
+       continue;
+       }
+    seg  = pos + 4;
+    next = pos + 2 + ((d[pos+2] << 8) | d[pos+3]);
+    if (next > size)
+       corrupt ("unexpected end of file");
+
+    if (m == 0xDB)
+       {
+       /* DQT: tables of 8 or 16 bit steps in zig-zag order */
+       while (seg < next)
+          {
+          id = d[seg] & 15;
+          if ((id > 3) || (seg + 1 + ((d[seg] >> 4) ? 128 : 64) > next))
+             corrupt ("invalid quantisation table");
+          for (k=0; k<64; k++)
+              if (d[seg] >> 4)
+                 step[id][zigzag[k]] = (d[seg+1+2*k] << 8) | d[seg+2+2*k];
+              else
+                 step[id][zigzag[k]] = d[seg+1+k];
+          defined[id] = 1;
+          seg = seg + 1 + ((d[seg] >> 4) ? 128 : 64);
+          }
+       }
+    else if ((m == 0xC0) || (m == 0xC1))
+       {
+       /* SOF0 / SOF1: 8 bit, one component */
+       if (d[seg] != 8)
+          corrupt ("only 8 bit samples are supported");
+       ny = (d[seg+1] << 8) | d[seg+2];
+       nx = (d[seg+3] << 8) | d[seg+4];
+       if (d[seg+5] != 1)
+          corrupt ("only greyscale images are supported");
+       tq = d[seg+8] & 3;
+       if ((nx == 0) || (ny == 0))
+          corrupt ("invalid image size");
+       }
+    else if ((m >= 0xC2) && (m <= 0xCF) && (m != 0xC4) && (m != 0xC8)
+             && (m != 0xCC))
+       corrupt ("only sequential Huffman coding is supported");
+    else if (m == 0xC4)
+       {
+       /* DHT */
+       while (seg < next)
+          {
+          id = d[seg] & 15;
+          n  = 0;
+          for (k=0; k<16; k++)
+              n = n + d[seg+1+k];
+          if ((id > 3) || (n > 256) || (seg + 17 + n > next))
+             corrupt ("invalid Huffman table");
+          make_huff_table (d + seg + 1, d + seg + 17,
+                           (d[seg] >> 4) ? &ac[id] : &dc[id]);
+          seg = seg + 17 + n;
+          }
+       }
+    else if (m == 0xDD)
+       /* DRI */
+       restart = (d[seg] << 8) | d[seg+1];
+    else if (m == 0xDA)
+       break;
+    else if (m == 0xD9)
+       corrupt ("no scan in file");
+
+    pos = next;
+    }
+
+/* ---- SOS ---- */
+
+if (nx == 0)
+   corrupt ("frame header missing");
+if (d[seg] != 1)
+   corrupt ("only one component per scan is supported");
+td = d[seg+2] >> 4;
+ta = d[seg+2] & 15;
+if ((td > 3) || (ta > 3) || (!dc[td].defined) || (!ac[ta].defined))
+   corrupt ("Huffman table missing");
+if (!defined[tq])
+   corrupt ("quantisation table missing");
+
+/* ---- Huffman decoding ---- */
+
+bw      = (nx + 7) / 8;
+bh      = (ny + 7) / 8;
+t.level = (short *) alloc_buffer (64 * bw * bh * sizeof (short));
+r.data   = d;
+r.size   = size;
+r.pos    = next;
+r.acc    = 0;
+r.bits   = 0;
+r.marker = 0;
+decode_scan (&r, &dc[td], &ac[ta], restart, bw * bh, t.level);
+
+/* ---- dequantisation and inverse DCT, in parallel ---- */
+
+alloc_image (u, 1, nx, ny, halo);
+t.u    = *u;
+t.q    = NULL;
+t.bw   = bw;
+t.step = step[tq];
+parallel_rows (0, bh - 1, decode_rows, &t);
+
+free (t.level);
+free (dc);
+free (ac);
+free (d);
+return (size);
+
+}  /* jpeg_decode */
@@ -0,0 +1,48 @@
+#ifndef JPEG_H
+#define JPEG_H
+
+/*--------------------------------------------------------------------------*/
+/*                                                                          */
+/*                  BASELINE JPEG ENCODING AND DECODING                     */
+/*                                                                          */
+/*--------------------------------------------------------------------------*/
+
+/*
+  Sequential baseline JPEG (ITU T.81) of greyscale images, JFIF file
+  format.
+  jpeg_encode shifts the grey values by -128, transforms the 8x8 blocks
+  with dct8x8 (which is the DCT of the standard), quantises them with
+  the steps of a quant_table and stores the levels in zig-zag order;
+  this runs in parallel over rows of blocks. The entropy coder then
+  codes the difference of each DC level to the DC level of the previous
+  block and the runs of zeros of the AC levels with the Huffman tables
+  of Annex K of the standard. Codes and their lengths come from lookup
+  tables and are collected in a 64-bit bit buffer that is flushed 32
+  bits at a time. Blocks at the right and the bottom boundary are padded
+  by repeating the last column / row, so any image size is allowed.
+  jpeg_decode reads baseline and extended (8-bit) sequential greyscale
+  files with any Huffman and quantisation tables and restart intervals.
+  Huffman codes of up to 9 bits are decoded with one table lookup on the
+  next 9 bits of a 64-bit bit buffer, longer codes bit length by bit
+  length. Dequantisation, idct8x8, the shift by +128, rounding and
+  clipping to 0,...,255 run in parallel over rows of blocks.
+  Both return the size of the file in bytes.
+  jpeg_luminance holds the example luminance table of Annex K (entry
+  8l+k for frequency (k,l), as in quant.h); with quant_table_init it
+  gives the tables of the IJG quality factor.
+  Requires image.h and quant.h.
+*/
+
+/*--------------------------------------------------------------------------*/
+
+extern const double jpeg_luminance[QUANT_TABLE_SIZE];
+
+/*--------------------------------------------------------------------------*/
+
+long jpeg_encode
+     (image *u, const quant_table *q, char *file_name);
+
+long jpeg_decode
+     (char *file_name, long halo, image **u);
+
+#endif
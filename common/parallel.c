@@ -0,0 +1,275 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "parallel.h"
+
+/*--------------------------------------------------------------------------*/
+/*                                                                          */
+/*                       ROW-PARALLEL EXECUTION ENGINE                      */
+/*                                                                          */
+/*--------------------------------------------------------------------------*/
+
+/*
+  thread pool with a shared chunk counter
+*/
+
+/*--------------------------------------------------------------------------*/
+
+#define PARALLEL_MAX     256   /* maximum number of threads */
+#define CHUNKS_PER_TASK  8     /* chunks per thread and call */
+
+static long             n_threads = 0;      /* requested threads, 0: auto */
+static long             n_workers = 0;      /* running worker threads */
+static pthread_t        worker[PARALLEL_MAX];
+static pthread_mutex_t  lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t   wake = PTHREAD_COND_INITIALIZER;  /* new work */
+static pthread_cond_t   done = PTHREAD_COND_INITIALIZER;  /* work finished */
+static long             generation = 0;     /* number of calls so far */
+static long             busy       = 0;     /* workers in current call */
+static long             running    = 0;     /* call in progress? */
+static long             quit       = 0;     /* stop the workers? */
+
+/* current call */
+static row_kernel       job_kernel;         /* kernel */
+static void             *job_arg;           /* its argument */
+static long             job_next;           /* first row of next chunk */
+static long             job_last;           /* last row */
+static long             job_chunk;          /* rows per chunk */
+
+/*--------------------------------------------------------------------------*/
+
+static void run_chunks
+
+     (void)
+
+/*
+  fetches chunks of the current call until none are left;
+  called with the lock held, returns with the lock held
+*/
+
+{
+long  first, last;    /* rows of the chunk */
+
+while (job_next <= job_last)
+   {
+   first    = job_next;
+   last     = first + job_chunk - 1;
+   if (last > job_last)
+      last = job_last;
+   job_next = last + 1;
+
+   pthread_mutex_unlock (&lock);
+   job_kernel (first, last, job_arg);
+   pthread_mutex_lock (&lock);
+   }
+
+return;
+
+}  /* run_chunks */
+
+/*--------------------------------------------------------------------------*/
+
+static void *worker_loop
+
+     (void  *arg)        /* number of calls before the worker was started */
+
+/*
+  waits for calls of parallel_rows and helps to process them
+*/
+
+{
+long  seen;    /* last call processed */
+
+seen = (long)(intptr_t) arg;
+
+pthread_mutex_lock (&lock);
+for (;;)
+   {
+   while ((generation == seen) && !quit)
+      pthread_cond_wait (&wake, &lock);
+   if (quit)
+      break;
+   seen = generation;
+
+   run_chunks ();
+
+   busy--;
+   if (busy == 0)
+      pthread_cond_signal (&done);
+   }
+pthread_mutex_unlock (&lock);
+
+return (NULL);
+
+}  /* worker_loop */
+
+/*--------------------------------------------------------------------------*/
+
+static void stop_workers
+
+     (void)
+
+/*
+  terminates all worker threads
+*/
+
+{
+long  k;    /* loop variable */
+
+pthread_mutex_lock (&lock);
+quit = 1;
+pthread_cond_broadcast (&wake);
+pthread_mutex_unlock (&lock);
+
+for (k=0; k<n_workers; k++)
+    pthread_join (worker[k], NULL);
+
+quit      = 0;
+n_workers = 0;
+
+return;
+
+}  /* stop_workers */
+
+/*--------------------------------------------------------------------------*/
+
+static void start_workers
+
+     (void)
+
+/*
+  starts parallel_threads() - 1 workers; the calling thread is the last one
+*/
+
+{
+long  n;    /* number of workers */
+
+n = parallel_threads () - 1;
+
+pthread_mutex_lock (&lock);
+while (n_workers < n)
+   {
+   if (pthread_create (&worker[n_workers], NULL, worker_loop,
+                       (void *)(intptr_t) generation) != 0)
+      break;
+   n_workers++;
+   }
+pthread_mutex_unlock (&lock);
+
+return;
+
+}  /* start_workers */
+
+/*--------------------------------------------------------------------------*/
+
+void parallel_init
+
+     (long  n)           /* number of threads, 0 for one per processor */
+
+/*
+  sets the number of threads; a running pool is restarted
+*/
+
+{
+if (n < 0)
+   n = 0;
+if (n > PARALLEL_MAX)
+   n = PARALLEL_MAX;
+
+if (n_workers > 0)
+   stop_workers ();
+n_threads = n;
+
+return;
+
+}  /* parallel_init */
+
+/*--------------------------------------------------------------------------*/
+
+long parallel_threads
+
+     (void)
+
+/*
+  returns the number of threads used by parallel_rows
+*/
+
+{
+long  n;    /* number of threads */
+
+n = n_threads;
+if (n == 0)
+   n = sysconf (_SC_NPROCESSORS_ONLN);
+if (n < 1)
+   n = 1;
+if (n > PARALLEL_MAX)
+   n = PARALLEL_MAX;
+
+return (n);
+
+}  /* parallel_threads */
+
+/*--------------------------------------------------------------------------*/
+
+void parallel_rows
+
+     (long        first,    /* first row */
+      long        last,     /* last row */
+      row_kernel  kernel,   /* kernel for a chunk of rows */
+      void        *arg)     /* argument passed to the kernel */
+
+/*
+  runs kernel on the rows first,...,last using the thread pool and returns
+  when all rows are done; with one thread, for tiny ranges and for calls
+  from inside a kernel the rows are processed by the calling thread
+*/
+
+{
+long  n;          /* number of threads */
+long  nested;     /* call from inside a kernel? */
+
+if (last < first)
+   return;
+
+n = parallel_threads ();
+
+pthread_mutex_lock (&lock);
+nested = running;
+pthread_mutex_unlock (&lock);
+
+if ((n == 1) || (last == first) || nested)
+   {
+   kernel (first, last, arg);
+   return;
+   }
+
+if (n_workers == 0)
+   start_workers ();
+
+pthread_mutex_lock (&lock);
+running    = 1;
+job_kernel = kernel;
+job_arg    = arg;
+job_next   = first;
+job_last   = last;
+job_chunk  = (last - first + 1) / (CHUNKS_PER_TASK * (n_workers + 1));
+if (job_chunk < 1)
+   job_chunk = 1;
+busy       = n_workers;
+generation++;
+pthread_cond_broadcast (&wake);
+
+/* the calling thread works as well */
+run_chunks ();
+
+while (busy > 0)
+   pthread_cond_wait (&done, &lock);
+running = 0;
+pthread_mutex_unlock (&lock);
+
+return;
+
+}  /* parallel_rows */
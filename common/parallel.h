@@ -0,0 +1,38 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+/*--------------------------------------------------------------------------*/
+/*                                                                          */
+/*                       ROW-PARALLEL EXECUTION ENGINE                      */
+/*                                                                          */
+/*--------------------------------------------------------------------------*/
+
+/*
+  A small pool of worker threads that runs a kernel over a range of image
+  rows. The range is cut into chunks of consecutive rows that the workers
+  and the calling thread fetch one after another, so uneven rows balance
+  out. A kernel must only write to its own rows; reductions are done by
+  writing one partial result per row and combining the partial results in
+  row order afterwards, which keeps results independent of the timing.
+  The pool is started on first use with parallel_init's setting (default:
+  number of online processors, command line flag -t).
+*/
+
+/*--------------------------------------------------------------------------*/
+
+/* processes the rows first,...,last (inclusive) */
+typedef void (*row_kernel)
+     (long first, long last, void *arg);
+
+/*--------------------------------------------------------------------------*/
+
+void parallel_init
+     (long n);
+
+long parallel_threads
+     (void);
+
+void parallel_rows
+     (long first, long last, row_kernel kernel, void *arg);
+
+#endif
@@ -0,0 +1,237 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "image.h"
+#include "parallel.h"
+#include "gauss.h"
+#include "pyramid.h"
+
+/*--------------------------------------------------------------------------*/
+/*                                                                          */
+/*                      GAUSSIAN SCALE-SPACE PYRAMID                        */
+/*                                                                          */
+/*--------------------------------------------------------------------------*/
+
+/*
+  arena of pyramid levels, incremental smoothing and decimation
+*/
+
+/*--------------------------------------------------------------------------*/
+
+/* data of the parallel loops */
+typedef struct
+   {
+   image   *u;         /* finer level, unchanged */
+   image   *v;         /* coarser level, output */
+   } decimate_task;
+
+/*--------------------------------------------------------------------------*/
+
+void alloc_pyramid
+
+     (pyramid  **p,        /* pyramid, output */
+      long     nx,         /* input size in x direction */
+      long     ny,         /* input size in y direction */
+      long     octaves,    /* number of octaves */
+      long     scales,     /* steps per octave */
+      double   sigma0)     /* scale of level 0 */
+
+/*
+  allocates the arena for all levels of a pyramid of an nx * ny image and
+  sets up the level views and their scales; every octave halves the size
+  of the previous one, rounding up
+*/
+
+{
+long     o, s, k;      /* loop variables */
+long     mx, my;       /* size of the current octave */
+long     total;        /* arena size in pixels */
+pyramid  *q;           /* allocated pyramid */
+
+if ((octaves < 1) || (scales < 1) || (sigma0 <= 0.0))
+   {
+   printf("alloc_pyramid: invalid parameters\n");
+   exit(1);
+   }
+
+q = (pyramid *) malloc (sizeof(pyramid));
+if (q == NULL)
+   {
+   printf("alloc_pyramid: not enough memory available\n");
+   exit(1);
+   }
+q->octaves = octaves;
+q->scales  = scales;
+q->levels  = octaves * (scales + 1);
+q->sigma   = (double *) malloc (q->levels * sizeof(double));
+q->h       = (double *) malloc (q->levels * sizeof(double));
+q->level   = (image *) malloc (q->levels * sizeof(image));
+if ((q->sigma == NULL) || (q->h == NULL) || (q->level == NULL))
+   {
+   printf("alloc_pyramid: not enough memory available\n");
+   exit(1);
+   }
+
+/* arena size */
+total = 0;
+mx = nx;
+my = ny;
+for (o=0; o<octaves; o++)
+    {
+    total = total + (scales + 1) * image_pixels (1, mx, my, 1);
+    mx = (mx + 1) / 2;
+    my = (my + 1) / 2;
+    }
+
+q->arena = (pixel *) aligned_alloc (IMAGE_ALIGN,
+                                   (size_t) total * sizeof(pixel));
+if (q->arena == NULL)
+   {
+   printf("alloc_pyramid: not enough memory available\n");
+   exit(1);
+   }
+memset (q->arena, 0, (size_t) total * sizeof(pixel));
+
+/* level views one after another in the arena */
+total = 0;
+mx = nx;
+my = ny;
+for (o=0; o<octaves; o++)
+    {
+    for (s=0; s<=scales; s++)
+        {
+        k = o * (scales + 1) + s;
+        image_view (&q->level[k], q->arena + total, 1, mx, my, 1);
+        q->sigma[k] = sigma0 * pow (2.0, o + (double) s / scales);
+        q->h[k]     = ldexp (1.0, o);
+        total = total + image_pixels (1, mx, my, 1);
+        }
+    mx = (mx + 1) / 2;
+    my = (my + 1) / 2;
+    }
+
+*p = q;
+return;
+
+}  /* alloc_pyramid */
+
+/*--------------------------------------------------------------------------*/
+
+void free_pyramid
+
+     (pyramid  *p)         /* pyramid */
+
+/*
+  frees a pyramid allocated with alloc_pyramid, including its arena
+*/
+
+{
+free (p->arena);
+free (p->sigma);
+free (p->h);
+free (p->level);
+free (p);
+
+return;
+
+}  /* free_pyramid */
+
+/*--------------------------------------------------------------------------*/
+
+static void decimate_rows
+
+     (long  first,       /* first row of the coarser level */
+      long  last,        /* last row of the coarser level */
+      void  *arg)        /* decimate_task */
+
+/*
+  subsamples rows first,...,last: pixel (i,j) of the coarser level is
+  pixel (2i-1,2j-1) of the finer one
+*/
+
+{
+decimate_task  *t = (decimate_task *) arg;   /* task */
+long           i, j;                         /* loop variables */
+pixel          *a, *b;                       /* finer, coarser row */
+
+for (j=first; j<=last; j++)
+    {
+    a = ROW(t->u, 2 * j - 1);
+    b = ROW(t->v, j);
+    for (i=1; i<=t->v->nx; i++)
+        b[i] = a[2 * i - 1];
+    }
+
+return;
+
+}  /* decimate_rows */
+
+/*--------------------------------------------------------------------------*/
+
+void build_pyramid
+
+     (pyramid  *p,         /* pyramid from alloc_pyramid, levels output */
+      long     btype,      /* type of boundary condition */
+      double   prec,       /* cutoff at precision * sigma */
+      long     backend,    /* GAUSS_AUTO, GAUSS_FFT or GAUSS_RECURSIVE */
+      image    *u)         /* input image with halo 1, unchanged */
+
+/*
+  fills all levels of p: level 0 is u smoothed with sigma0, every further
+  level of an octave the previous level smoothed with the difference
+  scale delta, and the first level of an octave the last level of the
+  previous octave subsampled by 2
+*/
+
+{
+long           o, s, j, k;     /* loop variables */
+long           nx, ny;         /* size of the current level */
+double         delta;          /* scale of the incremental smoothing */
+image          *v;             /* current level */
+decimate_task  t;              /* task */
+
+if ((u->nx != p->level[0].nx) || (u->ny != p->level[0].ny))
+   {
+   printf("build_pyramid: image size does not match the pyramid\n");
+   exit(1);
+   }
+
+for (o=0; o<p->octaves; o++)
+ for (s=0; s<=p->scales; s++)
+     {
+     k  = o * (p->scales + 1) + s;
+     v  = &p->level[k];
+     nx = v->nx;
+     ny = v->ny;
+
+     if (k == 0)
+        {
+        /* level 0: the input smoothed with sigma0 */
+        for (j=1; j<=ny; j++)
+            memcpy (&PIX(v,1,j), &PIX(u,1,j), nx * sizeof(pixel));
+        gauss_conv_backend (backend, p->sigma[0], btype, prec, nx, ny,
+                            1.0, 1.0, v);
+        }
+     else if (s == 0)
+        {
+        /* first level of an octave: same scale, half the size */
+        t.u = &p->level[k-1];
+        t.v = v;
+        parallel_rows (1, ny, decimate_rows, &t);
+        }
+     else
+        {
+        /* sigma_k^2 = sigma_(k-1)^2 + delta^2 */
+        delta = sqrt (p->sigma[k] * p->sigma[k]
+                      - p->sigma[k-1] * p->sigma[k-1]);
+        copy_image (&p->level[k-1], v);
+        gauss_conv_backend (backend, delta, btype, prec, nx, ny,
+                            p->h[k], p->h[k], v);
+        }
+     }
+
+return;
+
+}  /* build_pyramid */
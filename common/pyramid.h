@@ -0,0 +1,57 @@
+#ifndef PYRAMID_H
+#define PYRAMID_H
+
+/*--------------------------------------------------------------------------*/
+/*                                                                          */
+/*                      GAUSSIAN SCALE-SPACE PYRAMID                        */
+/*                                                                          */
+/*--------------------------------------------------------------------------*/
+
+/*
+  Gaussian scale space organised in octaves: octave o has the grid size
+  h = 2^o and the levels s = 0,...,scales with the scales
+  sigma0 * 2^(o + s/scales); its last level has the same scale as the
+  first level of the next octave, which is this level subsampled by 2 in
+  both directions.
+  Each level is obtained from the previous one by one Gaussian
+  convolution (gauss_conv_backend with the given backend) with
+  delta = sqrt (sigma_k^2 - sigma_(k-1)^2), measured in pixels of the
+  input image (hx = hy = h), and level 0 from the input with delta =
+  sigma0. The deltas are short and shrink in pixels of the coarser
+  octaves, so the whole pyramid costs a few short passes over about 4/3
+  of the input instead of one long pass over the full image per level.
+  All levels live in one arena; level[k] is a view with halo 1 on it,
+  k = o * (scales + 1) + s.
+  Subsampling keeps pixel 2i-1 of the finer level, so the mirror axis of
+  the reflecting boundary moves outwards by half a pixel of the finer
+  level with every octave; near the boundary the coarse levels differ
+  from the full resolution smoothing by a few grey values (bench/pyramid).
+  Requires image.h and gauss.h (backends).
+*/
+
+/*--------------------------------------------------------------------------*/
+
+typedef struct
+   {
+   long    octaves;    /* number of octaves */
+   long    scales;     /* steps per octave */
+   long    levels;     /* number of levels, octaves * (scales + 1) */
+   double  *sigma;     /* scale of each level, in pixels of the input */
+   double  *h;         /* grid size of each level */
+   image   *level;     /* views on the arena, one per level */
+   pixel   *arena;     /* one buffer for all levels */
+   } pyramid;
+
+/*--------------------------------------------------------------------------*/
+
+void alloc_pyramid
+     (pyramid **p, long nx, long ny, long octaves, long scales,
+      double sigma0);
+
+void build_pyramid
+     (pyramid *p, long btype, double prec, long backend, image *u);
+
+void free_pyramid
+     (pyramid *p);
+
+#endif
@@ -0,0 +1,257 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <pthread.h>
+
+#include "quant.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define QUANT_X86
+#endif
+
+/*--------------------------------------------------------------------------*/
+/*                                                                          */
+/*                   QUANTISATION OF 8x8 DCT COEFFICIENTS                   */
+/*                                                                          */
+/*--------------------------------------------------------------------------*/
+
+/*
+  quantisation tables with reciprocals, IJG quality scaling
+*/
+
+/*--------------------------------------------------------------------------*/
+
+void quant_table_init
+
+     (quant_table   *q,          /* quantisation table, output */
+      const double  *base,       /* base table, 64 steps */
+      long          quality)     /* quality factor, 1,...,100 */
+
+/*
+  scales the base table with the IJG quality factor and precomputes the
+  reciprocals of the steps; quality 50 and integer steps up to 255 give
+  the base table unchanged
+*/
+
+{
+long    k;         /* loop variable */
+double  scale;     /* scaling in percent */
+double  step;      /* scaled step */
+
+/* clip quality as libjpeg does */
+if (quality < 1)
+   quality = 1;
+if (quality > 100)
+   quality = 100;
+
+if (quality < 50)
+   scale = 5000.0 / quality;
+else
+   scale = 200.0 - 2.0 * quality;
+
+for (k=0; k<QUANT_TABLE_SIZE; k++)
+    {
+    step = floor ((base[k] * scale + 50.0) / 100.0);
+    if (step < 1.0)
+       step = 1.0;
+    if (step > 255.0)
+       step = 255.0;
+    q->step[k]  = step;
+    q->recip[k] = 1.0 / step;
+    }
+
+return;
+
+}  /* quant_table_init */
+
+/*--------------------------------------------------------------------------*/
+
+void read_quant_table
+
+     (char    *file_name,    /* text file with 64 steps */
+      double  *base)         /* base table, output */
+
+/*
+  reads a quantisation table of 64 positive numbers, row by row
+*/
+
+{
+FILE  *f;       /* input file */
+long  k;        /* number of steps read */
+int   ch;       /* next character */
+
+f = fopen (file_name, "r");
+if (f == NULL)
+   {
+   printf ("read_quant_table: cannot open file '%s'\n", file_name);
+   exit(1);
+   }
+
+k = 0;
+while (k < QUANT_TABLE_SIZE)
+   {
+   ch = getc (f);
+   if (ch == EOF)
+      break;
+   if (ch == '#')
+      {
+      /* skip comment */
+      while ((ch != '\n') && (ch != EOF))
+         ch = getc (f);
+      continue;
+      }
+   if ((ch == ' ') || (ch == '\t') || (ch == '\n') || (ch == '\r'))
+      continue;
+   ungetc (ch, f);
+   if ((fscanf (f, "%lf", &base[k]) != 1) || (base[k] <= 0.0))
+      break;
+   k++;
+   }
+fclose (f);
+
+if (k < QUANT_TABLE_SIZE)
+   {
+   printf ("read_quant_table: '%s' does not hold 64 positive steps\n",
+           file_name);
+   exit(1);
+   }
+
+return;
+
+}  /* read_quant_table */
+
+/*--------------------------------------------------------------------------*/
+
+/*
+  multiply - round - multiply over the 64 entries (levels: without the
+  second multiplication); with the target attribute GCC turns rint into
+  vroundpd / vrndscalepd in the current rounding mode, i.e. the same
+  result as the scalar rint
+*/
+
+typedef void (*quant_kernel) (const quant_table *q, double *b);
+
+#define QUANT_KERNEL(name, levels)                                         \
+static void name (const quant_table *q, double *b)                         \
+{                                                                          \
+long  k;                                                                   \
+for (k=0; k<QUANT_TABLE_SIZE; k++)                                         \
+    b[k] = rint (b[k] * q->recip[k]) * ((levels) ? 1.0 : q->step[k]);      \
+return;                                                                    \
+}
+
+QUANT_KERNEL (quantise_generic, 0)
+QUANT_KERNEL (levels_generic, 1)
+
+#if defined(QUANT_X86)
+__attribute__((target("avx2"), optimize("fp-contract=off,tree-vectorize")))
+QUANT_KERNEL (quantise_avx2, 0)
+__attribute__((target("avx2"), optimize("fp-contract=off,tree-vectorize")))
+QUANT_KERNEL (levels_avx2, 1)
+__attribute__((target("avx512f"), optimize("fp-contract=off,tree-vectorize")))
+QUANT_KERNEL (quantise_avx512, 0)
+__attribute__((target("avx512f"), optimize("fp-contract=off,tree-vectorize")))
+QUANT_KERNEL (levels_avx512, 1)
+#endif
+
+/*--------------------------------------------------------------------------*/
+
+static quant_kernel    kq = NULL;      /* chosen quantisation kernel */
+static quant_kernel    kl = NULL;      /* chosen level kernel */
+static pthread_once_t  kernels_once = PTHREAD_ONCE_INIT;
+
+/*--------------------------------------------------------------------------*/
+
+static void choose_quant_kernels (void)
+
+/*
+  chooses the kernels for the vector extensions of the processor; runs
+  exactly once, via pthread_once
+*/
+
+{
+kl = levels_generic;
+kq = quantise_generic;
+#if defined(QUANT_X86)
+__builtin_cpu_init ();
+if (__builtin_cpu_supports ("avx2"))
+   {
+   kl = levels_avx2;
+   kq = quantise_avx2;
+   }
+if (__builtin_cpu_supports ("avx512f"))
+   {
+   kl = levels_avx512;
+   kq = quantise_avx512;
+   }
+#endif
+
+return;
+
+}  /* choose_quant_kernels */
+
+/*--------------------------------------------------------------------------*/
+
+static void select_quant_kernels
+
+     (quant_kernel  *quant,    /* quantisation kernel, output */
+      quant_kernel  *levels)   /* level kernel, output */
+
+/*
+  returns the kernels for the vector extensions of the processor; the
+  first call makes the choice, also if it comes from several threads of
+  parallel_rows at once
+*/
+
+{
+pthread_once (&kernels_once, choose_quant_kernels);
+
+*quant  = kq;
+*levels = kl;
+return;
+
+}  /* select_quant_kernels */
+
+/*--------------------------------------------------------------------------*/
+
+void quantise8x8
+
+     (const quant_table  *q,     /* quantisation table */
+      double             *b)     /* 8x8 block of coefficients, in and out */
+
+/*
+  quantises the coefficients of one block in place
+*/
+
+{
+quant_kernel  quant, levels;    /* kernels */
+
+select_quant_kernels (&quant, &levels);
+quant (q, b);
+
+return;
+
+}  /* quantise8x8 */
+
+/*--------------------------------------------------------------------------*/
+
+void quant_levels8x8
+
+     (const quant_table  *q,     /* quantisation table */
+      double             *b)     /* 8x8 block of coefficients, in and out */
+
+/*
+  replaces the coefficients of one block by their integer levels
+  rint (b * recip), e.g. for entropy coding; quantise8x8 is this level
+  times the step
+*/
+
+{
+quant_kernel  quant, levels;    /* kernels */
+
+select_quant_kernels (&quant, &levels);
+levels (q, b);
+
+return;
+
+}  /* quant_levels8x8 */
@@ -0,0 +1,51 @@
+#ifndef QUANT_H
+#define QUANT_H
+
+/*--------------------------------------------------------------------------*/
+/*                                                                          */
+/*                   QUANTISATION OF 8x8 DCT COEFFICIENTS                   */
+/*                                                                          */
+/*--------------------------------------------------------------------------*/
+
+/*
+  Table-driven quantisation of the 8x8 blocks of dct8x8: coefficient
+  (k,l) at b[8l+k] becomes rint (b * recip) * step with the step and its
+  reciprocal of entry 8l+k, i.e. one multiplication instead of a division
+  per coefficient; quant_levels8x8 gives the integer levels
+  rint (b * recip) for an entropy coder. The loop over the 64 entries is
+  vectorised for the widest vectors of the processor, chosen at run time.
+  quant_table_init scales a base table with the quality factor of libjpeg
+  (IJG): quality q in 1,...,100 gives the percentage
+  5000 / q for q < 50 and 200 - 2q otherwise, i.e. q = 50 keeps the
+  base table, q = 100 gives steps 1, and the steps are rounded and
+  clipped to 1,...,255 as in a baseline JPEG file.
+  read_quant_table reads a base table of 64 numbers from a text file,
+  row by row (entry 8l+k), separated by white space; # starts a comment
+  up to the end of the line.
+*/
+
+/*--------------------------------------------------------------------------*/
+
+#define QUANT_TABLE_SIZE  64    /* entries of an 8x8 block */
+
+typedef struct
+   {
+   double  step[QUANT_TABLE_SIZE];    /* quantisation steps */
+   double  recip[QUANT_TABLE_SIZE];   /* their reciprocals 1 / step */
+   } quant_table;
+
+/*--------------------------------------------------------------------------*/
+
+void quant_table_init
+     (quant_table *q, const double *base, long quality);
+
+void read_quant_table
+     (char *file_name, double *base);
+
+void quantise8x8
+     (const quant_table *q, double *b);
+
+void quant_levels8x8
+     (const quant_table *q, double *b);
+
+#endif